@@ -0,0 +1,75 @@
+#ifndef SL_DEPTH_CODEC_H
+#define SL_DEPTH_CODEC_H
+
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sl_tools {
+
+    /*!
+     * \brief Format string of the `sensor_msgs/CompressedImage` messages
+     * containing a depth map encoded by \ref encodeDepth
+     */
+    const char* const DEPTH_CODEC_FORMAT = "32FC1; zdepth";
+
+    /*!
+     * \brief encodeDepth
+     * Compress a depth map.
+     * The depth is quantized on 16 bits (0: invalid), each pixel is replaced
+     * by the zigzag coded difference from its left neighbor and the low and
+     * high bytes are separated in two planes, then compressed with zlib
+     * (run length strategy: the high plane is almost all zeros).
+     * The image is split in bands of rows compressed in parallel (OpenMP).
+     * \param depth first pixel of the depth map [m]
+     * \param step size of a row of the depth map [bytes]
+     * \param width width of the depth map (up to 65535)
+     * \param height height of the depth map (up to 65535)
+     * \param quantization depth step of the quantized values [m]
+     * (1 mm allows depths up to 65.5 m)
+     * \param bandRows number of rows of each band (limited to the height)
+     * \param out the encoded data
+     * \param threads number of OpenMP threads (0: OpenMP default)
+     * \return true if successful
+     */
+    bool encodeDepth(const float* depth, size_t step, int width, int height, float quantization,
+                     int bandRows, std::vector<uint8_t>& out, int threads = 0);
+
+    /*!
+     * \brief decodeDepth
+     * Decompress a depth map encoded by \ref encodeDepth, bands in parallel (OpenMP)
+     * \param data the encoded data
+     * \param size size of the encoded data [bytes]
+     * \param depth the decoded depth map [m], row major, NaN for invalid pixels
+     * \param width width of the decoded depth map
+     * \param height height of the decoded depth map
+     * \param threads number of OpenMP threads (0: OpenMP default)
+     * \return true if successful, false if the data are corrupted or exceed
+     * the limits of \ref encodeDepth
+     */
+    bool decodeDepth(const uint8_t* data, size_t size, std::vector<float>& depth, int& width, int& height,
+                     int threads = 0);
+
+} // namespace sl_tools
+
+#endif // SL_DEPTH_CODEC_H
@@ -26,6 +26,17 @@
  ** A set of parameters can be specified in the launch file.                                       **
  ****************************************************************************************************/
 #include "sl_tools.h"
+#include "sl_tf.h"
+#include "sl_trace.h"
+#include "sl_metrics.h"
+#include "sl_recorder.h"
+#include "sl_sync.h"
+#include "sl_scan.h"
+#include "sl_grid.h"
+#include "sl_elevation.h"
+#include "sl_normals.h"
+#include "zed_wrapper/sl_depth_codec.h"
+#include "sl_jpeg.h"
 
 #include <sl/Camera.hpp>
 
@@ -37,8 +48,12 @@
 #include <image_transport/image_transport.h>
 #include <dynamic_reconfigure/server.h>
 #include <geometry_msgs/PoseStamped.h>
+#include <sensor_msgs/CameraInfo.h>
+#include <sensor_msgs/CompressedImage.h>
+#include <sensor_msgs/LaserScan.h>
 #include <sensor_msgs/PointCloud2.h>
 #include <diagnostic_updater/diagnostic_updater.h>
+#include <std_msgs/Header.h>
 
 // Dynamic reconfiguration
 #include <zed_wrapper/ZedConfig.h>
@@ -53,7 +68,17 @@
 #include <zed_wrapper/stop_remote_stream.h>
 #include <zed_wrapper/set_led_status.h>
 #include <zed_wrapper/toggle_led.h>
-
+#include <zed_wrapper/set_tracing.h>
+#include <zed_wrapper/reset_statistics.h>
+#include <zed_wrapper/get_stats.h>
+#include <zed_wrapper/dump_recording.h>
+#include <zed_wrapper/FrameSync.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -63,6 +88,53 @@ using namespace std;
 
 namespace zed_wrapper {
 
+    // Coordinate changing from the SDK coordinate system to the ROS one
+#if (ZED_SDK_MAJOR_VERSION<2)
+    typedef sl_tools::ImageAxisRemap CoordRemap;
+#elif (ZED_SDK_MAJOR_VERSION==2 && ZED_SDK_MINOR_VERSION<5)
+    typedef sl_tools::RightHandedZUpRemap CoordRemap;
+#else
+    typedef sl_tools::RightHandedZUpXFwdRemap CoordRemap;
+#endif
+
+    // A SVO file recorded as part of a sequence
+    struct SvoSegment {
+        std::string filename;
+        ros::Time start;    // Timestamp of the first frame
+        ros::Time end;      // Timestamp of the last frame
+        uint64_t size = 0;  // File size [bytes], valid when the segment is closed
+        std::string index;  // Index file listing the segment, empty if not segmented
+    };
+
+    // Camera information of an output size. Never modified once built, so it
+    // can be shared with the publishing threads without locking
+    struct CamInfoSet {
+        int width;
+        int height;
+        sensor_msgs::CameraInfoConstPtr left;
+        sensor_msgs::CameraInfoConstPtr right;
+        sensor_msgs::CameraInfoConstPtr leftRaw;
+        sensor_msgs::CameraInfoConstPtr rightRaw;
+        float fx;       // Focal length of the rectified left camera [pixels]
+        float baseline; // Rectified baseline [m]
+    };
+    typedef std::shared_ptr<const CamInfoSet> CamInfoSetConstPtr;
+
+    // Parameters changed by dynamic reconfigure. Never modified once published:
+    // the reconfigure callback publishes a modified copy, the grab loop reads
+    // the current one once per frame through a lock-free atomic pointer (the retired
+    // snapshots are released by the reconfigure callback when the grab loop no longer uses them)
+    struct DynParams {
+        double matResizeFactor = 1.0;
+        int confidence = 100;
+        double maxDepth = 3.5;
+        double pointCloudFreq = 15.0;
+        bool autoExposure = true;
+        uint32_t autoExposureTrigger = 0; // Incremented to enable the automatic exposure again
+        int exposure = 100;
+        int gain = 100;
+    };
+
     class ZEDWrapperNodelet : public nodelet::Nodelet {
 
       public:
@@ -83,13 +155,102 @@ namespace zed_wrapper {
          */
         void readParameters();
 
+        /* \brief Discovers and opens the camera, retrying until success
+         * \return false if the node is stopped before opening the camera
+         */
+        bool openCamera();
+
         /* \brief ZED camera polling thread function
          */
         void device_poll_thread_func();
 
-        /* \brief Pointcloud publishing function
+        /* \brief Pointcloud publishing job, executed by the worker pool
+         *        shared by all the cameras of the process
+         */
+        void pointcloud_job_func();
+
+        /* \brief Add the last grabbed frame to the SVO file. Called by the
+         *        grabbing thread right after each grab
+         * \param stamp : the timestamp of the frame
+         */
+        void recordSvoFrame(ros::Time stamp);
+
+        /* \brief Close the current SVO segment and open the next one.
+         *        Called by the grabbing thread between two grabs, mRecMutex must be locked
+         * \param stamp : the timestamp of the first frame of the new segment
+         */
+        void switchSvoSegment(ros::Time stamp);
+
+        /* \brief SVO segment thread function: decides when a new segment
+         *        must be started and finalizes the closed segments (file size,
+         *        black box buffer). Does not call the SDK, so it never runs
+         *        concurrently with the camera functions used by the grab thread
+         */
+        void svo_segment_thread_func();
+
+        /* \brief Callback to the replay acknowledge topic
+         *        A consumer publishes the stamp of the last frame it processed
+         */
+        void replayAckCallback(const std_msgs::Header::ConstPtr& msg);
+
+        /* \brief Wait for the consumers to acknowledge the last replayed frame.
+         *        Must be called before grabbing a new frame
+         */
+        void waitReplayAck();
+
+        /* \brief Sleep until the time of a replayed frame, according to its
+         *        recorded timestamp and to the replay rate
+         * \param stamp : the recorded timestamp of the frame
+         */
+        void waitReplayTime(ros::Time stamp);
+
+        /* \brief Group the current frame with the frames of the other cameras
+         *        of the sync group and publish its synchronization status.
+         *        mFrameTimestamp is replaced by the bundle stamp if required
+         */
+        void syncFrame();
+
+        /* \brief Enable SVO recording, falling back to the other compression
+         *        modes if the requested one is not available
+         * \param filename : the SVO file name
+         */
+        sl::ERROR_CODE enableSvoRecording(const std::string& filename);
+
+        /* \brief Start the black box recording of SVO segments in the buffer folder
          */
-        void pointcloud_thread_func();
+        void startBlackBox();
+
+        /* \brief Add a closed segment to the black box buffer, save the dump
+         *        if the post-trigger window is completed and remove the old segments.
+         *        Called by the SVO segment thread
+         * \param seg : the closed segment
+         * \param lock : the lock of mRecMutex, released while removing the files
+         */
+        void addBlackBoxSegment(const SvoSegment& seg, std::unique_lock<std::mutex>& lock);
+
+        /* \brief Save the SVO segments of a black box dump to the destination folder
+         */
+        void blackbox_dump_thread_func(std::vector<SvoSegment> segments, std::string dumpDir);
+
+        /* \brief Check the free disk space and if the current SVO segment must
+         *        be closed. Called by the SVO segment thread after each recorded frame
+         * \param lock : the lock of mRecMutex, released while accessing the file system
+         */
+        void checkSvoSegment(std::unique_lock<std::mutex>& lock);
+
+        /* \brief Close the current SVO file. Its size and index entry are
+         *        written by the SVO segment thread. mRecMutex must be locked
+         */
+        void closeSvoSegment();
+
+        /* \brief Stop SVO recording. mRecMutex must be locked
+         */
+        void stopSvoRecording();
+
+        /* \brief Get the file name of a SVO segment
+         * \param idx : the index of the segment
+         */
+        std::string getSvoSegmentName(int idx);
 
         /* \brief Publish the pose of the camera in "Map" frame with a ros Publisher
          * \param t : the ros::Time to stamp the image
@@ -104,20 +265,12 @@ namespace zed_wrapper {
          */
         void publishOdom(tf2::Transform odom2baseTransf, sl::Pose& slPose, ros::Time t);
 
-        /* \brief Publish the pose of the camera in "Map" frame as a transformation
-         * \param baseTransform : Transformation representing the camera pose from
-         * odom frame to map frame
-         * \param t : the ros::Time to stamp the image
-         */
-        void publishPoseFrame(tf2::Transform baseTransform, ros::Time t);
-
-        /* \brief Publish the odometry of the camera in "Odom" frame as a
-         * transformation
-         * \param odomTransf : Transformation representing the camera pose from
-         * base frame to odom frame
-         * \param t : the ros::Time to stamp the image
+        /* \brief Broadcast the dynamic transforms of the current frame with a
+         *        single TF message: the base frame in "Odom" frame and, if enabled,
+         *        the "Odom" frame in "Map" frame
+         * \param t : the ros::Time to stamp the transforms
          */
-        void publishOdomFrame(tf2::Transform odomTransf, ros::Time t);
+        void broadcastFrameTf(ros::Time t);
 
         /* \brief Publish the pose of the imu in "Odom" frame as a transformation
          * \param imuTransform : Transformation representing the imu pose from base
@@ -126,6 +279,11 @@ namespace zed_wrapper {
          */
         void publishImuFrame(tf2::Transform imuTransform, ros::Time t);
 
+        /* \brief Update the camera to pose frame transform used by the IMU callback,
+         *        using the transforms computed and broadcasted by the grabbing thread
+         */
+        void updateCam2PoseTransform();
+
         /* \brief Publish a sl::Mat image with a ros Publisher
          * \param img : the image to publish
          * \param pubImg : the publisher object to use (different image publishers
@@ -135,14 +293,29 @@ namespace zed_wrapper {
          * image frames exist)
          * \param t : the ros::Time to stamp the image
          */
-        void publishImage(sl::Mat img, image_transport::CameraPublisher& pubImg, sensor_msgs::CameraInfoPtr camInfoMsg,
+        void publishImage(sl::Mat img, image_transport::CameraPublisher& pubImg, const sensor_msgs::CameraInfoConstPtr& camInfoMsg,
                           string imgFrameId, ros::Time t);
 
         /* \brief Publish a sl::Mat depth image with a ros Publisher
          * \param depth : the depth image to publish
+         * \param camInfoMsg : the camera_info to be published with the depth image
+         * \param t : the ros::Time to stamp the depth image
+         */
+        void publishDepth(sl::Mat depth, const sensor_msgs::CameraInfoConstPtr& camInfoMsg, ros::Time t);
+
+        /* \brief Publish a BGRA sl::Mat image compressed in JPEG, without the intermediate raw message
+         * \param img : the image to publish
+         * \param pubImg : the publisher object to use
+         * \param imgFrameId : the id of the reference frame of the image
+         * \param t : the ros::Time to stamp the image
+         */
+        void publishImageJpeg(sl::Mat img, ros::Publisher& pubImg, string imgFrameId, ros::Time t);
+
+        /* \brief Publish a sl::Mat depth image compressed with the depth codec
+         * \param depth : the depth image to publish [m]
          * \param t : the ros::Time to stamp the depth image
          */
-        void publishDepth(sl::Mat depth, ros::Time t);
+        void publishDepthCompressed(sl::Mat depth, ros::Time t);
 
         /* \brief Publish a sl::Mat confidence image with a ros Publisher
          * \param conf : the confidence image to publish
@@ -154,6 +327,27 @@ namespace zed_wrapper {
          */
         void publishPointCloud();
 
+        /* \brief Publish the 2D obstacle grid obtained projecting the point cloud
+         *        in the base frame
+         */
+        void publishObstacleGrid();
+
+        /* \brief Publish the surface normals of the point cloud as a 32FC3 image
+         */
+        void publishNormals();
+
+        /* \brief Fuse a depth map in the elevation map using the current odometry
+         * \param depth : the depth map [m]
+         * \param camInfo : the camera information of the output size
+         * \param t : the ros::Time of the depth map
+         */
+        void fuseElevationMap(sl::Mat depth, const CamInfoSetConstPtr& camInfo, ros::Time t);
+
+        /* \brief Callback to publish the elevation map with a ROS publisher.
+         * \param e : the ros::TimerEvent binded to the callback
+         */
+        void pubElevationMapCallback(const ros::TimerEvent& e);
+
         /* \brief Publish a fused pointCloud with a ros Publisher
          */
         void pubFusedPointCloudCallback(const ros::TimerEvent& e);
@@ -168,9 +362,17 @@ namespace zed_wrapper {
 
         /* \brief Publish a sl::Mat disparity image with a ros Publisher
          * \param disparity : the disparity image to publish
+         * \param camInfo : the camera information of the output size
          * \param t : the ros::Time to stamp the depth image
          */
-        void publishDisparity(sl::Mat disparity, ros::Time t);
+        void publishDisparity(sl::Mat disparity, const CamInfoSetConstPtr& camInfo, ros::Time t);
+
+        /* \brief Publish the laser scan extracted from a band of rows of the depth map
+         * \param depth : the depth map [m]
+         * \param camInfo : the camera information of the output size
+         * \param t : the ros::Time to stamp the scan
+         */
+        void publishScan(sl::Mat depth, const CamInfoSetConstPtr& camInfo, ros::Time t);
 
         /* \brief Get the information of the ZED cameras and store them in an
          * information message
@@ -181,11 +383,20 @@ namespace zed_wrapper {
          * camera informations
          * \param left_frame_id : the id of the reference frame of the left camera
          * \param right_frame_id : the id of the reference frame of the right camera
+         * \param width : the width of the output images
+         * \param height : the height of the output images
          */
         void fillCamInfo(sl::Camera& zed, sensor_msgs::CameraInfoPtr leftCamInfoMsg,
                          sensor_msgs::CameraInfoPtr rightCamInfoMsg,
                          string leftFrameId, string rightFrameId,
-                         bool rawParam = false);
+                         int width, int height, bool rawParam = false);
+
+        /* \brief Get the camera information of an output size, building it
+         *        only the first time the size is requested
+         * \param width : the width of the output images
+         * \param height : the height of the output images
+         */
+        CamInfoSetConstPtr getCamInfoSet(int width, int height);
 
         /* \bried Check if FPS and Resolution chosen by user are correct.
          *        Modifies FPS to match correct value.
@@ -196,10 +407,29 @@ namespace zed_wrapper {
          */
         void dynamicReconfCallback(zed_wrapper::ZedConfig& config, uint32_t level);
 
+        /* \brief Publishes a new snapshot of the dynamic parameters. Not thread safe:
+         * called only by readParameters and by the dynamic reconfigure callback
+         * \param params : the new snapshot
+         */
+        void publishDynParams(std::unique_ptr<DynParams> params);
+
+        /* \brief Returns the current snapshot of the dynamic parameters and marks it as
+         * in use, so that it is not released until the next call. Lock-free, called only
+         * by the grab thread (there is a single hazard slot)
+         */
+        const DynParams* acquireDynParams();
+
         /* \brief Callback to publish Path data with a ROS publisher.
          * \param e : the ros::TimerEvent binded to the callback
          */
         void pathPubCallback(const ros::TimerEvent& e);
+
+        /* \brief Check if a pose must be added to the path, according to the
+         *        `path_min_dist` and `path_min_angle` decimation parameters
+         * \param last : the latest pose stored in the path
+         * \param pose : the new pose
+         */
+        bool isPathPoseNew(const geometry_msgs::Pose& last, const geometry_msgs::Pose& pose);
         
         /* \brief Callback to publish IMU raw data with a ROS publisher.
          * \param e : the ros::TimerEvent binded to the callback
@@ -262,6 +492,88 @@ namespace zed_wrapper {
         bool on_toggle_led(zed_wrapper::toggle_led::Request& req,
                            zed_wrapper::toggle_led::Response& res);
 
+        /* \brief Service callback to set_tracing service
+         *        Starts recording the latency of the elaboration stages or
+         *        stops it saving the events in Chrome trace-event format
+         */
+        bool on_set_tracing(zed_wrapper::set_tracing::Request& req,
+                            zed_wrapper::set_tracing::Response& res);
+
+        /* \brief Service callback to reset_statistics service
+         *        The latency histograms exported as metrics are cleared
+         */
+        bool on_reset_statistics(zed_wrapper::reset_statistics::Request& req,
+                                 zed_wrapper::reset_statistics::Response& res);
+
+        /* \brief Add the percentiles of the last diagnostic period to the diagnostic status
+         * \param stat : the diagnostic status
+         * \param name : the name of the diagnostic item
+         * \param win : the statistics of the period [usec]
+         */
+        void addLatencyDiagnostic(diagnostic_updater::DiagnosticStatusWrapper& stat,
+                                  const std::string& name, const sl_tools::CLatencyWindow& win);
+
+        /* \brief Add the percentiles of a latency histogram since the start to the diagnostic status
+         * \param stat : the diagnostic status
+         * \param name : the name of the diagnostic item
+         * \param hist : the histogram [usec]
+         */
+        void addLatencyDiagnostic(diagnostic_updater::DiagnosticStatusWrapper& stat,
+                                  const std::string& name, const sl_tools::CLatencyHistogram& hist);
+
+        /* \brief Update the counters of a topic after publishing a message
+         * \param topic : the name of the topic
+         * \param bytes : the serialized size of the message
+         */
+        void countPublished(const std::string& topic, uint64_t bytes);
+
+        /* \brief Get the counters of a topic
+         * \param topic : the name of the topic
+         * \return the counters or nullptr if the topic is not published by the nodelet
+         */
+        sl_tools::CPublishCounter* getPubCounter(const std::string& topic);
+
+        /* \brief Add rate and bandwidth of each published topic to the diagnostic status,
+         *        evaluated since the previous diagnostic update
+         */
+        void addTopicsDiagnostic(diagnostic_updater::DiagnosticStatusWrapper& stat);
+
+        /* \brief Service callback to get_stats service
+         *        Returns the frame counters and the counters of each published topic
+         */
+        bool on_get_stats(zed_wrapper::get_stats::Request& req,
+                          zed_wrapper::get_stats::Response& res);
+
+        /* \brief Service callback to dump_recording service
+         *        The black box buffer and the following `post_trigger_sec` seconds
+         *        are saved to disk
+         */
+        bool on_dump_recording(zed_wrapper::dump_recording::Request& req,
+                               zed_wrapper::dump_recording::Response& res);
+
+        /* \brief Generate the page served by the metrics server in Prometheus text format
+         */
+        std::string getMetricsPage();
+
+        /* \brief Create the recorder file and its channels, as configured by the `recorder` parameters
+         */
+        void startRecorder();
+
+        /* \brief Append a message to the recorder file, serializing it directly in the current chunk
+         * \param channel : the recorder channel of the topic
+         * \param msg : the message
+         * \param t : the timestamp of the message
+         */
+        template <class M>
+        void recordMessage(uint16_t channel, const M& msg, ros::Time t) {
+            uint32_t size = ros::serialization::serializationLength(msg);
+
+            mRecorder.write(channel, static_cast<int64_t>(t.toNSec()), size, [&msg, size](uint8_t* dst) {
+                ros::serialization::OStream stream(dst, size);
+                ros::serialization::serialize(stream, msg);
+            });
+        }
+
         /* \brief Utility to initialize the pose variables
          */
         bool set_pose(float xt, float yt, float zt, float rr, float pr, float yr);
@@ -300,7 +612,20 @@ namespace zed_wrapper {
         ros::NodeHandle mNh;
         ros::NodeHandle mNhNs;
         std::thread mDevicePollThread;
-        std::thread mPcThread; // Point Cloud thread
+        std::shared_ptr<sl_tools::CWorkerPool> mWorkerPool; // Shared by all the cameras of the process
+        int mWorkerThreads = 2;
+        std::shared_ptr<sl_tools::CThreadBudget> mThreadBudget; // OpenMP threads of the grabbing threads and of the worker pool jobs, shared by all the cameras
+
+        // Multi-camera frame synchronization
+        bool mSyncEnabled = false;
+        std::string mSyncGroup;
+        double mSyncToleranceMsec = 5.0;
+        double mSyncMaxWaitMsec = 20.0;
+        bool mSyncUseBundleStamp = true; // Stamp the data of all the cameras with the common bundle stamp
+        std::shared_ptr<sl_tools::CFrameSynchronizer> mFrameSync; // Shared by the cameras of the same group
+        int mFrameSyncId = -1;
+        ros::Publisher mPubFrameSync;
+        std::atomic<uint64_t> mSyncIncompleteCount{0};
 
         bool mStopNode;
 
@@ -319,6 +644,13 @@ namespace zed_wrapper {
 
         ros::Publisher mPubConfMap; //
         ros::Publisher mPubDisparity; //
+        ros::Publisher mPubDepthCompressed; //
+        ros::Publisher mPubRgbJpeg; //
+        ros::Publisher mPubLeftJpeg; //
+        ros::Publisher mPubScan; //
+        ros::Publisher mPubObstacleGrid; //
+        ros::Publisher mPubNormals; //
+        ros::Publisher mPubElevationMap; //
         ros::Publisher mPubCloud;
         ros::Publisher mPubFusedCloud;
         ros::Publisher mPubPose;
@@ -326,6 +658,8 @@ namespace zed_wrapper {
         ros::Publisher mPubOdom;
         ros::Publisher mPubOdomPath;
         ros::Publisher mPubMapPath;
+        ros::Publisher mPubOdomPathAppend;
+        ros::Publisher mPubMapPathAppend;
         ros::Publisher mPubImu;
         ros::Publisher mPubImuRaw;
 
@@ -333,6 +667,7 @@ namespace zed_wrapper {
         ros::Timer mImuTimer;
         ros::Timer mPathTimer;
         ros::Timer mFusedPcTimer;
+        ros::Timer mElevationTimer;
 
         // Services
         ros::ServiceServer mSrvSetInitPose;
@@ -344,20 +679,20 @@ namespace zed_wrapper {
         ros::ServiceServer mSrvSvoStopStream;
         ros::ServiceServer mSrvSetLedStatus;
         ros::ServiceServer mSrvToggleLed;
+        ros::ServiceServer mSrvSetTracing;
+        ros::ServiceServer mSrvResetStatistics;
+        ros::ServiceServer mSrvGetStats;
+        ros::ServiceServer mSrvDumpRecording;
 
         // Camera info
-        sensor_msgs::CameraInfoPtr mRgbCamInfoMsg;
-        sensor_msgs::CameraInfoPtr mLeftCamInfoMsg;
-        sensor_msgs::CameraInfoPtr mRightCamInfoMsg;
-        sensor_msgs::CameraInfoPtr mRgbCamInfoRawMsg;
-        sensor_msgs::CameraInfoPtr mLeftCamInfoRawMsg;
-        sensor_msgs::CameraInfoPtr mRightCamInfoRawMsg;
-        sensor_msgs::CameraInfoPtr mDepthCamInfoMsg;
+        // The reference camera is the Left one (next to the ZED logo): its
+        // information is used also for the RGB, depth and confidence images
+        CamInfoSetConstPtr mCamInfo; // Current output size: access with std::atomic_load/std::atomic_store
+        std::map<std::pair<int, int>, CamInfoSetConstPtr> mCamInfoCache; // Sets already built, by output size
+        std::mutex mCamInfoCacheMutex;
 
         // ROS TF
-        tf2_ros::TransformBroadcaster mTransformPoseBroadcaster;
-        tf2_ros::TransformBroadcaster mTransformOdomBroadcaster;
-        tf2_ros::TransformBroadcaster mTransformImuBroadcaster;
+        boost::shared_ptr<tf2_ros::TransformBroadcaster> mTfBroadcaster; // Shared by all the cameras of the process
 
         std::string mRgbFrameId;
         std::string mRgbOptFrameId;
@@ -405,10 +740,53 @@ namespace zed_wrapper {
         double mImuPubRate;
         bool mImuTimestampSync;
         double mPathPubRate;
-        int mPathMaxCount;
+        int mPathMaxCount = -1;
+        double mPathMinDist = 0.0;
+        double mPathMinAngle = 0.0;
+        bool mPublishPathAppend = false;
         bool mVerbose;
         bool mSvoMode = false;
         double mCamMinDepth;
+        float mDisparityMinDepth = 0.f; // Depth range of the disparity messages, read when the settings are applied
+        float mDisparityMaxDepth = 0.f;
+
+        // JPEG compression of the color images
+        int mJpegQuality = 80;
+
+        // Depth compression
+        double mDepthCodecQuantization = 0.001;
+        int mDepthCodecBandRows = 32;
+
+        // Laser scan from depth
+        int mScanHeight = 10;
+        int mScanRowOffset = 0;
+        double mScanRangeMin = 0.45;
+        double mScanRangeMax = 10.0;
+        double mScanAngleIncrement = 0.0;
+        sl_tools::CDepthToScan mDepthToScan;
+
+        // Obstacle grid from point cloud
+        double mGridResolution = 0.05;
+        double mGridSize = 10.0;
+        double mGridMinHeight = 0.1;
+        double mGridMaxHeight = 1.5;
+        int mGridMinPoints = 3;
+        sl_tools::CObstacleGrid mObstacleGrid;
+
+        // Surface normals from point cloud
+        int mNormalsRadius = 2;
+        sl_tools::CNormalEstimator mNormalEstimator;
+
+        // Elevation map from depth and odometry
+        double mElevationResolution = 0.1;
+        double mElevationSize = 20.0;
+        int mElevationPixelStride = 4;
+        double mElevationMaxRange = 10.0;
+        double mElevationMaxHeight = 2.0;
+        double mElevationPubRate = 2.0;
+        sl_tools::CElevationMap mElevationMap;
+        ros::Time mElevationMapTime;
+        std::mutex mElevationMutex; // Protects the elevation map shared with the publishing timer
 
         bool mTrackingActivated;
         bool mMappingEnabled;
@@ -437,6 +815,9 @@ namespace zed_wrapper {
         std::string mLeftTopicRoot;
         std::string mDepthTopicRoot;
         std::string mDisparityTopic;
+        std::string mScanTopic;
+        std::string mObstacleGridTopic;
+        std::string mElevationMapTopic;
         std::string mPointCloudTopicRoot;
         std::string mConfImgRoot;
         std::string mPoseTopic;
@@ -452,8 +833,8 @@ namespace zed_wrapper {
         sl::Pose mLastZedPose; // Sensor to Map transform
         sl::Transform mInitialPoseSl;
         std::vector<float> mInitialBasePose;
-        std::vector<geometry_msgs::PoseStamped> mOdomPath;
-        std::vector<geometry_msgs::PoseStamped> mMapPath;
+        sl_tools::CRingBuffer<geometry_msgs::PoseStamped> mOdomPath;
+        sl_tools::CRingBuffer<geometry_msgs::PoseStamped> mMapPath;
 
         // TF Transforms
         tf2::Transform mMap2OdomTransf;         // Coordinates of the odometry frame in map frame
@@ -468,6 +849,11 @@ namespace zed_wrapper {
         bool mSensor2CameraTransfValid = false;
         bool mCamera2BaseTransfValid = false;
 
+        // Camera to pose frame transform shared with the IMU callback
+        tf2::Transform mCam2PoseTransf;         // Coordinates of the camera in map frame (or odom frame)
+        bool mCam2PoseTransfValid = false;
+        std::mutex mCam2PoseMutex;
+
         // initialization Transform listener
         boost::shared_ptr<tf2_ros::Buffer> mTfBuffer;
         boost::shared_ptr<tf2_ros::TransformListener> mTfListener;
@@ -481,16 +867,11 @@ namespace zed_wrapper {
         unsigned int mFwVersion;
 
         // Dynamic Parameters
-        int mCamConfidence;
-        int mCamExposure;
-        int mCamGain;
-        double mCamMatResizeFactor;
-        double mCamMaxDepth;
-        bool mCamAutoExposure;
-        double mPointCloudFreq;
+        std::atomic<const DynParams*> mDynParams{nullptr}; // Current snapshot
+        std::atomic<const DynParams*> mDynParamsInUse{nullptr}; // Hazard slot: snapshot read by the grab thread
+        std::vector<std::unique_ptr<const DynParams>> mDynParamsSnapshots; // Current snapshot and the retired ones still in use
 
         // flags
-        bool mTriggerAutoExposure;
         bool mComputeDepth;
         bool mOpenniDepthMode; // 16 bit UC data in mm else 32F in m, for more info -> http://www.ros.org/reps/rep-0118.html
         bool mPoseSmoothing = false; // Always disabled. Enable only for AR/VR applications
@@ -502,6 +883,58 @@ namespace zed_wrapper {
         // SVO recording
         bool mRecording = false;
         sl::RecordingState mRecState;
+        std::atomic<uint64_t> mSvoFailedCount{0};
+        std::thread mSvoSegmentThread;
+        std::condition_variable mSvoSegmentCondVar;
+        bool mSvoFrameRecorded = false;   // A frame was added to the current segment (protected by mRecMutex)
+        bool mSvoSwitchRequested = false; // The next frame starts a new segment (protected by mRecMutex)
+        bool mSvoStopRequested = false;   // Not enough free disk space: the next frame stops recording (protected by mRecMutex)
+        std::deque<SvoSegment> mSvoClosedSegments; // Segments to be finalized by the segment thread (protected by mRecMutex)
+
+        // SVO segments (protected by mRecMutex)
+        double mSvoSegmentMaxSec = 0.0;
+        int mSvoSegmentMaxMb = 0;
+        int mSvoMinFreeMb = 500;
+        bool mSvoSegmented = false;
+        bool mSvoDiskFull = false;
+        std::string mSvoDir;
+        std::string mSvoBaseName;
+        int mSvoSegIdx = 0;
+        SvoSegment mSvoCurrent;
+        std::chrono::steady_clock::time_point mSvoLastDiskCheck;
+
+        // SVO replay
+        bool mSvoRecordedTime = false; // SVO input stamped with the recorded timestamps
+        double mSvoReplayRate = 1.0;
+        std::string mSvoReplayAckTopic;
+        double mSvoReplayAckTimeout = 1.0;
+        bool mSvoPublishClock = true;
+        std::shared_ptr<ros::Publisher> mPubClock; // Null if another camera of the process publishes the clock
+        ros::Subscriber mSubReplayAck;
+        std::mutex mReplayAckMutex;
+        std::condition_variable mReplayAckCondVar;
+        ros::Time mReplayAckStamp;   // Last frame acknowledged by the consumers (protected by mReplayAckMutex)
+        ros::Time mReplayLastStamp;  // Last replayed frame
+        ros::Time mReplayFirstStamp; // Recorded timestamp of the first replayed frame
+        std::chrono::steady_clock::time_point mReplayWallStart;
+        uint64_t mReplayAckTimeouts = 0;
+
+        // Black box recording (protected by mRecMutex)
+        bool mBlackBoxEnabled = false;
+        double mBlackBoxPreSec = 10.0;
+        double mBlackBoxPostSec = 5.0;
+        double mBlackBoxSegmentSec = 2.0;
+        int mBlackBoxMaxSizeMb = 1024;
+        std::string mBlackBoxDir;
+        std::string mBlackBoxDumpRoot;
+        int mBlackBoxSegIdx = 0;
+        std::deque<SvoSegment> mBlackBoxSegments; // Closed segments of the pre-trigger window
+        bool mBlackBoxDumping = false;
+        ros::Time mBlackBoxDumpEnd;
+        std::string mBlackBoxDumpDir;
+        std::vector<SvoSegment> mBlackBoxDumpSegments;
+        std::thread mBlackBoxDumpThread;
+        std::atomic<bool> mBlackBoxCopying{false};
         sl::SVO_COMPRESSION_MODE mSvoComprMode;
 
         // Streaming
@@ -515,12 +948,21 @@ namespace zed_wrapper {
 
         // Thread Sync
         std::mutex mCloseZedMutex;
-        std::mutex mCamDataMutex;
         std::mutex mPcMutex;
         std::mutex mRecMutex;
         std::mutex mPosTrkMutex;
         std::condition_variable mPcDataReadyCondVar;
-        bool mPcDataReady;
+        bool mPcDataReady = false; // A point cloud job is queued (protected by mPcMutex)
+        bool mPcPublishCloud = false; // The queued job publishes the point cloud (protected by mPcMutex)
+        bool mPcPublishGrid = false; // The queued job publishes the obstacle grid (protected by mPcMutex)
+        bool mPcPublishNormals = false; // The queued job publishes the surface normals (protected by mPcMutex)
+
+        // Publishing periods
+        std::chrono::steady_clock::time_point mGrabLastTime;
+        std::chrono::steady_clock::time_point mPcLastPubTime;
+        std::chrono::steady_clock::time_point mPcLastRetrieveTime;
+        std::chrono::steady_clock::time_point mImuLastPubTime;
+        int mRateWarnCount = 0;
 
         // Point cloud variables
         sl::Mat mCloud;
@@ -530,22 +972,79 @@ namespace zed_wrapper {
         sensor_msgs::PointCloud2Ptr mPointcloudFusedMsg;
 #endif
         ros::Time mPointCloudTime;
+        uint64_t mPointCloudFrame = 0; // Index of the grabbed frame of the point cloud
+        tf2::Transform mPointCloudBaseTransf; // Coordinates of the point cloud frame in base frame
 
         // Dynamic reconfigure
         boost::shared_ptr<dynamic_reconfigure::Server<zed_wrapper::ZedConfig>> mDynRecServer;
 
-        // Coordinate Changing indices and signs
-        int mIdxX, mIdxY, mIdxZ;
-        int mSignX, mSignY, mSignZ;
-
         // Diagnostic
-        std::unique_ptr<sl_tools::CSmartMean> mElabPeriodMean_sec;
-        std::unique_ptr<sl_tools::CSmartMean> mGrabPeriodMean_usec;
-        std::unique_ptr<sl_tools::CSmartMean> mPcPeriodMean_usec;
-        std::unique_ptr<sl_tools::CSmartMean> mImuPeriodMean_usec;
+        sl_tools::CLatencyHistogram mElabTimeHist_usec;
+        sl_tools::CLatencyHistogram mGrabPeriodHist_usec;
+        sl_tools::CLatencyHistogram mPcPeriodHist_usec;
+        sl_tools::CLatencyHistogram mImuPeriodHist_usec;
+        sl_tools::CLatencyHistogram mImgConvTimeHist_usec;
+        sl_tools::CLatencyHistogram mPcConvTimeHist_usec;
+        sl_tools::CLatencyHistogram mSvoRecordHist_usec;
+        sl_tools::CLatencyHistogram mSvoSwitchHist_usec;
+        sl_tools::CLatencyHistogram mReplayAckWaitHist_usec;
+        sl_tools::CLatencyHistogram mSyncSkewHist_usec;
+        sl_tools::CLatencyHistogram mSyncWaitHist_usec;
+
+        // Values of the last diagnostic period: the histograms keep the whole run for the metrics
+        sl_tools::CLatencyWindow mElabTimeWin_usec;
+        sl_tools::CLatencyWindow mGrabPeriodWin_usec;
+        sl_tools::CLatencyWindow mPcPeriodWin_usec;
+        sl_tools::CLatencyWindow mImuPeriodWin_usec;
+        sl_tools::CLatencyWindow mSvoRecordWin_usec;
+        sl_tools::CLatencyWindow mReplayAckWaitWin_usec;
+        sl_tools::CLatencyWindow mSyncSkewWin_usec;
+        sl_tools::CLatencyWindow mSyncWaitWin_usec;
 
         diagnostic_updater::Updater mDiagUpdater; // Diagnostic Updater
 
+        // Latency tracing
+        sl_tools::CTracer mTracer;
+
+        // Metrics
+        int mMetricsPort = 0;
+        std::string mMetricsAddress;
+        sl_tools::CMetricsServer mMetricsServer;
+        std::map<std::string, std::unique_ptr<sl_tools::CPublishCounter>> mPubCounters;
+        std::atomic<uint64_t> mFrameCount{0};
+        std::atomic<uint64_t> mFrameDroppedCount{0};
+        std::atomic<uint64_t> mGrabErrorCount{0};
+        std::atomic<uint64_t> mGrabNotNewCount{0};
+        std::atomic<uint64_t> mCamSettingsSetCount{0}; // SDK calls of the grab loop to apply the camera settings
+        std::atomic<uint64_t> mCamSettingsGetCount{0}; // SDK calls of the grab loop to read the camera settings
+        std::chrono::steady_clock::time_point mStatsStartTime;
+
+        // Topic counters at the previous diagnostic update
+        struct TopicSnapshot {
+            uint64_t msgs = 0;
+            uint64_t bytes = 0;
+        };
+        std::map<std::string, TopicSnapshot> mDiagLastCounts;
+        std::chrono::steady_clock::time_point mDiagLastTime;
+
+        // Native recorder
+        enum RecorderChannel : uint16_t {
+            REC_CH_DEPTH = 0,
+            REC_CH_POINT_CLOUD,
+            REC_CH_ODOM,
+            REC_CH_IMU
+        };
+
+        sl_tools::CChunkRecorder mRecorder;
+        bool mRecorderEnabled = false;
+        std::string mRecorderFile;
+        bool mRecorderDepth = true;
+        bool mRecorderPointCloud = false;
+        bool mRecorderOdom = true;
+        bool mRecorderImu = true;
+        int mRecorderChunkKb = 4096;
+        bool mRecorderCompress = true;
+
     }; // class ZEDROSWrapperNodelet
 } // namespace
 
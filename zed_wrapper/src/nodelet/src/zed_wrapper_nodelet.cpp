@@ -24,8 +24,10 @@
 #include <ros/console.h>
 #endif
 
+#include <nav_msgs/OccupancyGrid.h>
 #include <nav_msgs/Odometry.h>
 #include <nav_msgs/Path.h>
+#include <rosgraph_msgs/Clock.h>
 #include <sensor_msgs/Imu.h>
 #include <sensor_msgs/distortion_models.h>
 #include <sensor_msgs/image_encodings.h>
@@ -34,7 +36,12 @@
 #include <geometry_msgs/PoseWithCovarianceStamped.h>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.h>
 
+#include <boost/weak_ptr.hpp>
+
+#include <algorithm>
 #include <chrono>
+#include <cstdio>
+#include <fstream>
 
 using namespace std;
 
@@ -45,16 +52,60 @@ namespace zed_wrapper {
 #define RAD2DEG 57.295777937
 #endif
 
+    namespace {
+        // Path history size used when `tracking/path_max_count` is not positive
+        const int PATH_MAX_COUNT_DEFAULT = 3600;
+
+        // Resources shared by all the cameras loaded in the same process (nodelet manager)
+        std::mutex gSharedMutex;
+        std::weak_ptr<sl_tools::CWorkerPool> gWorkerPool;
+        std::weak_ptr<sl_tools::CThreadBudget> gThreadBudget;
+        boost::weak_ptr<tf2_ros::Buffer> gTfBuffer;
+        boost::weak_ptr<tf2_ros::TransformListener> gTfListener;
+        boost::weak_ptr<tf2_ros::TransformBroadcaster> gTfBroadcaster;
+        std::map<std::string, std::weak_ptr<sl_tools::CFrameSynchronizer>> gFrameSyncs; // Sync groups
+        std::weak_ptr<ros::Publisher> gClockPublisher; // Owned by the only camera that publishes `/clock`
+
+        // Mean frequency of the periods of a diagnostic window [usec], 0 if no period has been recorded
+        double meanFrequency(const sl_tools::CLatencyWindow& periods_usec) {
+            double mean = periods_usec.getMean();
+            return mean > 0. ? 1000000. / mean : 0.;
+        }
+    }
+
     ZEDWrapperNodelet::ZEDWrapperNodelet() : Nodelet() {}
 
     ZEDWrapperNodelet::~ZEDWrapperNodelet() {
+        mMetricsServer.stop();
+
+        // Do not keep the other cameras of the sync group waiting
+        if (mFrameSync) {
+            mFrameSync->removeCamera(mFrameSyncId);
+        }
+
         if (mDevicePollThread.joinable()) {
             mDevicePollThread.join();
         }
 
-        if (mPcThread.joinable()) {
-            mPcThread.join();
+        // The point cloud job of the shared worker pool refers to this camera
+        {
+            std::unique_lock<std::mutex> lock(mPcMutex);
+
+            while (mPcDataReady) {
+                mPcDataReadyCondVar.wait(lock);
+            }
+        }
+
+        // The segment thread can start a black box dump: it must be stopped first
+        if (mSvoSegmentThread.joinable()) {
+            mSvoSegmentThread.join();
         }
+
+        if (mBlackBoxDumpThread.joinable()) {
+            mBlackBoxDumpThread.join();
+        }
+
+        mRecorder.close();
     }
 
     void ZEDWrapperNodelet::onInit() {
@@ -94,6 +145,9 @@ namespace zed_wrapper {
         string rgb_raw_topic = mRgbTopicRoot + raw_suffix + img_raw_topic;
         string stereo_topic = mStereoTopicRoot + img_topic;
         string stereo_raw_topic = mStereoTopicRoot + raw_suffix + img_raw_topic;
+        // Same layout of the `compressed` transport: base topic `<root>/jpeg`
+        string rgb_jpeg_topic = mRgbTopicRoot + "/jpeg/compressed";
+        string left_jpeg_topic = mLeftTopicRoot + "/jpeg/compressed";
 
         // Set the depth topic names
         string depth_topic = mDepthTopicRoot;
@@ -107,6 +161,7 @@ namespace zed_wrapper {
 
         string pointcloud_topic = mPointCloudTopicRoot + "/cloud_registered";
         string pointcloud_fused_topic = mPointCloudTopicRoot + "/fused_cloud_registered";
+        string normals_topic = mPointCloudTopicRoot + "/normals";
 
         string conf_img_topic_name = "confidence_image";
         string conf_map_topic_name = "confidence_map";
@@ -119,204 +174,80 @@ namespace zed_wrapper {
 
         string odom_path_topic = "path_odom";
         string map_path_topic = "path_map";
+        string odom_path_append_topic = odom_path_topic + "_append";
+        string map_path_append_topic = map_path_topic + "_append";
 
-        // Create camera info
-        mRgbCamInfoMsg.reset(new sensor_msgs::CameraInfo());
-        mLeftCamInfoMsg.reset(new sensor_msgs::CameraInfo());
-        mRightCamInfoMsg.reset(new sensor_msgs::CameraInfo());
-        mRgbCamInfoRawMsg.reset(new sensor_msgs::CameraInfo());
-        mLeftCamInfoRawMsg.reset(new sensor_msgs::CameraInfo());
-        mRightCamInfoRawMsg.reset(new sensor_msgs::CameraInfo());
-        mDepthCamInfoMsg.reset(new sensor_msgs::CameraInfo());
 
-        // Initialization transformation listener
-        mTfBuffer.reset(new tf2_ros::Buffer);
-        mTfListener.reset(new tf2_ros::TransformListener(*mTfBuffer));
+        // ----> Shared resources
+        // Multiple cameras loaded in the same nodelet manager share the TF
+        // objects and the worker threads
+        {
+            std::lock_guard<std::mutex> lock(gSharedMutex);
 
-        // Try to initialize the ZED
-        if (!mSvoFilepath.empty() || !mRemoteStreamAddr.empty()) {
-
-            if (!mSvoFilepath.empty()) {
-                mZedParams.svo_input_filename = mSvoFilepath.c_str();
-                mZedParams.svo_real_time_mode = false;
-            } else  if (!mRemoteStreamAddr.empty()) {
-#if ((ZED_SDK_MAJOR_VERSION>2) || (ZED_SDK_MAJOR_VERSION==2 && ZED_SDK_MINOR_VERSION>=8) )
-                std::vector<std::string> configStream = sl_tools::split_string(mRemoteStreamAddr, ':');
-                sl::String ip = sl::String(configStream.at(0).c_str());
+            mTfBuffer = gTfBuffer.lock();
 
-                if (configStream.size() == 2) {
-                    mZedParams.input.setFromStream(ip, atoi(configStream.at(1).c_str()));
-                } else {
-                    mZedParams.input.setFromStream(ip);
-                }
-
-#else
-                ROS_ERROR_STREAM("Acquiring a remote stream requires the ZED SDK v2.8 or newer");
-                return;
-#endif
+            if (!mTfBuffer) {
+                mTfBuffer.reset(new tf2_ros::Buffer);
+                gTfBuffer = mTfBuffer;
             }
 
-            mSvoMode = true;
-        } else {
-            mZedParams.camera_fps = mCamFrameRate;
-            mZedParams.camera_resolution = static_cast<sl::RESOLUTION>(mCamResol);
-
-            if (mZedSerialNumber == 0) {
-                mZedParams.camera_linux_id = mZedId;
-            } else {
-                bool waiting_for_camera = true;
+            mTfListener = gTfListener.lock();
 
-                while (waiting_for_camera) {
-                    // Ctrl+C check
-                    if (!mNhNs.ok()) {
-                        mStopNode = true; // Stops other threads
-
-                        std::lock_guard<std::mutex> lock(mCloseZedMutex);
-                        NODELET_DEBUG("Closing ZED");
-                        mZed.close();
-
-                        NODELET_DEBUG("ZED pool thread finished");
-                        return;
-                    }
-
-                    sl::DeviceProperties prop = sl_tools::getZEDFromSN(mZedSerialNumber);
-
-                    if (prop.id < -1 ||
-                        prop.camera_state == sl::CAMERA_STATE::CAMERA_STATE_NOT_AVAILABLE) {
-                        std::string msg = "ZED SN" + to_string(mZedSerialNumber) +
-                                          " not detected ! Please connect this ZED";
-                        NODELET_INFO_STREAM(msg.c_str());
-                        std::this_thread::sleep_for(std::chrono::milliseconds(2000));
-                    } else {
-                        waiting_for_camera = false;
-                        mZedParams.camera_linux_id = prop.id;
-                    }
-                }
+            if (!mTfListener) {
+                mTfListener.reset(new tf2_ros::TransformListener(*mTfBuffer));
+                gTfListener = mTfListener;
             }
-        }
-
-#if (ZED_SDK_MAJOR_VERSION<2)
-        NODELET_WARN_STREAM("Please consider to upgrade to latest SDK version to "
-                            "get better performances");
-
-        mZedParams.coordinate_system = sl::COORDINATE_SYSTEM_IMAGE;
-
-        NODELET_INFO_STREAM(" * Camera coordinate system\t-> COORDINATE_SYSTEM_IMAGE");
-        mIdxX = 2;
-        mIdxY = 0;
-        mIdxZ = 1;
-        mSignX = 1;
-        mSignY = -1;
-        mSignZ = -1;
-#elif (ZED_SDK_MAJOR_VERSION==2 && ZED_SDK_MINOR_VERSION<5)
-        NODELET_WARN_STREAM("Please consider to upgrade to latest SDK version to "
-                            "get latest features");
-
-        mZedParams.coordinate_system = sl::COORDINATE_SYSTEM_RIGHT_HANDED_Z_UP;
-
-        NODELET_INFO_STREAM(" * Camera coordinate system\t-> COORDINATE_SYSTEM_RIGHT_HANDED_Z_UP");
-        mIdxX = 1;
-        mIdxY = 0;
-        mIdxZ = 2;
-        mSignX = 1;
-        mSignY = -1;
-        mSignZ = 1;
-#else
-        mZedParams.coordinate_system = sl::COORDINATE_SYSTEM_RIGHT_HANDED_Z_UP_X_FWD;
-
-        NODELET_INFO_STREAM(" * Camera coordinate system\t-> COORDINATE_SYSTEM_RIGHT_HANDED_Z_UP_X_FWD");
-        mIdxX = 0;
-        mIdxY = 1;
-        mIdxZ = 2;
-        mSignX = 1;
-        mSignY = 1;
-        mSignZ = 1;
-#endif
 
-        mZedParams.coordinate_units = sl::UNIT_METER;
-        mZedParams.depth_mode = static_cast<sl::DEPTH_MODE>(mCamQuality);
-        mZedParams.sdk_verbose = mVerbose;
-        mZedParams.sdk_gpu_id = mGpuId;
-        mZedParams.depth_stabilization = mDepthStabilization;
-        mZedParams.camera_image_flip = mCameraFlip;
-        mZedParams.depth_minimum_distance = static_cast<float>(mCamMinDepth);
-        mZedParams.camera_disable_self_calib = !mCameraSelfCalib;
+            mTfBroadcaster = gTfBroadcaster.lock();
 
-        if (mVerMajor > 2 || (mVerMajor == 2 && mVerMinor >= 8)) {
-            //mZedParams.color_enhancement = mColorEnhancement; TODO uncomment when the paramenter is available
-        }
-
-        mDiagUpdater.add("ZED Diagnostic", this, &ZEDWrapperNodelet::updateDiagnostic);
-        mDiagUpdater.setHardwareID("ZED camera");
-
-        mConnStatus = sl::ERROR_CODE_CAMERA_NOT_DETECTED;
-
-        while (mConnStatus != sl::SUCCESS) {
-            mConnStatus = mZed.open(mZedParams);
-            NODELET_INFO_STREAM("ZED connection -> " << sl::toString(mConnStatus));
-            std::this_thread::sleep_for(std::chrono::milliseconds(2000));
-
-            if (!mNhNs.ok()) {
-                mStopNode = true; // Stops other threads
+            if (!mTfBroadcaster) {
+                mTfBroadcaster.reset(new tf2_ros::TransformBroadcaster);
+                gTfBroadcaster = mTfBroadcaster;
+            }
 
-                std::lock_guard<std::mutex> lock(mCloseZedMutex);
-                NODELET_DEBUG("Closing ZED");
-                mZed.close();
+            mWorkerPool = gWorkerPool.lock();
 
-                NODELET_DEBUG("ZED pool thread finished");
-                return;
+            if (!mWorkerPool) {
+                mWorkerPool.reset(new sl_tools::CWorkerPool(static_cast<unsigned int>(std::max(mWorkerThreads, 1))));
+                gWorkerPool = mWorkerPool;
+            } else if (static_cast<int>(mWorkerPool->getThreadCount()) != mWorkerThreads) {
+                NODELET_INFO_STREAM("Worker pool shared with the other cameras of the process: using "
+                                    << mWorkerPool->getThreadCount() << " worker threads");
             }
 
-            mDiagUpdater.update();
-        }
-
-        mZedRealCamModel = mZed.getCameraInformation().camera_model;
+            // The parallel regions of the grabbing threads (JPEG, depth compression) and of
+            // the worker pool jobs (obstacle grid, normals) share the cores of the machine
+            mThreadBudget = gThreadBudget.lock();
 
-        if (mZedRealCamModel == sl::MODEL_ZED) {
-            if (mZedUserCamModel != 0) {
-                NODELET_WARN("Camera model does not match user parameter. Please modify "
-                             "the value of the parameter 'camera_model' to 0");
+            if (!mThreadBudget) {
+                int cores = static_cast<int>(std::thread::hardware_concurrency());
+                mThreadBudget.reset(new sl_tools::CThreadBudget(std::max(cores, 1)));
+                gThreadBudget = mThreadBudget;
             }
-        } else if (mZedRealCamModel == sl::MODEL_ZED_M) {
-            if (mZedUserCamModel != 1) {
-                NODELET_WARN("Camera model does not match user parameter. Please modify "
-                             "the value of the parameter 'camera_model' to 1");
-            }
-        }
 
-        NODELET_INFO_STREAM(" * CAMERA MODEL\t -> " << sl::toString(mZedRealCamModel).c_str());
-        mZedSerialNumber = mZed.getCameraInformation().serial_number;
-        NODELET_INFO_STREAM(" * Serial Number -> " << mZedSerialNumber);
-
-        if (!mSvoMode) {
-            mFwVersion = mZed.getCameraInformation().firmware_version;
-            NODELET_INFO_STREAM(" * FW Version\t -> " << mFwVersion);
-        } else {
-#if ((ZED_SDK_MAJOR_VERSION>2) || (ZED_SDK_MAJOR_VERSION==2 && ZED_SDK_MINOR_VERSION>=8) )
-            NODELET_INFO_STREAM(" * Input type\t -> " << sl::toString(mZed.getCameraInformation().input_type).c_str());
-#else
-            NODELET_INFO_STREAM(" * Input type\t -> SVO");
-#endif
-        }
+            if (mSyncEnabled) {
+                mFrameSync = gFrameSyncs[mSyncGroup].lock();
 
-        // Set the IMU topic names using real camera model
-        string imu_topic;
-        string imu_topic_raw;
+                if (!mFrameSync) {
+                    mFrameSync.reset(new sl_tools::CFrameSynchronizer(static_cast<int64_t>(mSyncToleranceMsec * 1e6)));
+                    gFrameSyncs[mSyncGroup] = mFrameSync;
+                } else if (mFrameSync->getTolerance() != static_cast<int64_t>(mSyncToleranceMsec * 1e6)) {
+                    NODELET_INFO_STREAM("Sync group '" << mSyncGroup << "' shared with the other cameras of the process: using a tolerance of "
+                                        << mFrameSync->getTolerance() / 1e6 << " msec");
+                }
 
-        if (mZedRealCamModel == sl::MODEL_ZED_M) {
-            string imu_topic_name = "data";
-            string imu_topic_raw_name = "data_raw";
-            imu_topic = mImuTopicRoot + "/" + imu_topic_name;
-            imu_topic_raw = mImuTopicRoot + "/" + imu_topic_raw_name;
+                mFrameSyncId = mFrameSync->addCamera(getName());
+            }
         }
+        // <---- Shared resources
 
-        mDiagUpdater.setHardwareIDf("%s-%d", sl::toString(mZedRealCamModel).c_str(), mZedSerialNumber);
+        mDiagUpdater.add("ZED Diagnostic", this, &ZEDWrapperNodelet::updateDiagnostic);
+        mDiagUpdater.setHardwareID("ZED camera");
 
-        // Dynamic Reconfigure parameters
-        mDynRecServer = boost::make_shared<dynamic_reconfigure::Server<zed_wrapper::ZedConfig>>();
-        dynamic_reconfigure::Server<zed_wrapper::ZedConfig>::CallbackType f;
-        f = boost::bind(&ZEDWrapperNodelet::dynamicReconfCallback, this, _1, _2);
-        mDynRecServer->setCallback(f);
+        // Discovery and opening take seconds: the camera is opened while the
+        // TF listener receives the static transforms and the publishers that
+        // do not depend on the camera model are advertised
+        std::future<bool> cameraOpened = std::async(std::launch::async, &ZEDWrapperNodelet::openCamera, this);
 
         // Create all the publishers
         // Image publishers
@@ -341,9 +272,15 @@ namespace zed_wrapper {
         mPubRawRight = it_zed.advertiseCamera(right_raw_topic, 1); // right raw
         NODELET_INFO_STREAM("Advertised on topic " << mPubRawRight.getTopic());
         NODELET_INFO_STREAM("Advertised on topic " << mPubRawRight.getInfoTopic());
+        mPubRgbJpeg = mNhNs.advertise<sensor_msgs::CompressedImage>(rgb_jpeg_topic, 1); // rgb jpeg
+        NODELET_INFO_STREAM("Advertised on topic " << mPubRgbJpeg.getTopic());
+        mPubLeftJpeg = mNhNs.advertise<sensor_msgs::CompressedImage>(left_jpeg_topic, 1); // left jpeg
+        NODELET_INFO_STREAM("Advertised on topic " << mPubLeftJpeg.getTopic());
         mPubDepth = it_zed.advertiseCamera(depth_topic, 1); // depth
         NODELET_INFO_STREAM("Advertised on topic " << mPubDepth.getTopic());
         NODELET_INFO_STREAM("Advertised on topic " << mPubDepth.getInfoTopic());
+        mPubDepthCompressed = mNhNs.advertise<sensor_msgs::CompressedImage>(depth_topic + "/zdepth", 1); // compressed depth
+        NODELET_INFO_STREAM("Advertised on topic " << mPubDepthCompressed.getTopic());
         mPubConfImg = it_zed.advertiseCamera(conf_img_topic, 1); // confidence image
         NODELET_INFO_STREAM("Advertised on topic " << mPubConfImg.getTopic());
         NODELET_INFO_STREAM("Advertised on topic " << mPubConfImg.getInfoTopic());
@@ -361,11 +298,32 @@ namespace zed_wrapper {
         mPubDisparity = mNhNs.advertise<stereo_msgs::DisparityImage>(mDisparityTopic, 1);
         NODELET_INFO_STREAM("Advertised on topic " << mPubDisparity.getTopic());
 
+        // Laser scan publisher
+        mPubScan = mNhNs.advertise<sensor_msgs::LaserScan>(mScanTopic, 1);
+        NODELET_INFO_STREAM("Advertised on topic " << mPubScan.getTopic());
+
         // PointCloud publisher
         mPointcloudMsg.reset(new sensor_msgs::PointCloud2);
         mPubCloud = mNhNs.advertise<sensor_msgs::PointCloud2>(pointcloud_topic, 1);
         NODELET_INFO_STREAM("Advertised on topic " << mPubCloud.getTopic());
 
+        // Surface normals publisher
+        mPubNormals = mNhNs.advertise<sensor_msgs::Image>(normals_topic, 1);
+        NODELET_INFO_STREAM("Advertised on topic " << mPubNormals.getTopic());
+
+        // Obstacle grid publisher
+        mPubObstacleGrid = mNhNs.advertise<nav_msgs::OccupancyGrid>(mObstacleGridTopic, 1);
+        NODELET_INFO_STREAM("Advertised on topic " << mPubObstacleGrid.getTopic());
+
+        // Elevation map publisher
+        if (mElevationPubRate > 0) {
+            mPubElevationMap = mNhNs.advertise<sensor_msgs::PointCloud2>(mElevationMapTopic, 1);
+            NODELET_INFO_STREAM("Advertised on topic " << mPubElevationMap.getTopic() << " @ " << mElevationPubRate << " Hz");
+
+            mElevationTimer = mNhNs.createTimer(ros::Duration(1.0 / mElevationPubRate),
+                                                &ZEDWrapperNodelet::pubElevationMapCallback, this);
+        }
+
 #if ((ZED_SDK_MAJOR_VERSION>2) || (ZED_SDK_MAJOR_VERSION==2 && ZED_SDK_MINOR_VERSION>=8) )
 
         if (mMappingEnabled) {
@@ -398,17 +356,73 @@ namespace zed_wrapper {
             mPathTimer = mNhNs.createTimer(ros::Duration(1.0 / mPathPubRate),
                                            &ZEDWrapperNodelet::pathPubCallback, this);
 
-            if (mPathMaxCount != -1) {
-                NODELET_DEBUG_STREAM("Path vectors reserved " << mPathMaxCount << " poses.");
-                mOdomPath.reserve(mPathMaxCount);
-                mMapPath.reserve(mPathMaxCount);
-
-                NODELET_DEBUG_STREAM("Path vector sizes: " << mOdomPath.size() << " " << mMapPath.size());
+            if (mPublishPathAppend) {
+                mPubOdomPathAppend = mNhNs.advertise<geometry_msgs::PoseStamped>(odom_path_append_topic, 10);
+                NODELET_INFO_STREAM("Advertised on topic " << mPubOdomPathAppend.getTopic());
+                mPubMapPathAppend = mNhNs.advertise<geometry_msgs::PoseStamped>(map_path_append_topic, 10);
+                NODELET_INFO_STREAM("Advertised on topic " << mPubMapPathAppend.getTopic());
             }
+
+            mOdomPath.setCapacity(mPathMaxCount);
+            mMapPath.setCapacity(mPathMaxCount);
+            NODELET_DEBUG_STREAM("Path buffers reserved " << mPathMaxCount << " poses.");
         } else {
             NODELET_INFO_STREAM("Path topics not published -> mPathPubRate: " << mPathPubRate);
         }
 
+        // Wait for the camera opened in parallel
+        if (!cameraOpened.get()) {
+            return;
+        }
+
+        mZedRealCamModel = mZed.getCameraInformation().camera_model;
+
+        if (mZedRealCamModel == sl::MODEL_ZED) {
+            if (mZedUserCamModel != 0) {
+                NODELET_WARN("Camera model does not match user parameter. Please modify "
+                             "the value of the parameter 'camera_model' to 0");
+            }
+        } else if (mZedRealCamModel == sl::MODEL_ZED_M) {
+            if (mZedUserCamModel != 1) {
+                NODELET_WARN("Camera model does not match user parameter. Please modify "
+                             "the value of the parameter 'camera_model' to 1");
+            }
+        }
+
+        NODELET_INFO_STREAM(" * CAMERA MODEL\t -> " << sl::toString(mZedRealCamModel).c_str());
+        mZedSerialNumber = mZed.getCameraInformation().serial_number;
+        NODELET_INFO_STREAM(" * Serial Number -> " << mZedSerialNumber);
+
+        if (!mSvoMode) {
+            mFwVersion = mZed.getCameraInformation().firmware_version;
+            NODELET_INFO_STREAM(" * FW Version\t -> " << mFwVersion);
+        } else {
+#if ((ZED_SDK_MAJOR_VERSION>2) || (ZED_SDK_MAJOR_VERSION==2 && ZED_SDK_MINOR_VERSION>=8) )
+            NODELET_INFO_STREAM(" * Input type\t -> " << sl::toString(mZed.getCameraInformation().input_type).c_str());
+#else
+            NODELET_INFO_STREAM(" * Input type\t -> SVO");
+#endif
+        }
+
+        // Set the IMU topic names using real camera model
+        string imu_topic;
+        string imu_topic_raw;
+
+        if (mZedRealCamModel == sl::MODEL_ZED_M) {
+            string imu_topic_name = "data";
+            string imu_topic_raw_name = "data_raw";
+            imu_topic = mImuTopicRoot + "/" + imu_topic_name;
+            imu_topic_raw = mImuTopicRoot + "/" + imu_topic_raw_name;
+        }
+
+        mDiagUpdater.setHardwareIDf("%s-%d", sl::toString(mZedRealCamModel).c_str(), mZedSerialNumber);
+
+        // Dynamic Reconfigure parameters
+        mDynRecServer = boost::make_shared<dynamic_reconfigure::Server<zed_wrapper::ZedConfig>>();
+        dynamic_reconfigure::Server<zed_wrapper::ZedConfig>::CallbackType f;
+        f = boost::bind(&ZEDWrapperNodelet::dynamicReconfCallback, this, _1, _2);
+        mDynRecServer->setCallback(f);
+
         // Imu publisher
 
         if (!mSvoMode) {
@@ -422,7 +436,7 @@ namespace zed_wrapper {
                 mFrameTimestamp = ros::Time::now();
                 mImuTimer = mNhNs.createTimer(ros::Duration(1.0 / mImuPubRate),
                                               &ZEDWrapperNodelet::imuPubCallback, this);
-                mImuPeriodMean_usec.reset(new sl_tools::CSmartMean(mImuPubRate / 2));
+                mImuPeriodHist_usec.reset();
             } else if (mImuPubRate > 0 && mZedRealCamModel == sl::MODEL_ZED) {
                 NODELET_WARN_STREAM(
                     "'imu_pub_rate' set to "
@@ -437,6 +451,38 @@ namespace zed_wrapper {
         mSrvResetTracking = mNhNs.advertiseService("reset_tracking", &ZEDWrapperNodelet::on_reset_tracking, this);
         mSrvSvoStartRecording = mNhNs.advertiseService("start_svo_recording", &ZEDWrapperNodelet::on_start_svo_recording, this);
         mSrvSvoStopRecording = mNhNs.advertiseService("stop_svo_recording", &ZEDWrapperNodelet::on_stop_svo_recording, this);
+        mSrvSetTracing = mNhNs.advertiseService("set_tracing", &ZEDWrapperNodelet::on_set_tracing, this);
+        mSrvResetStatistics = mNhNs.advertiseService("reset_statistics", &ZEDWrapperNodelet::on_reset_statistics, this);
+        mSrvGetStats = mNhNs.advertiseService("get_stats", &ZEDWrapperNodelet::on_get_stats, this);
+
+        if (mBlackBoxEnabled) {
+            mSrvDumpRecording = mNhNs.advertiseService("dump_recording", &ZEDWrapperNodelet::on_dump_recording, this);
+        }
+
+        if (mSyncEnabled) {
+            mPubFrameSync = mNhNs.advertise<zed_wrapper::FrameSync>("frame_sync", 10);
+            NODELET_INFO_STREAM("Advertised on topic " << mPubFrameSync.getTopic());
+        }
+
+        // SVO replay
+        if (mSvoRecordedTime && mSvoPublishClock) {
+            // Two sources on `/clock` would make the time jump back and forth
+            std::lock_guard<std::mutex> lock(gSharedMutex);
+
+            if (gClockPublisher.expired()) {
+                mPubClock = std::make_shared<ros::Publisher>(mNh.advertise<rosgraph_msgs::Clock>("/clock", 10));
+                gClockPublisher = mPubClock;
+                NODELET_INFO_STREAM("Advertised on topic " << mPubClock->getTopic() << " (SVO recorded time)");
+            } else {
+                NODELET_WARN_STREAM("Another camera of the process publishes the SVO recorded time on /clock: "
+                                    "this camera does not publish it");
+            }
+        }
+
+        if (mSvoRecordedTime && !mSvoReplayAckTopic.empty()) {
+            mSubReplayAck = mNh.subscribe(mSvoReplayAckTopic, 10, &ZEDWrapperNodelet::replayAckCallback, this);
+            NODELET_INFO_STREAM("Subscribed to topic " << mSubReplayAck.getTopic() << " (replay acknowledge)");
+        }
 
         if (mVerMajor > 2 || (mVerMajor == 2 && mVerMinor >= 8)) {
             mSrvSetLedStatus = mNhNs.advertiseService("set_led_status", &ZEDWrapperNodelet::on_set_led_status, this);
@@ -445,13 +491,177 @@ namespace zed_wrapper {
             mSrvSvoStopStream = mNhNs.advertiseService("stop_remote_stream", &ZEDWrapperNodelet::on_stop_remote_stream, this);
         }
 
-        // Start Pointcloud thread
-        mPcThread = std::thread(&ZEDWrapperNodelet::pointcloud_thread_func, this);
+        // ----> Metrics
+        // The counters must be created before starting the publishing threads:
+        // the map is never modified later, so it can be accessed without locking
+        std::vector<std::string> pubTopics = {
+            mPubRgb.getTopic(), mPubRawRgb.getTopic(), mPubLeft.getTopic(), mPubRawLeft.getTopic(),
+            mPubRgbJpeg.getTopic(), mPubLeftJpeg.getTopic(),
+            mPubRight.getTopic(), mPubRawRight.getTopic(), mPubDepth.getTopic(), mPubDepthCompressed.getTopic(), mPubConfImg.getTopic(),
+            mPubStereo.getTopic(), mPubRawStereo.getTopic(), mPubConfMap.getTopic(), mPubDisparity.getTopic(),
+            mPubCloud.getTopic(), mPubFusedCloud.getTopic(), mPubImu.getTopic(), mPubImuRaw.getTopic(),
+            mPubScan.getTopic(), mPubObstacleGrid.getTopic(), mPubElevationMap.getTopic(), mPubNormals.getTopic()
+        };
+
+        for (const std::string& topic : pubTopics) {
+            if (!topic.empty()) {
+                mPubCounters[topic].reset(new sl_tools::CPublishCounter());
+            }
+        }
+
+        mStatsStartTime = std::chrono::steady_clock::now();
+        mDiagLastTime = mStatsStartTime;
+
+        if (mMetricsPort > 0) {
+            if (mMetricsServer.start(mMetricsAddress, mMetricsPort, std::bind(&ZEDWrapperNodelet::getMetricsPage, this))) {
+                NODELET_INFO_STREAM("Metrics available on http://" << mMetricsAddress << ":" << mMetricsPort << "/metrics");
+            } else {
+                NODELET_WARN_STREAM("Cannot start the metrics server on " << mMetricsAddress << ":" << mMetricsPort);
+            }
+        }
+        // <---- Metrics
+
+        if (mRecorderEnabled) {
+            startRecorder();
+        }
+
+        mPcLastPubTime = std::chrono::steady_clock::now();
+        mImuLastPubTime = mPcLastPubTime;
+        mGrabLastTime = mPcLastPubTime;
+
+        // Start SVO segment thread
+        mSvoSegmentThread = std::thread(&ZEDWrapperNodelet::svo_segment_thread_func, this);
 
         // Start pool thread
         mDevicePollThread = std::thread(&ZEDWrapperNodelet::device_poll_thread_func, this);
     }
 
+    bool ZEDWrapperNodelet::openCamera() {
+        if (!mSvoFilepath.empty() || !mRemoteStreamAddr.empty()) {
+
+            if (!mSvoFilepath.empty()) {
+                mZedParams.svo_input_filename = mSvoFilepath.c_str();
+                mZedParams.svo_real_time_mode = false;
+            } else  if (!mRemoteStreamAddr.empty()) {
+#if ((ZED_SDK_MAJOR_VERSION>2) || (ZED_SDK_MAJOR_VERSION==2 && ZED_SDK_MINOR_VERSION>=8) )
+                std::vector<std::string> configStream = sl_tools::split_string(mRemoteStreamAddr, ':');
+                sl::String ip = sl::String(configStream.at(0).c_str());
+
+                if (configStream.size() == 2) {
+                    mZedParams.input.setFromStream(ip, atoi(configStream.at(1).c_str()));
+                } else {
+                    mZedParams.input.setFromStream(ip);
+                }
+
+#else
+                ROS_ERROR_STREAM("Acquiring a remote stream requires the ZED SDK v2.8 or newer");
+                return false;
+#endif
+            }
+
+            mSvoMode = true;
+        } else {
+            mZedParams.camera_fps = mCamFrameRate;
+            mZedParams.camera_resolution = static_cast<sl::RESOLUTION>(mCamResol);
+
+            if (mZedSerialNumber == 0) {
+                mZedParams.camera_linux_id = mZedId;
+            } else {
+                bool waiting_for_camera = true;
+
+                while (waiting_for_camera) {
+                    // Ctrl+C check
+                    if (!mNhNs.ok()) {
+                        mStopNode = true; // Stops other threads
+
+                        std::lock_guard<std::mutex> lock(mCloseZedMutex);
+                        NODELET_DEBUG("Closing ZED");
+                        mZed.close();
+
+                        NODELET_DEBUG("ZED pool thread finished");
+                        return false;
+                    }
+
+                    sl::DeviceProperties prop = sl_tools::getZEDFromSN(mZedSerialNumber);
+
+                    if (prop.id < -1 ||
+                        prop.camera_state == sl::CAMERA_STATE::CAMERA_STATE_NOT_AVAILABLE) {
+                        std::string msg = "ZED SN" + to_string(mZedSerialNumber) +
+                                          " not detected ! Please connect this ZED";
+                        NODELET_INFO_STREAM_THROTTLE(2.0, msg.c_str());
+                        // Short polling period: the camera is opened as soon as it is connected
+                        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                    } else {
+                        waiting_for_camera = false;
+                        mZedParams.camera_linux_id = prop.id;
+                    }
+                }
+            }
+        }
+
+#if (ZED_SDK_MAJOR_VERSION<2)
+        NODELET_WARN_STREAM("Please consider to upgrade to latest SDK version to "
+                            "get better performances");
+
+        mZedParams.coordinate_system = sl::COORDINATE_SYSTEM_IMAGE;
+
+        NODELET_INFO_STREAM(" * Camera coordinate system\t-> COORDINATE_SYSTEM_IMAGE");
+#elif (ZED_SDK_MAJOR_VERSION==2 && ZED_SDK_MINOR_VERSION<5)
+        NODELET_WARN_STREAM("Please consider to upgrade to latest SDK version to "
+                            "get latest features");
+
+        mZedParams.coordinate_system = sl::COORDINATE_SYSTEM_RIGHT_HANDED_Z_UP;
+
+        NODELET_INFO_STREAM(" * Camera coordinate system\t-> COORDINATE_SYSTEM_RIGHT_HANDED_Z_UP");
+#else
+        mZedParams.coordinate_system = sl::COORDINATE_SYSTEM_RIGHT_HANDED_Z_UP_X_FWD;
+
+        NODELET_INFO_STREAM(" * Camera coordinate system\t-> COORDINATE_SYSTEM_RIGHT_HANDED_Z_UP_X_FWD");
+#endif
+
+        mZedParams.coordinate_units = sl::UNIT_METER;
+        mZedParams.depth_mode = static_cast<sl::DEPTH_MODE>(mCamQuality);
+        mZedParams.sdk_verbose = mVerbose;
+        mZedParams.sdk_gpu_id = mGpuId;
+        mZedParams.depth_stabilization = mDepthStabilization;
+        mZedParams.camera_image_flip = mCameraFlip;
+        mZedParams.depth_minimum_distance = static_cast<float>(mCamMinDepth);
+        mZedParams.camera_disable_self_calib = !mCameraSelfCalib;
+
+        if (mVerMajor > 2 || (mVerMajor == 2 && mVerMinor >= 8)) {
+            //mZedParams.color_enhancement = mColorEnhancement; TODO uncomment when the paramenter is available
+        }
+
+        mConnStatus = sl::ERROR_CODE_CAMERA_NOT_DETECTED;
+
+        while (mConnStatus != sl::SUCCESS) {
+            mConnStatus = mZed.open(mZedParams);
+            NODELET_INFO_STREAM("ZED connection -> " << sl::toString(mConnStatus));
+
+            if (mConnStatus == sl::SUCCESS) {
+                break;
+            }
+
+            // Retry delay only on failure
+            std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+            if (!mNhNs.ok()) {
+                mStopNode = true; // Stops other threads
+
+                std::lock_guard<std::mutex> lock(mCloseZedMutex);
+                NODELET_DEBUG("Closing ZED");
+                mZed.close();
+
+                NODELET_DEBUG("ZED pool thread finished");
+                return false;
+            }
+
+            mDiagUpdater.update();
+        }
+
+        return true;
+    }
+
     void ZEDWrapperNodelet::readParameters() {
 
         NODELET_INFO_STREAM("*** PARAMETERS ***");
@@ -474,6 +684,30 @@ namespace zed_wrapper {
         NODELET_INFO_STREAM(" * Camera Flip\t\t\t-> " << (mCameraFlip ? "ENABLED" : "DISABLED"));
         mNhNs.param<bool>("general/self_calib", mCameraSelfCalib, true);
         NODELET_INFO_STREAM(" * Self calibration\t\t-> " << (mCameraSelfCalib ? "ENABLED" : "DISABLED"));
+        mNhNs.param<int>("general/worker_threads", mWorkerThreads, 2);
+        NODELET_INFO_STREAM(" * Worker threads\t\t-> " << mWorkerThreads);
+        mNhNs.param<bool>("frame_sync/sync_enabled", mSyncEnabled, false);
+        NODELET_INFO_STREAM(" * Frame sync\t\t\t-> " << (mSyncEnabled ? "ENABLED" : "DISABLED"));
+
+        if (mSyncEnabled) {
+            mNhNs.param<std::string>("frame_sync/group", mSyncGroup, "zed_sync");
+            NODELET_INFO_STREAM(" * Frame sync group\t\t-> " << mSyncGroup);
+            mNhNs.param<double>("frame_sync/tolerance_msec", mSyncToleranceMsec, 5.0);
+            NODELET_INFO_STREAM(" * Frame sync tolerance\t\t-> " << mSyncToleranceMsec << " msec");
+            mNhNs.param<double>("frame_sync/max_wait_msec", mSyncMaxWaitMsec, 20.0);
+            NODELET_INFO_STREAM(" * Frame sync max wait\t\t-> " << mSyncMaxWaitMsec << " msec");
+            mNhNs.param<bool>("frame_sync/use_bundle_stamp", mSyncUseBundleStamp, true);
+            NODELET_INFO_STREAM(" * Frame sync bundle stamp\t-> " << (mSyncUseBundleStamp ? "ENABLED" : "DISABLED"));
+        }
+
+        mNhNs.param<int>("general/metrics_port", mMetricsPort, 0);
+        mNhNs.param<std::string>("general/metrics_address", mMetricsAddress, "127.0.0.1");
+
+        if (mMetricsPort > 0) {
+            NODELET_INFO_STREAM(" * Metrics server\t\t-> " << mMetricsAddress << ":" << mMetricsPort);
+        } else {
+            NODELET_INFO_STREAM(" * Metrics server\t\t-> DISABLED");
+        }
 
         int tmp_sn = 0;
         mNhNs.getParam("general/serial_number", tmp_sn);
@@ -506,6 +740,10 @@ namespace zed_wrapper {
         mNhNs.param<std::string>("video/right_topic_root", mRightTopicRoot, "right");
         mNhNs.param<std::string>("video/left_topic_root", mLeftTopicRoot, "left");
         mNhNs.param<std::string>("video/stereo_topic_root", mStereoTopicRoot, "stereo");
+
+        mNhNs.getParam("video/jpeg_quality", mJpegQuality);
+        mJpegQuality = std::min(std::max(mJpegQuality, 1), 100);
+        NODELET_INFO_STREAM(" * JPEG quality\t\t-> " << mJpegQuality);
         // <---- Video
 
         // -----> Depth
@@ -525,8 +763,73 @@ namespace zed_wrapper {
         NODELET_INFO_STREAM(" * Depth Stabilization\t\t-> " << (mDepthStabilization ? "ENABLED" : "DISABLED"));
         mNhNs.getParam("depth/min_depth", mCamMinDepth);
         NODELET_INFO_STREAM(" * Minimum depth\t\t-> " <<  mCamMinDepth);
+        mNhNs.getParam("depth/codec_quantization", mDepthCodecQuantization);
+        NODELET_INFO_STREAM(" * Codec quantization\t\t-> " << mDepthCodecQuantization);
+        mNhNs.getParam("depth/codec_band_rows", mDepthCodecBandRows);
+        NODELET_INFO_STREAM(" * Codec band rows\t\t-> " << mDepthCodecBandRows);
         // <----- Depth
 
+        // -----> Laser scan
+        mNhNs.param<std::string>("scan/scan_topic", mScanTopic, "scan");
+        mNhNs.getParam("scan/scan_height", mScanHeight);
+        NODELET_INFO_STREAM(" * Scan height\t\t\t-> " << mScanHeight);
+        mNhNs.getParam("scan/row_offset", mScanRowOffset);
+        NODELET_INFO_STREAM(" * Scan row offset\t\t-> " << mScanRowOffset);
+        mNhNs.getParam("scan/range_min", mScanRangeMin);
+        NODELET_INFO_STREAM(" * Scan minimum range\t\t-> " << mScanRangeMin);
+        mNhNs.getParam("scan/range_max", mScanRangeMax);
+        NODELET_INFO_STREAM(" * Scan maximum range\t\t-> " << mScanRangeMax);
+        mNhNs.getParam("scan/angle_increment", mScanAngleIncrement);
+        NODELET_INFO_STREAM(" * Scan angle increment\t\t-> " << mScanAngleIncrement);
+
+        mDepthToScan.setParams(mScanHeight, mScanRowOffset, static_cast<float>(mScanRangeMin),
+                               static_cast<float>(mScanRangeMax), static_cast<float>(mScanAngleIncrement));
+        // <----- Laser scan
+
+        // -----> Obstacle grid
+        mNhNs.param<std::string>("obstacle_grid/grid_topic", mObstacleGridTopic, "obstacle_grid");
+        mNhNs.getParam("obstacle_grid/resolution", mGridResolution);
+        NODELET_INFO_STREAM(" * Grid resolution\t\t-> " << mGridResolution);
+        mNhNs.getParam("obstacle_grid/size", mGridSize);
+        NODELET_INFO_STREAM(" * Grid size\t\t\t-> " << mGridSize);
+        mNhNs.getParam("obstacle_grid/min_height", mGridMinHeight);
+        NODELET_INFO_STREAM(" * Grid min height\t\t-> " << mGridMinHeight);
+        mNhNs.getParam("obstacle_grid/max_height", mGridMaxHeight);
+        NODELET_INFO_STREAM(" * Grid max height\t\t-> " << mGridMaxHeight);
+        mNhNs.getParam("obstacle_grid/min_points", mGridMinPoints);
+        NODELET_INFO_STREAM(" * Grid min points\t\t-> " << mGridMinPoints);
+
+        mObstacleGrid.setParams(static_cast<float>(mGridResolution), static_cast<float>(mGridSize),
+                                static_cast<float>(mGridMinHeight), static_cast<float>(mGridMaxHeight), mGridMinPoints);
+        // <----- Obstacle grid
+
+        // -----> Surface normals
+        mNhNs.getParam("normals/radius", mNormalsRadius);
+        NODELET_INFO_STREAM(" * Normals radius\t\t-> " << mNormalsRadius);
+
+        mNormalEstimator.setParams(mNormalsRadius);
+        // <----- Surface normals
+
+        // -----> Elevation map
+        mNhNs.param<std::string>("elevation_map/map_topic", mElevationMapTopic, "elevation_map");
+        mNhNs.getParam("elevation_map/resolution", mElevationResolution);
+        NODELET_INFO_STREAM(" * Elevation resolution\t\t-> " << mElevationResolution);
+        mNhNs.getParam("elevation_map/size", mElevationSize);
+        NODELET_INFO_STREAM(" * Elevation map size\t\t-> " << mElevationSize);
+        mNhNs.getParam("elevation_map/pixel_stride", mElevationPixelStride);
+        NODELET_INFO_STREAM(" * Elevation pixel stride\t-> " << mElevationPixelStride);
+        mNhNs.getParam("elevation_map/max_range", mElevationMaxRange);
+        NODELET_INFO_STREAM(" * Elevation max range\t\t-> " << mElevationMaxRange);
+        mNhNs.getParam("elevation_map/max_height", mElevationMaxHeight);
+        NODELET_INFO_STREAM(" * Elevation max height\t\t-> " << mElevationMaxHeight);
+        mNhNs.getParam("elevation_map/publish_rate", mElevationPubRate);
+        NODELET_INFO_STREAM(" * Elevation publish rate\t-> " << mElevationPubRate);
+
+        mElevationMap.setParams(static_cast<float>(mElevationResolution), static_cast<float>(mElevationSize),
+                                mElevationPixelStride, static_cast<float>(mElevationMaxRange),
+                                static_cast<float>(mElevationMaxHeight));
+        // <----- Elevation map
+
         // ----> Tracking
         mNhNs.param<std::string>("tracking/pose_topic", mPoseTopic, "pose");
         mNhNs.param<std::string>("tracking/odometry_topic", mOdometryTopic, "odom");
@@ -534,13 +837,23 @@ namespace zed_wrapper {
         mNhNs.getParam("tracking/path_pub_rate", mPathPubRate);
         NODELET_INFO_STREAM(" * Path rate\t\t\t-> " <<  mPathPubRate << " Hz");
         mNhNs.getParam("tracking/path_max_count", mPathMaxCount);
-        NODELET_INFO_STREAM(" * Path history size\t\t-> " << (mPathMaxCount == -1) ? std::string("INFINITE") : std::to_string(
-                                mPathMaxCount));
 
-        if (mPathMaxCount < 2 && mPathMaxCount != -1) {
+        // The path is never unbounded: a long running node would grow it without limit
+        if (mPathMaxCount <= 0) {
+            mPathMaxCount = PATH_MAX_COUNT_DEFAULT;
+        } else if (mPathMaxCount < 2) {
             mPathMaxCount = 2;
         }
 
+        NODELET_INFO_STREAM(" * Path history size\t\t-> " << mPathMaxCount);
+
+        mNhNs.getParam("tracking/path_min_dist", mPathMinDist);
+        NODELET_INFO_STREAM(" * Path min. distance\t\t-> " << mPathMinDist << " m");
+        mNhNs.getParam("tracking/path_min_angle", mPathMinAngle);
+        NODELET_INFO_STREAM(" * Path min. angle\t\t-> " << mPathMinAngle << " rad");
+        mNhNs.getParam("tracking/publish_path_append", mPublishPathAppend);
+        NODELET_INFO_STREAM(" * Publish path append\t\t-> " << (mPublishPathAppend ? "ENABLED" : "DISABLED"));
+
         mNhNs.getParam("tracking/initial_base_pose", mInitialBasePose);
 
         mNhNs.getParam("tracking/odometry_DB", mOdometryDb);
@@ -630,8 +943,98 @@ namespace zed_wrapper {
         mSvoComprMode = static_cast<sl::SVO_COMPRESSION_MODE>(svo_compr);
 
         NODELET_INFO_STREAM(" * SVO REC compression\t\t-> " << sl::toString(mSvoComprMode));
+        mNhNs.param<double>("general/svo_segment_max_sec", mSvoSegmentMaxSec, 0.0);
+        mNhNs.param<int>("general/svo_segment_max_mb", mSvoSegmentMaxMb, 0);
+
+        if (mSvoSegmentMaxSec > 0.0 || mSvoSegmentMaxMb > 0) {
+            NODELET_INFO_STREAM(" * SVO REC segments\t\t-> " << mSvoSegmentMaxSec << " sec / " << mSvoSegmentMaxMb << " MB");
+        } else {
+            NODELET_INFO_STREAM(" * SVO REC segments\t\t-> DISABLED");
+        }
+
+        mNhNs.param<int>("general/svo_min_free_disk_mb", mSvoMinFreeMb, 500);
+        NODELET_INFO_STREAM(" * SVO REC min. free disk\t-> " << mSvoMinFreeMb << " MB");
+
+        if (!mSvoFilepath.empty()) {
+            mNhNs.param<bool>("svo_replay/use_recorded_time", mSvoRecordedTime, false);
+            NODELET_INFO_STREAM(" * SVO recorded time\t\t-> " << (mSvoRecordedTime ? "ENABLED" : "DISABLED"));
+        }
+
+        if (mSvoRecordedTime) {
+            mNhNs.param<double>("svo_replay/rate", mSvoReplayRate, 1.0);
+
+            if (mSvoReplayRate > 0.0) {
+                NODELET_INFO_STREAM(" * SVO replay rate\t\t-> " << mSvoReplayRate << "x");
+            } else {
+                NODELET_INFO_STREAM(" * SVO replay rate\t\t-> AS FAST AS POSSIBLE");
+            }
+
+            mNhNs.param<bool>("svo_replay/publish_clock", mSvoPublishClock, true);
+            NODELET_INFO_STREAM(" * SVO replay publish clock\t-> " << (mSvoPublishClock ? "ENABLED" : "DISABLED"));
+
+            mNhNs.param<std::string>("svo_replay/ack_topic", mSvoReplayAckTopic, std::string());
+            mNhNs.param<double>("svo_replay/ack_timeout", mSvoReplayAckTimeout, 1.0);
+
+            if (!mSvoReplayAckTopic.empty()) {
+                NODELET_INFO_STREAM(" * SVO replay ack. topic\t\t-> " << mSvoReplayAckTopic << " (timeout " << mSvoReplayAckTimeout << " sec)");
+            }
+        }
         // <---- SVO
 
+        // ----> Black box
+        mNhNs.param<bool>("blackbox/blackbox_enabled", mBlackBoxEnabled, false);
+
+        if (mBlackBoxEnabled) {
+            NODELET_INFO_STREAM(" * Black box recording\t\t-> ENABLED");
+            mNhNs.param<double>("blackbox/pre_trigger_sec", mBlackBoxPreSec, 10.0);
+            NODELET_INFO_STREAM(" * Pre-trigger time\t\t-> " << mBlackBoxPreSec << " sec");
+            mNhNs.param<double>("blackbox/post_trigger_sec", mBlackBoxPostSec, 5.0);
+            NODELET_INFO_STREAM(" * Post-trigger time\t\t-> " << mBlackBoxPostSec << " sec");
+            mNhNs.param<double>("blackbox/segment_sec", mBlackBoxSegmentSec, 2.0);
+
+            if (mBlackBoxSegmentSec <= 0.0) {
+                NODELET_WARN_STREAM("The parameter `blackbox/segment_sec` must be positive. Using 2.0 sec");
+                mBlackBoxSegmentSec = 2.0;
+            }
+
+            NODELET_INFO_STREAM(" * Buffer segment duration\t-> " << mBlackBoxSegmentSec << " sec");
+            mNhNs.param<int>("blackbox/max_buffer_size_mb", mBlackBoxMaxSizeMb, 1024);
+            NODELET_INFO_STREAM(" * Max buffer size\t\t-> " << mBlackBoxMaxSizeMb << " MB");
+            mNhNs.param<std::string>("blackbox/buffer_dir", mBlackBoxDir, "/dev/shm/zed_blackbox");
+            NODELET_INFO_STREAM(" * Buffer folder\t\t-> " << mBlackBoxDir);
+            mNhNs.param<std::string>("blackbox/dump_dir", mBlackBoxDumpRoot, "zed_blackbox");
+            NODELET_INFO_STREAM(" * Dump folder\t\t\t-> " << mBlackBoxDumpRoot);
+        } else {
+            NODELET_INFO_STREAM(" * Black box recording\t\t-> DISABLED");
+        }
+
+        // <---- Black box
+
+        // ----> Native recorder
+        mNhNs.param<bool>("recorder/recorder_enabled", mRecorderEnabled, false);
+
+        if (mRecorderEnabled) {
+            NODELET_INFO_STREAM(" * Native recorder\t\t-> ENABLED");
+            mNhNs.param<std::string>("recorder/filename", mRecorderFile, "zed_record.zrec");
+            NODELET_INFO_STREAM(" * Recorder file\t\t-> " << mRecorderFile);
+            mNhNs.param<bool>("recorder/record_depth", mRecorderDepth, true);
+            NODELET_INFO_STREAM(" * Record depth\t\t\t-> " << (mRecorderDepth ? "ENABLED" : "DISABLED"));
+            mNhNs.param<bool>("recorder/record_point_cloud", mRecorderPointCloud, false);
+            NODELET_INFO_STREAM(" * Record point cloud\t\t-> " << (mRecorderPointCloud ? "ENABLED" : "DISABLED"));
+            mNhNs.param<bool>("recorder/record_odom", mRecorderOdom, true);
+            NODELET_INFO_STREAM(" * Record odometry\t\t-> " << (mRecorderOdom ? "ENABLED" : "DISABLED"));
+            mNhNs.param<bool>("recorder/record_imu", mRecorderImu, true);
+            NODELET_INFO_STREAM(" * Record IMU\t\t\t-> " << (mRecorderImu ? "ENABLED" : "DISABLED"));
+            mNhNs.param<int>("recorder/chunk_size_kb", mRecorderChunkKb, 4096);
+            NODELET_INFO_STREAM(" * Recorder chunk size\t\t-> " << mRecorderChunkKb << " KB");
+            mNhNs.param<bool>("recorder/compression", mRecorderCompress, true);
+            NODELET_INFO_STREAM(" * Recorder compression\t\t-> " << (mRecorderCompress ? "ENABLED" : "DISABLED"));
+        } else {
+            NODELET_INFO_STREAM(" * Native recorder\t\t-> DISABLED");
+        }
+
+        // <---- Native recorder
+
         // Remote Stream
         mNhNs.param<std::string>("stream", mRemoteStreamAddr, std::string());
 
@@ -686,38 +1089,41 @@ namespace zed_wrapper {
         // <---- TF broadcasting
 
         // ----> Dynamic
-        mNhNs.getParam("mat_resize_factor", mCamMatResizeFactor);
+        std::unique_ptr<DynParams> dynParams(new DynParams);
 
+        mNhNs.getParam("mat_resize_factor", dynParams->matResizeFactor);
 
-        if (mCamMatResizeFactor < 0.1) {
-            mCamMatResizeFactor = 0.1;
+
+        if (dynParams->matResizeFactor < 0.1) {
+            dynParams->matResizeFactor = 0.1;
             NODELET_WARN_STREAM("Minimum allowed values for 'mat_resize_factor' is 0.1");
         }
 
-        if (mCamMatResizeFactor > 1.0) {
-            mCamMatResizeFactor = 1.0;
+        if (dynParams->matResizeFactor > 1.0) {
+            dynParams->matResizeFactor = 1.0;
             NODELET_WARN_STREAM("Maximum allowed values for 'mat_resize_factor' is 1.0");
         }
 
-        NODELET_INFO_STREAM(" * [DYN] mat_resize_factor\t-> " << mCamMatResizeFactor);
-
-        mNhNs.getParam("confidence", mCamConfidence);
-        NODELET_INFO_STREAM(" * [DYN] confidence\t\t-> " << mCamConfidence);
-        mNhNs.getParam("max_depth", mCamMaxDepth);
-        NODELET_INFO_STREAM(" * [DYN] max_depth\t\t-> " << mCamMaxDepth);
-        mNhNs.getParam("exposure", mCamExposure);
-        NODELET_INFO_STREAM(" * [DYN] exposure\t\t-> " << mCamExposure);
-        mNhNs.getParam("gain", mCamGain);
-        NODELET_INFO_STREAM(" * [DYN] gain\t\t\t-> " << mCamGain);
-        mNhNs.getParam("auto_exposure", mCamAutoExposure);
-        NODELET_INFO_STREAM(" * [DYN] auto_exposure\t\t-> " << (mCamAutoExposure ? "ENABLED" : "DISABLED"));
-        mNhNs.getParam("point_cloud_freq", mPointCloudFreq);
-        NODELET_INFO_STREAM(" * [DYN] point_cloud_freq\t-> " << mPointCloudFreq << " Hz");
-
-        if (mCamAutoExposure) {
-            mTriggerAutoExposure = true;
+        NODELET_INFO_STREAM(" * [DYN] mat_resize_factor\t-> " << dynParams->matResizeFactor);
+
+        mNhNs.getParam("confidence", dynParams->confidence);
+        NODELET_INFO_STREAM(" * [DYN] confidence\t\t-> " << dynParams->confidence);
+        mNhNs.getParam("max_depth", dynParams->maxDepth);
+        NODELET_INFO_STREAM(" * [DYN] max_depth\t\t-> " << dynParams->maxDepth);
+        mNhNs.getParam("exposure", dynParams->exposure);
+        NODELET_INFO_STREAM(" * [DYN] exposure\t\t-> " << dynParams->exposure);
+        mNhNs.getParam("gain", dynParams->gain);
+        NODELET_INFO_STREAM(" * [DYN] gain\t\t\t-> " << dynParams->gain);
+        mNhNs.getParam("auto_exposure", dynParams->autoExposure);
+        NODELET_INFO_STREAM(" * [DYN] auto_exposure\t\t-> " << (dynParams->autoExposure ? "ENABLED" : "DISABLED"));
+        mNhNs.getParam("point_cloud_freq", dynParams->pointCloudFreq);
+        NODELET_INFO_STREAM(" * [DYN] point_cloud_freq\t-> " << dynParams->pointCloudFreq << " Hz");
+
+        if (dynParams->autoExposure) {
+            dynParams->autoExposureTrigger++;
         }
 
+        publishDynParams(std::move(dynParams));
         // <---- Dynamic
 
     }
@@ -1144,6 +1550,10 @@ namespace zed_wrapper {
             elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() -
                       start).count();
 
+            if (transformOk) {
+                break;
+            }
+
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
             if (elapsed > 10000) {
@@ -1245,6 +1655,10 @@ namespace zed_wrapper {
 
         // Publish odometry message
         mPubOdom.publish(odom);
+
+        if (mRecorderOdom && mRecorder.isOpen()) {
+            recordMessage(REC_CH_ODOM, odom, t);
+        }
     }
 
     void ZEDWrapperNodelet::publishPose(ros::Time t) {
@@ -1323,7 +1737,7 @@ namespace zed_wrapper {
         }
     }
 
-    void ZEDWrapperNodelet::publishOdomFrame(tf2::Transform odomTransf, ros::Time t) {
+    void ZEDWrapperNodelet::broadcastFrameTf(ros::Time t) {
         if (!mSensor2BaseTransfValid) {
             getSens2BaseTransform();
         }
@@ -1336,17 +1750,12 @@ namespace zed_wrapper {
             getCamera2BaseTransform();
         }
 
-        geometry_msgs::TransformStamped transformStamped;
-        transformStamped.header.stamp = t;
-        transformStamped.header.frame_id = mOdometryFrameId;
-        transformStamped.child_frame_id = mBaseFrameId;
-        // conversion from Tranform to message
-        transformStamped.transform = tf2::toMsg(odomTransf);
-        // Publish transformation
-        mTransformOdomBroadcaster.sendTransform(transformStamped);
+        // A single `tf2_msgs/TFMessage` for all the dynamic transforms of the frame
+        mTfBroadcaster->sendTransform(sl_tools::frameTransforms(mOdom2BaseTransf, mMap2OdomTransf, mPublishMapTf,
+                                      mMapFrameId, mOdometryFrameId, mBaseFrameId, t));
     }
 
-    void ZEDWrapperNodelet::publishPoseFrame(tf2::Transform baseTransform, ros::Time t) {
+    void ZEDWrapperNodelet::publishImuFrame(tf2::Transform imuTransform, ros::Time t) {
         if (!mSensor2BaseTransfValid) {
             getSens2BaseTransform();
         }
@@ -1359,52 +1768,83 @@ namespace zed_wrapper {
             getCamera2BaseTransform();
         }
 
-        geometry_msgs::TransformStamped transformStamped;
-        transformStamped.header.stamp = t;
-        transformStamped.header.frame_id = mMapFrameId;
-        transformStamped.child_frame_id = mOdometryFrameId;
-        // conversion from Tranform to message
-        transformStamped.transform = tf2::toMsg(baseTransform);
-        // Publish transformation
-        mTransformPoseBroadcaster.sendTransform(transformStamped);
+        // Publish transformation from the IMU timer, at the IMU rate
+        mTfBroadcaster->sendTransform(sl_tools::transformToROSmsg(imuTransform, mCameraFrameId, mImuFrameId, t));
     }
 
-    void ZEDWrapperNodelet::publishImuFrame(tf2::Transform imuTransform, ros::Time t) {
-        if (!mSensor2BaseTransfValid) {
-            getSens2BaseTransform();
-        }
-
-        if (!mSensor2CameraTransfValid) {
-            getSens2CameraTransform();
-        }
-
+    void ZEDWrapperNodelet::updateCam2PoseTransform() {
         if (!mCamera2BaseTransfValid) {
-            getCamera2BaseTransform();
+            return;
         }
 
-        geometry_msgs::TransformStamped transformStamped;
-        transformStamped.header.stamp = t;
-        transformStamped.header.frame_id = mCameraFrameId;
-        transformStamped.child_frame_id = mImuFrameId;
-        // conversion from Tranform to message
-        transformStamped.transform = tf2::toMsg(imuTransform);
-        // Publish transformation
-        mTransformImuBroadcaster.sendTransform(transformStamped);
+        tf2::Transform cam2pose = sl_tools::cameraToPoseTransform(mMap2OdomTransf, mOdom2BaseTransf,
+                                  mCamera2BaseTransf, mPublishMapTf);
+
+        std::lock_guard<std::mutex> lock(mCam2PoseMutex);
+        mCam2PoseTransf = cam2pose;
+        mCam2PoseTransfValid = true;
     }
 
     void ZEDWrapperNodelet::publishImage(sl::Mat img,
-                                         image_transport::CameraPublisher& pubImg, sensor_msgs::CameraInfoPtr camInfoMsg,
+                                         image_transport::CameraPublisher& pubImg, const sensor_msgs::CameraInfoConstPtr& camInfoMsg,
                                          string imgFrameId, ros::Time t) {
-        camInfoMsg->header.stamp = t;
-        pubImg.publish(sl_tools::imageToROSmsg(img, imgFrameId, t), camInfoMsg);
+        // The cached message is shared: stamp a copy
+        sensor_msgs::CameraInfoPtr stampedInfoMsg = boost::make_shared<sensor_msgs::CameraInfo>(*camInfoMsg);
+        stampedInfoMsg->header.stamp = t;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        sensor_msgs::ImagePtr imgMsg = sl_tools::imageToROSmsg(img, imgFrameId, t);
+        mImgConvTimeHist_usec.addValue(std::chrono::duration_cast<std::chrono::microseconds>(
+                                           std::chrono::steady_clock::now() - start).count());
+
+        pubImg.publish(imgMsg, stampedInfoMsg);
+        countPublished(pubImg.getTopic(), ros::serialization::serializationLength(*imgMsg));
     }
 
-    void ZEDWrapperNodelet::publishDepth(sl::Mat depth, ros::Time t) {
+    void ZEDWrapperNodelet::publishImageJpeg(sl::Mat img, ros::Publisher& pubImg, string imgFrameId, ros::Time t) {
+        sensor_msgs::CompressedImagePtr imgMsg = boost::make_shared<sensor_msgs::CompressedImage>();
+
+        imgMsg->header.stamp = t;
+        imgMsg->header.frame_id = imgFrameId;
+        imgMsg->format = sl_tools::JPEG_FORMAT;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        sl_tools::CThreadLease lease(mThreadBudget);
+
+        if (!sl_tools::encodeJpegBGRA(img.getPtr<sl::uchar1>(), img.getStepBytes(), img.getWidth(), img.getHeight(),
+                                      mJpegQuality, imgMsg->data, lease.getThreads())) {
+            NODELET_WARN_THROTTLE(5.0, "JPEG compression failed");
+            return;
+        }
+
+        mImgConvTimeHist_usec.addValue(std::chrono::duration_cast<std::chrono::microseconds>(
+                                           std::chrono::steady_clock::now() - start).count());
+
+        pubImg.publish(imgMsg);
+        countPublished(pubImg.getTopic(), ros::serialization::serializationLength(*imgMsg));
+    }
+
+    void ZEDWrapperNodelet::publishDepth(sl::Mat depth, const sensor_msgs::CameraInfoConstPtr& camInfoMsg, ros::Time t) {
+
+        // The cached message is shared: stamp a copy
+        sensor_msgs::CameraInfoPtr depthCamInfoMsg = boost::make_shared<sensor_msgs::CameraInfo>(*camInfoMsg);
+        depthCamInfoMsg->header.stamp = t;
 
-        mDepthCamInfoMsg->header.stamp = t;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 
         if (!mOpenniDepthMode) {
-            mPubDepth.publish(*sl_tools::imageToROSmsg(depth, mDepthOptFrameId, t), *mDepthCamInfoMsg, t);
+            sensor_msgs::ImagePtr depthMessage = sl_tools::imageToROSmsg(depth, mDepthOptFrameId, t);
+            mImgConvTimeHist_usec.addValue(std::chrono::duration_cast<std::chrono::microseconds>(
+                                               std::chrono::steady_clock::now() - start).count());
+
+            mPubDepth.publish(*depthMessage, *depthCamInfoMsg, t);
+            countPublished(mPubDepth.getTopic(), ros::serialization::serializationLength(*depthMessage));
+
+            if (mRecorderDepth && mRecorder.isOpen()) {
+                recordMessage(REC_CH_DEPTH, *depthMessage, t);
+            }
+
             return;
         }
 
@@ -1434,95 +1874,122 @@ namespace zed_wrapper {
             *(data++) = static_cast<uint16_t>(std::round(*(depthDataPtr++) * 1000));    // in mm, rounded
         }
 
-        mPubDepth.publish(depthMessage, mDepthCamInfoMsg);
+        mImgConvTimeHist_usec.addValue(std::chrono::duration_cast<std::chrono::microseconds>(
+                                           std::chrono::steady_clock::now() - start).count());
+
+        mPubDepth.publish(depthMessage, depthCamInfoMsg);
+        countPublished(mPubDepth.getTopic(), ros::serialization::serializationLength(*depthMessage));
+
+        if (mRecorderDepth && mRecorder.isOpen()) {
+            recordMessage(REC_CH_DEPTH, *depthMessage, t);
+        }
     }
 
-    void ZEDWrapperNodelet::publishDisparity(sl::Mat disparity, ros::Time t) {
+    void ZEDWrapperNodelet::publishDepthCompressed(sl::Mat depth, ros::Time t) {
+        sensor_msgs::CompressedImagePtr depthMsg = boost::make_shared<sensor_msgs::CompressedImage>();
+
+        depthMsg->header.stamp = t;
+        depthMsg->header.frame_id = mDepthOptFrameId;
+        depthMsg->format = sl_tools::DEPTH_CODEC_FORMAT;
 
-        sl::CameraInformation zedParam =
-            mZed.getCameraInformation(sl::Resolution(mMatWidth, mMatHeight));
+        sl_tools::CThreadLease lease(mThreadBudget);
+
+        if (!sl_tools::encodeDepth(depth.getPtr<sl::float1>(), depth.getStepBytes(), depth.getWidth(), depth.getHeight(),
+                                   static_cast<float>(mDepthCodecQuantization), mDepthCodecBandRows, depthMsg->data,
+                                   lease.getThreads())) {
+            NODELET_WARN_THROTTLE(5.0, "Depth compression failed");
+            return;
+        }
+
+        mPubDepthCompressed.publish(depthMsg);
+        countPublished(mPubDepthCompressed.getTopic(), ros::serialization::serializationLength(*depthMsg));
+    }
+
+    void ZEDWrapperNodelet::publishDisparity(sl::Mat disparity, const CamInfoSetConstPtr& camInfo, ros::Time t) {
 
         sensor_msgs::ImagePtr disparity_image = sl_tools::imageToROSmsg(disparity, mDisparityFrameId, t);
 
         stereo_msgs::DisparityImage msg;
         msg.image = *disparity_image;
         msg.header = msg.image.header;
-        msg.f = zedParam.calibration_parameters.left_cam.fx;
-        msg.T = zedParam.calibration_parameters.T.x;
+        msg.f = camInfo->fx;
+        msg.T = camInfo->baseline;
 
         if (msg.T > 0) {
             msg.T *= -1.0f;
         }
 
-        msg.min_disparity = msg.f * msg.T / mZed.getDepthMinRangeValue();
-        msg.max_disparity = msg.f * msg.T / mZed.getDepthMaxRangeValue();
+        msg.min_disparity = msg.f * msg.T / mDisparityMinDepth;
+        msg.max_disparity = msg.f * msg.T / mDisparityMaxDepth;
         mPubDisparity.publish(msg);
+        countPublished(mPubDisparity.getTopic(), ros::serialization::serializationLength(msg));
     }
 
-    void ZEDWrapperNodelet::pointcloud_thread_func() {
-        std::unique_lock<std::mutex> lock(mPcMutex);
-
-        while (!mStopNode) {
-            while (!mPcDataReady) {  // loop to avoid spurious wakeups
-                if (mPcDataReadyCondVar.wait_for(lock, std::chrono::milliseconds(500)) == std::cv_status::timeout) {
-                    // Check thread stopping
-                    if (mStopNode) {
-                        return;
-                    } else {
-                        continue;
-                    }
-                }
-            }
-
-            // ----> Check publishing frequency
-            double pc_period_msec = 1000.0 / mPointCloudFreq;
+    void ZEDWrapperNodelet::publishScan(sl::Mat depth, const CamInfoSetConstPtr& camInfo, ros::Time t) {
+        sensor_msgs::LaserScanPtr scanMsg = boost::make_shared<sensor_msgs::LaserScan>();
 
-            static std::chrono::steady_clock::time_point last_time = std::chrono::steady_clock::now();
-            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        scanMsg->header.stamp = t;
+        scanMsg->header.frame_id = mDepthFrameId; // The scan lies on the X-Y plane of the not optical frame
+        scanMsg->time_increment = 0.0f; // All the rays are acquired at the same time
+        scanMsg->scan_time = static_cast<float>(1.0 / mCamFrameRate);
 
-            double elapsed_msec = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_time).count();
+        const boost::array<double, 9>& K = camInfo->left->K;
+        mDepthToScan.convert(depth.getPtr<sl::float1>(), depth.getStepBytes(), depth.getWidth(), depth.getHeight(),
+                             static_cast<float>(K[0]), static_cast<float>(K[2]), static_cast<float>(K[5]), *scanMsg);
 
-            if (elapsed_msec < pc_period_msec) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<long int>(pc_period_msec - elapsed_msec)));
-            }
+        mPubScan.publish(scanMsg);
+        countPublished(mPubScan.getTopic(), ros::serialization::serializationLength(*scanMsg));
+    }
 
-            // <---- Check publishing frequency
+    void ZEDWrapperNodelet::pointcloud_job_func() {
+        std::lock_guard<std::mutex> lock(mPcMutex);
 
-            last_time = std::chrono::steady_clock::now();
+        if (mPcDataReady && !mStopNode && mPcPublishCloud) {
+            sl_tools::CTraceScope trace(mTracer, "publish_point_cloud", mPointCloudFrame);
             publishPointCloud();
+        }
 
+        if (mPcDataReady && !mStopNode && mPcPublishGrid) {
+            sl_tools::CTraceScope trace(mTracer, "publish_obstacle_grid", mPointCloudFrame);
+            publishObstacleGrid();
+        }
 
-            mPcDataReady = false;
+        if (mPcDataReady && !mStopNode && mPcPublishNormals) {
+            sl_tools::CTraceScope trace(mTracer, "publish_normals", mPointCloudFrame);
+            publishNormals();
         }
 
-        NODELET_DEBUG("Pointcloud thread finished");
+        mPcDataReady = false;
+        mPcDataReadyCondVar.notify_all();
     }
 
     void ZEDWrapperNodelet::publishPointCloud() {
         // Publish freq calculation
-        static std::chrono::steady_clock::time_point last_time = std::chrono::steady_clock::now();
         std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
 
-        double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - last_time).count();
-        last_time = now;
+        double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - mPcLastPubTime).count();
+        mPcLastPubTime = now;
 
-        mPcPeriodMean_usec->addValue(elapsed_usec);
+        mPcPeriodHist_usec.addValue(static_cast<int64_t>(elapsed_usec));
 
         // Initialize Point Cloud message
         // https://github.com/ros/common_msgs/blob/jade-devel/sensor_msgs/include/sensor_msgs/point_cloud2_iterator.h
 
-        int ptsCount = mMatWidth * mMatHeight;
+        // Size of the retrieved cloud: the output size can be changed meanwhile
+        int width = static_cast<int>(mCloud.getWidth());
+        int height = static_cast<int>(mCloud.getHeight());
+        int ptsCount = width * height;
 
         mPointcloudMsg->header.stamp = mPointCloudTime;
 
-        if (mPointcloudMsg->width != mMatWidth || mPointcloudMsg->height != mMatHeight) {
+        if (mPointcloudMsg->width != width || mPointcloudMsg->height != height) {
             mPointcloudMsg->header.frame_id = mPointCloudFrameId; // Set the header values of the ROS message
 
             mPointcloudMsg->is_bigendian = false;
             mPointcloudMsg->is_dense = false;
 
-            mPointcloudMsg->width = mMatWidth;
-            mPointcloudMsg->height = mMatHeight;
+            mPointcloudMsg->width = width;
+            mPointcloudMsg->height = height;
 
             sensor_msgs::PointCloud2Modifier modifier(*mPointcloudMsg);
             modifier.setPointCloud2Fields(4,
@@ -1542,16 +2009,135 @@ namespace zed_wrapper {
 #else
 
         for (size_t i = 0; i < ptsCount; ++i) {
-            ptCloudPtr[i * 4 + 0] = mSignX * cpu_cloud[i][mIdxX];
-            ptCloudPtr[i * 4 + 1] = mSignY * cpu_cloud[i][mIdxY];
-            ptCloudPtr[i * 4 + 2] = mSignZ * cpu_cloud[i][mIdxZ];
+            ptCloudPtr[i * 4 + 0] = CoordRemap::x(cpu_cloud[i]);
+            ptCloudPtr[i * 4 + 1] = CoordRemap::y(cpu_cloud[i]);
+            ptCloudPtr[i * 4 + 2] = CoordRemap::z(cpu_cloud[i]);
             ptCloudPtr[i * 4 + 3] = cpu_cloud[i][3];
         }
 
 #endif
 
+        mPcConvTimeHist_usec.addValue(std::chrono::duration_cast<std::chrono::microseconds>(
+                                          std::chrono::steady_clock::now() - now).count());
+
         // Pointcloud publishing
         mPubCloud.publish(mPointcloudMsg);
+        countPublished(mPubCloud.getTopic(), ros::serialization::serializationLength(*mPointcloudMsg));
+
+        if (mRecorderPointCloud && mRecorder.isOpen()) {
+            recordMessage(REC_CH_POINT_CLOUD, *mPointcloudMsg, mPointCloudTime);
+        }
+    }
+
+    void ZEDWrapperNodelet::publishObstacleGrid() {
+        nav_msgs::OccupancyGridPtr gridMsg = boost::make_shared<nav_msgs::OccupancyGrid>();
+
+        gridMsg->header.stamp = mPointCloudTime;
+        gridMsg->header.frame_id = mBaseFrameId;
+        gridMsg->info.map_load_time = mPointCloudTime;
+
+        // Point cloud to base transform, including the change from the SDK
+        // coordinate system (row major 3x4 matrix)
+        float transf[12];
+        const tf2::Matrix3x3& basis = mPointCloudBaseTransf.getBasis();
+        const tf2::Vector3& origin = mPointCloudBaseTransf.getOrigin();
+
+        for (int j = 0; j < 3; j++) {
+            float axis[3] = {0.0f, 0.0f, 0.0f};
+            axis[j] = 1.0f;
+            tf2::Vector3 col = basis * tf2::Vector3(CoordRemap::x(axis), CoordRemap::y(axis), CoordRemap::z(axis));
+
+            for (int i = 0; i < 3; i++) {
+                transf[i * 4 + j] = static_cast<float>(col[i]);
+            }
+        }
+
+        for (int i = 0; i < 3; i++) {
+            transf[i * 4 + 3] = static_cast<float>(origin[i]);
+        }
+
+        sl_tools::CThreadLease lease(mThreadBudget);
+
+        mObstacleGrid.update(reinterpret_cast<const float*>(mCloud.getPtr<sl::float4>()), mCloud.getStepBytes(),
+                             static_cast<int>(mCloud.getWidth()), static_cast<int>(mCloud.getHeight()), transf, *gridMsg,
+                             lease.getThreads());
+
+        mPubObstacleGrid.publish(gridMsg);
+        countPublished(mPubObstacleGrid.getTopic(), ros::serialization::serializationLength(*gridMsg));
+    }
+
+    void ZEDWrapperNodelet::publishNormals() {
+        sensor_msgs::ImagePtr normalsMsg = boost::make_shared<sensor_msgs::Image>();
+
+        // The normals are expressed in the frame of the point cloud
+        normalsMsg->header.stamp = mPointCloudTime;
+        normalsMsg->header.frame_id = mPointCloudFrameId;
+        normalsMsg->width = static_cast<uint32_t>(mCloud.getWidth());
+        normalsMsg->height = static_cast<uint32_t>(mCloud.getHeight());
+        normalsMsg->encoding = sensor_msgs::image_encodings::TYPE_32FC3;
+        normalsMsg->is_bigendian = false;
+        normalsMsg->step = normalsMsg->width * 3 * sizeof(float);
+        normalsMsg->data.resize(normalsMsg->step * normalsMsg->height);
+
+        sl_tools::CThreadLease lease(mThreadBudget);
+
+        mNormalEstimator.compute(reinterpret_cast<const float*>(mCloud.getPtr<sl::float4>()), mCloud.getStepBytes(),
+                                 static_cast<int>(normalsMsg->width), static_cast<int>(normalsMsg->height),
+                                 reinterpret_cast<float*>(normalsMsg->data.data()), lease.getThreads());
+
+        mPubNormals.publish(normalsMsg);
+        countPublished(mPubNormals.getTopic(), ros::serialization::serializationLength(*normalsMsg));
+    }
+
+    void ZEDWrapperNodelet::fuseElevationMap(sl::Mat depth, const CamInfoSetConstPtr& camInfo, ros::Time t) {
+        // Depth camera to odometry transform (row major 3x4 matrix)
+        tf2::Transform odom2Sensor = mOdom2BaseTransf * mSensor2BaseTransf.inverse();
+        const tf2::Matrix3x3& basis = odom2Sensor.getBasis();
+        const tf2::Vector3& origin = odom2Sensor.getOrigin();
+        const tf2::Vector3& robot = mOdom2BaseTransf.getOrigin();
+
+        float transf[12];
+
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                transf[i * 4 + j] = static_cast<float>(basis[i][j]);
+            }
+
+            transf[i * 4 + 3] = static_cast<float>(origin[i]);
+        }
+
+        const boost::array<double, 9>& K = camInfo->left->K;
+
+        std::lock_guard<std::mutex> lock(mElevationMutex);
+
+        mElevationMap.fuse(depth.getPtr<sl::float1>(), depth.getStepBytes(), depth.getWidth(), depth.getHeight(),
+                           static_cast<float>(K[0]), static_cast<float>(K[4]), static_cast<float>(K[2]), static_cast<float>(K[5]),
+                           transf, static_cast<float>(robot.x()), static_cast<float>(robot.y()), static_cast<float>(robot.z()));
+        mElevationMapTime = t;
+    }
+
+    void ZEDWrapperNodelet::pubElevationMapCallback(const ros::TimerEvent& e) {
+        if (mPubElevationMap.getNumSubscribers() == 0) {
+            return;
+        }
+
+        sensor_msgs::PointCloud2Ptr elevationMsg = boost::make_shared<sensor_msgs::PointCloud2>();
+
+        {
+            std::lock_guard<std::mutex> lock(mElevationMutex);
+
+            if (mElevationMapTime.isZero()) {
+                return; // Nothing fused yet
+            }
+
+            mElevationMap.fillCloud(*elevationMsg);
+            elevationMsg->header.stamp = mElevationMapTime;
+        }
+
+        elevationMsg->header.frame_id = mOdometryFrameId;
+
+        mPubElevationMap.publish(elevationMsg);
+        countPublished(mPubElevationMap.getTopic(), ros::serialization::serializationLength(*elevationMsg));
     }
 
     void ZEDWrapperNodelet::pubFusedPointCloudCallback(const ros::TimerEvent& e) {
@@ -1649,6 +2235,7 @@ namespace zed_wrapper {
 
         // Pointcloud publishing
         mPubFusedCloud.publish(mPointcloudFusedMsg);
+        countPublished(mPubFusedCloud.getTopic(), ros::serialization::serializationLength(*mPointcloudFusedMsg));
 #endif
     }
 
@@ -1663,14 +2250,14 @@ namespace zed_wrapper {
 
     void ZEDWrapperNodelet::fillCamInfo(sl::Camera& zed, sensor_msgs::CameraInfoPtr leftCamInfoMsg,
                                         sensor_msgs::CameraInfoPtr rightCamInfoMsg, string leftFrameId,
-                                        string rightFrameId, bool rawParam /*= false*/) {
+                                        string rightFrameId, int width, int height, bool rawParam /*= false*/) {
         sl::CalibrationParameters zedParam;
 
         if (rawParam) {
-            zedParam = zed.getCameraInformation(sl::Resolution(mMatWidth, mMatHeight))
+            zedParam = zed.getCameraInformation(sl::Resolution(width, height))
                        .calibration_parameters_raw;
         } else {
-            zedParam = zed.getCameraInformation(sl::Resolution(mMatWidth, mMatHeight))
+            zedParam = zed.getCameraInformation(sl::Resolution(width, height))
                        .calibration_parameters;
         }
 
@@ -1706,171 +2293,570 @@ namespace zed_wrapper {
         leftCamInfoMsg->R.fill(0.0);
         rightCamInfoMsg->R.fill(0.0);
 
-        for (size_t i = 0; i < 3; i++) {
-            // identity
-            rightCamInfoMsg->R[i + i * 3] = 1;
-            leftCamInfoMsg->R[i + i * 3] = 1;
-        }
+        for (size_t i = 0; i < 3; i++) {
+            // identity
+            rightCamInfoMsg->R[i + i * 3] = 1;
+            leftCamInfoMsg->R[i + i * 3] = 1;
+        }
+
+        if (rawParam) {
+            std::vector<float> R_ = sl_tools::convertRodrigues(zedParam.R);
+            float* p = R_.data();
+
+            for (int i = 0; i < 9; i++) {
+                rightCamInfoMsg->R[i] = p[i];
+            }
+        }
+
+        leftCamInfoMsg->P.fill(0.0);
+        rightCamInfoMsg->P.fill(0.0);
+        leftCamInfoMsg->P[0] = static_cast<double>(zedParam.left_cam.fx);
+        leftCamInfoMsg->P[2] = static_cast<double>(zedParam.left_cam.cx);
+        leftCamInfoMsg->P[5] = static_cast<double>(zedParam.left_cam.fy);
+        leftCamInfoMsg->P[6] = static_cast<double>(zedParam.left_cam.cy);
+        leftCamInfoMsg->P[10] = 1.0;
+        // http://docs.ros.org/api/sensor_msgs/html/msg/CameraInfo.html
+        rightCamInfoMsg->P[3] = static_cast<double>(-1 * zedParam.left_cam.fx * baseline);
+        rightCamInfoMsg->P[0] = static_cast<double>(zedParam.right_cam.fx);
+        rightCamInfoMsg->P[2] = static_cast<double>(zedParam.right_cam.cx);
+        rightCamInfoMsg->P[5] = static_cast<double>(zedParam.right_cam.fy);
+        rightCamInfoMsg->P[6] = static_cast<double>(zedParam.right_cam.cy);
+        rightCamInfoMsg->P[10] = 1.0;
+        leftCamInfoMsg->width = rightCamInfoMsg->width = static_cast<uint32_t>(width);
+        leftCamInfoMsg->height = rightCamInfoMsg->height = static_cast<uint32_t>(height);
+        leftCamInfoMsg->header.frame_id = leftFrameId;
+        rightCamInfoMsg->header.frame_id = rightFrameId;
+    }
+
+    CamInfoSetConstPtr ZEDWrapperNodelet::getCamInfoSet(int width, int height) {
+        std::lock_guard<std::mutex> lock(mCamInfoCacheMutex);
+
+        std::pair<int, int> size(width, height);
+
+        auto it = mCamInfoCache.find(size);
+
+        if (it != mCamInfoCache.end()) {
+            return it->second;
+        }
+
+        sensor_msgs::CameraInfoPtr left = boost::make_shared<sensor_msgs::CameraInfo>();
+        sensor_msgs::CameraInfoPtr right = boost::make_shared<sensor_msgs::CameraInfo>();
+        sensor_msgs::CameraInfoPtr leftRaw = boost::make_shared<sensor_msgs::CameraInfo>();
+        sensor_msgs::CameraInfoPtr rightRaw = boost::make_shared<sensor_msgs::CameraInfo>();
+
+        fillCamInfo(mZed, left, right, mLeftCamOptFrameId, mRightCamOptFrameId, width, height);
+        fillCamInfo(mZed, leftRaw, rightRaw, mLeftCamOptFrameId, mRightCamOptFrameId, width, height, true);
+
+        std::shared_ptr<CamInfoSet> camInfo = std::make_shared<CamInfoSet>();
+        camInfo->width = width;
+        camInfo->height = height;
+        camInfo->left = left;
+        camInfo->right = right;
+        camInfo->leftRaw = leftRaw;
+        camInfo->rightRaw = rightRaw;
+        camInfo->fx = static_cast<float>(left->P[0]);
+        camInfo->baseline = static_cast<float>(-right->P[3] / left->P[0]); // P[3] = -fx * baseline
+
+        // The resize factor is continuous: do not grow without limits
+        if (mCamInfoCache.size() >= 16) {
+            mCamInfoCache.clear();
+        }
+
+        mCamInfoCache[size] = camInfo;
+
+        return camInfo;
+    }
+
+    void ZEDWrapperNodelet::dynamicReconfCallback(zed_wrapper::ZedConfig& config,
+            uint32_t level) {
+        // The parameters read by the grab loop are never modified: publish a modified copy
+        std::unique_ptr<DynParams> params(new DynParams(*mDynParams.load(std::memory_order_acquire)));
+
+        switch (level) {
+        case 0:
+            params->matResizeFactor = config.mat_resize_factor;
+            NODELET_INFO("Reconfigure mat_resize_factor: %g", params->matResizeFactor);
+            {
+                int width = static_cast<int>(mCamWidth * params->matResizeFactor);
+                int height = static_cast<int>(mCamHeight * params->matResizeFactor);
+                NODELET_DEBUG_STREAM("Data Mat size : " << width << "x" << height);
+
+                // The grab loop uses the new size and camera info from the next frame
+                std::atomic_store(&mCamInfo, getCamInfoSet(width, height));
+            }
+            break;
+
+        case 1:
+            params->confidence = config.confidence;
+            NODELET_INFO("Reconfigure confidence : %d", params->confidence);
+            break;
+
+        case 2:
+            params->maxDepth = config.max_depth;
+            NODELET_INFO("Reconfigure max depth : %g", params->maxDepth);
+            break;
+
+        case 3:
+            params->pointCloudFreq = config.point_cloud_freq;
+            NODELET_INFO("Reconfigure point cloud frequency : %g", params->pointCloudFreq);
+            break;
+
+        case 4:
+            params->autoExposure = config.auto_exposure;
+
+            if (params->autoExposure) {
+                params->autoExposureTrigger++;
+            }
+
+            NODELET_INFO("Reconfigure auto control of exposure and gain : %s",
+                         params->autoExposure ? "Enable" : "Disable");
+            break;
+
+        case 5:
+            params->gain = config.gain;
+            NODELET_INFO("Reconfigure gain : %d", params->gain);
+            break;
+
+        case 6:
+            params->exposure = config.exposure;
+            NODELET_INFO("Reconfigure exposure : %d", params->exposure);
+            break;
+        }
+
+        publishDynParams(std::move(params));
+    }
+
+    void ZEDWrapperNodelet::publishDynParams(std::unique_ptr<DynParams> params) {
+        mDynParamsSnapshots.emplace_back(std::move(params));
+        const DynParams* current = mDynParamsSnapshots.back().get();
+        mDynParams.store(current, std::memory_order_seq_cst);
+
+        // The retired snapshots are released unless the grab thread is using one. The
+        // grab thread checks the current snapshot again after filling the hazard slot,
+        // so it never keeps a snapshot that was already retired when it is read here
+        const DynParams* inUse = mDynParamsInUse.load(std::memory_order_seq_cst);
+
+        mDynParamsSnapshots.erase(std::remove_if(mDynParamsSnapshots.begin(), mDynParamsSnapshots.end(),
+        [current, inUse](const std::unique_ptr<const DynParams>& snapshot) {
+            return snapshot.get() != current && snapshot.get() != inUse;
+        }), mDynParamsSnapshots.end());
+    }
+
+    const DynParams* ZEDWrapperNodelet::acquireDynParams() {
+        const DynParams* params = mDynParams.load(std::memory_order_seq_cst);
+
+        while (true) {
+            mDynParamsInUse.store(params, std::memory_order_seq_cst);
+
+            // Still current after publishing the hazard: the reconfigure thread sees it
+            const DynParams* current = mDynParams.load(std::memory_order_seq_cst);
+
+            if (current == params) {
+                return params;
+            }
+
+            params = current;
+        }
+    }
+
+    void ZEDWrapperNodelet::pathPubCallback(const ros::TimerEvent& e) {
+        uint32_t mapPathSub = mPubMapPath.getNumSubscribers();
+        uint32_t odomPathSub = mPubOdomPath.getNumSubscribers();
+
+        geometry_msgs::PoseStamped odomPose;
+        geometry_msgs::PoseStamped mapPose;
+
+        odomPose.header.stamp = mFrameTimestamp;
+        odomPose.header.frame_id = mWorldFrameId; // frame
+        // conversion from Tranform to message
+        geometry_msgs::Transform base2odom = tf2::toMsg(mOdom2BaseTransf);
+        // Add all value in Pose message
+        odomPose.pose.position.x = base2odom.translation.x;
+        odomPose.pose.position.y = base2odom.translation.y;
+        odomPose.pose.position.z = base2odom.translation.z;
+        odomPose.pose.orientation.x = base2odom.rotation.x;
+        odomPose.pose.orientation.y = base2odom.rotation.y;
+        odomPose.pose.orientation.z = base2odom.rotation.z;
+        odomPose.pose.orientation.w = base2odom.rotation.w;
+
+        mapPose.header.stamp = mFrameTimestamp;
+        mapPose.header.frame_id = mWorldFrameId; // frame
+        // conversion from Tranform to message
+        geometry_msgs::Transform base2map = tf2::toMsg(mMap2BaseTransf);
+        // Add all value in Pose message
+        mapPose.pose.position.x = base2map.translation.x;
+        mapPose.pose.position.y = base2map.translation.y;
+        mapPose.pose.position.z = base2map.translation.z;
+        mapPose.pose.orientation.x = base2map.rotation.x;
+        mapPose.pose.orientation.y = base2map.rotation.y;
+        mapPose.pose.orientation.z = base2map.rotation.z;
+        mapPose.pose.orientation.w = base2map.rotation.w;
+
+        // Decimation: store a new pose only if the camera moved enough
+        if (!mOdomPath.empty() &&
+            !isPathPoseNew(mOdomPath.back().pose, odomPose.pose) &&
+            !isPathPoseNew(mMapPath.back().pose, mapPose.pose)) {
+            return;
+        }
+
+        // Circular buffers
+        mMapPath.push(mapPose);
+        mOdomPath.push(odomPose);
+
+        if (mPublishPathAppend) {
+            if (mPubMapPathAppend.getNumSubscribers() > 0) {
+                mPubMapPathAppend.publish(mapPose);
+            }
+
+            if (mPubOdomPathAppend.getNumSubscribers() > 0) {
+                mPubOdomPathAppend.publish(odomPose);
+            }
+        }
+
+        if (mapPathSub > 0) {
+            nav_msgs::PathPtr mapPath = boost::make_shared<nav_msgs::Path>();
+            mapPath->header.frame_id = mWorldFrameId;
+            mapPath->header.stamp = mFrameTimestamp;
+            mMapPath.copyTo(mapPath->poses);
+
+            mPubMapPath.publish(mapPath);
+        }
+
+        if (odomPathSub > 0) {
+            nav_msgs::PathPtr odomPath = boost::make_shared<nav_msgs::Path>();
+            odomPath->header.frame_id = mWorldFrameId;
+            odomPath->header.stamp = mFrameTimestamp;
+            mOdomPath.copyTo(odomPath->poses);
+
+            mPubOdomPath.publish(odomPath);
+        }
+    }
+
+    bool ZEDWrapperNodelet::isPathPoseNew(const geometry_msgs::Pose& last, const geometry_msgs::Pose& pose) {
+        if (mPathMinDist <= 0.0 && mPathMinAngle <= 0.0) {
+            return true;
+        }
+
+        double dx = pose.position.x - last.position.x;
+        double dy = pose.position.y - last.position.y;
+        double dz = pose.position.z - last.position.z;
+
+        if (mPathMinDist > 0.0 && (dx * dx + dy * dy + dz * dz) >= (mPathMinDist * mPathMinDist)) {
+            return true;
+        }
+
+        if (mPathMinAngle > 0.0) {
+            tf2::Quaternion q1, q2;
+            tf2::fromMsg(last.orientation, q1);
+            tf2::fromMsg(pose.orientation, q2);
+
+            if (q1.angleShortestPath(q2) >= mPathMinAngle) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void ZEDWrapperNodelet::recordSvoFrame(ros::Time stamp) {
+        std::lock_guard<std::mutex> lock(mRecMutex);
+
+        if (!mRecording) {
+            return;
+        }
+
+        // ----> Requests of the segment thread
+        if (mSvoStopRequested) {
+            NODELET_ERROR_STREAM("SVO recording STOPPED: free disk space in " << mSvoDir << " is lower than "
+                                 << mSvoMinFreeMb << " MB");
+            stopSvoRecording();
+            mSvoDiskFull = true;
+            mDiagUpdater.force_update();
+            return;
+        }
+
+        if (mSvoSwitchRequested) {
+            switchSvoSegment(stamp);
+
+            // Recording is stopped if the new segment cannot be opened
+            if (!mRecording) {
+                return;
+            }
+        }
+
+        // <---- Requests of the segment thread
+
+        if (mSvoCurrent.start.isZero()) {
+            mSvoCurrent.start = stamp;
+        }
+
+        bool prevStatus = mRecState.status;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        {
+            sl_tools::CTraceScope trace(mTracer, "svo_record", mFrameCount);
+            mRecState = mZed.record();
+        }
+
+        mSvoRecordHist_usec.addValue(std::chrono::duration_cast<std::chrono::microseconds>(
+                                         std::chrono::steady_clock::now() - start).count());
+
+        if (!mRecState.status) {
+            ROS_ERROR_THROTTLE(1.0, "Error saving frame to SVO");
+            mSvoFailedCount++;
+        } else {
+            mSvoCurrent.end = stamp;
+        }
+
+        if (prevStatus != mRecState.status) {
+            mDiagUpdater.force_update();
+        }
+
+        // The segment thread checks if a new segment must be started
+        mSvoFrameRecorded = true;
+        mSvoSegmentCondVar.notify_all();
+    }
+
+    void ZEDWrapperNodelet::switchSvoSegment(ros::Time stamp) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        sl::ERROR_CODE err;
+
+        {
+            sl_tools::CTraceScope trace(mTracer, "svo_switch", mFrameCount);
+
+            closeSvoSegment();
 
-        if (rawParam) {
-            std::vector<float> R_ = sl_tools::convertRodrigues(zedParam.R);
-            float* p = R_.data();
+            // The new segment starts with the frame that is going to be recorded: no frame is lost
+            mSvoCurrent = SvoSegment();
 
-            for (int i = 0; i < 9; i++) {
-                rightCamInfoMsg->R[i] = p[i];
+            if (mBlackBoxEnabled) {
+                mSvoCurrent.filename = mBlackBoxDir + "/segment_" + std::to_string(mBlackBoxSegIdx++) + ".svo";
+            } else {
+                mSvoCurrent.filename = getSvoSegmentName(mSvoSegIdx++);
             }
+
+            mSvoCurrent.start = stamp;
+            mSvoCurrent.end = stamp;
+
+            err = enableSvoRecording(mSvoCurrent.filename);
         }
 
-        leftCamInfoMsg->P.fill(0.0);
-        rightCamInfoMsg->P.fill(0.0);
-        leftCamInfoMsg->P[0] = static_cast<double>(zedParam.left_cam.fx);
-        leftCamInfoMsg->P[2] = static_cast<double>(zedParam.left_cam.cx);
-        leftCamInfoMsg->P[5] = static_cast<double>(zedParam.left_cam.fy);
-        leftCamInfoMsg->P[6] = static_cast<double>(zedParam.left_cam.cy);
-        leftCamInfoMsg->P[10] = 1.0;
-        // http://docs.ros.org/api/sensor_msgs/html/msg/CameraInfo.html
-        rightCamInfoMsg->P[3] = static_cast<double>(-1 * zedParam.left_cam.fx * baseline);
-        rightCamInfoMsg->P[0] = static_cast<double>(zedParam.right_cam.fx);
-        rightCamInfoMsg->P[2] = static_cast<double>(zedParam.right_cam.cx);
-        rightCamInfoMsg->P[5] = static_cast<double>(zedParam.right_cam.fy);
-        rightCamInfoMsg->P[6] = static_cast<double>(zedParam.right_cam.cy);
-        rightCamInfoMsg->P[10] = 1.0;
-        leftCamInfoMsg->width = rightCamInfoMsg->width = static_cast<uint32_t>(mMatWidth);
-        leftCamInfoMsg->height = rightCamInfoMsg->height = static_cast<uint32_t>(mMatHeight);
-        leftCamInfoMsg->header.frame_id = leftFrameId;
-        rightCamInfoMsg->header.frame_id = rightFrameId;
+        mSvoSwitchHist_usec.addValue(std::chrono::duration_cast<std::chrono::microseconds>(
+                                         std::chrono::steady_clock::now() - start).count());
+
+        mSvoSwitchRequested = false;
+
+        if (err != sl::SUCCESS) {
+            NODELET_ERROR_STREAM("SVO recording STOPPED: cannot open " << mSvoCurrent.filename << ": " << sl::toString(err).c_str());
+            mRecording = false;
+            mDiagUpdater.force_update();
+        }
     }
 
-    void ZEDWrapperNodelet::dynamicReconfCallback(zed_wrapper::ZedConfig& config,
-            uint32_t level) {
-        switch (level) {
-        case 0:
-            mCamMatResizeFactor = config.mat_resize_factor;
-            NODELET_INFO("Reconfigure mat_resize_factor: %g", mCamMatResizeFactor);
-            mCamDataMutex.lock();
-            mMatWidth = static_cast<size_t>(mCamWidth * mCamMatResizeFactor);
-            mMatHeight = static_cast<size_t>(mCamHeight * mCamMatResizeFactor);
-            NODELET_DEBUG_STREAM("Data Mat size : " << mMatWidth << "x" << mMatHeight);
-
-            // Update Camera Info
-            fillCamInfo(mZed, mLeftCamInfoMsg, mRightCamInfoMsg, mLeftCamOptFrameId,
-                        mRightCamOptFrameId);
-            fillCamInfo(mZed, mLeftCamInfoRawMsg, mRightCamInfoRawMsg, mLeftCamOptFrameId,
-                        mRightCamOptFrameId, true);
-            mRgbCamInfoMsg = mDepthCamInfoMsg = mLeftCamInfoMsg; // the reference camera is
-            // the Left one (next to
-            // the ZED logo)
-            mRgbCamInfoRawMsg = mLeftCamInfoRawMsg;
-            mCamDataMutex.unlock();
-            break;
+    void ZEDWrapperNodelet::svo_segment_thread_func() {
+        std::unique_lock<std::mutex> lock(mRecMutex);
 
-        case 1:
-            mCamConfidence = config.confidence;
-            NODELET_INFO("Reconfigure confidence : %d", mCamConfidence);
-            break;
+        while (true) {
+            // Timeout used to check thread stopping
+            mSvoSegmentCondVar.wait_for(lock, std::chrono::milliseconds(500), [this] {
+                return mSvoFrameRecorded || !mSvoClosedSegments.empty() || mStopNode;
+            });
 
-        case 2:
-            mCamMaxDepth = config.max_depth;
-            NODELET_INFO("Reconfigure max depth : %g", mCamMaxDepth);
-            break;
+            // ----> Closed segments
+            while (!mSvoClosedSegments.empty()) {
+                SvoSegment seg = mSvoClosedSegments.front();
+                mSvoClosedSegments.pop_front();
 
-        case 3:
-            mPointCloudFreq = config.point_cloud_freq;
-            NODELET_INFO("Reconfigure point cloud frequency : %g", mPointCloudFreq);
-            break;
+                // File system calls are made without blocking the grab thread
+                lock.unlock();
+                seg.size = sl_tools::file_size(seg.filename);
 
-        case 4:
-            mCamAutoExposure = config.auto_exposure;
+                if (!seg.index.empty()) {
+                    std::ofstream index(seg.index.c_str(), std::ios::app);
+                    index << seg.filename << " " << seg.start << " " << seg.end << " " << seg.size << std::endl;
+                }
+
+                lock.lock();
 
-            if (mCamAutoExposure) {
-                mTriggerAutoExposure = true;
+                if (mBlackBoxEnabled) {
+                    addBlackBoxSegment(seg, lock);
+                }
             }
 
-            NODELET_INFO("Reconfigure auto control of exposure and gain : %s",
-                         mCamAutoExposure ? "Enable" : "Disable");
-            break;
+            // <---- Closed segments
 
-        case 5:
-            mCamGain = config.gain;
-            NODELET_INFO("Reconfigure gain : %d", mCamGain);
-            break;
+            if (mStopNode) {
+                break;
+            }
 
-        case 6:
-            mCamExposure = config.exposure;
-            NODELET_INFO("Reconfigure exposure : %d", mCamExposure);
-            break;
+            if (!mSvoFrameRecorded) {
+                continue;
+            }
+
+            mSvoFrameRecorded = false;
+
+            if (!mRecording || mSvoSwitchRequested || mSvoStopRequested) {
+                continue;
+            }
+
+            if (mBlackBoxEnabled) {
+                mSvoSwitchRequested = (mSvoCurrent.end - mSvoCurrent.start).toSec() >= mBlackBoxSegmentSec;
+            } else {
+                checkSvoSegment(lock);
+            }
         }
+
+        NODELET_DEBUG("SVO segment thread finished");
     }
 
-    void ZEDWrapperNodelet::pathPubCallback(const ros::TimerEvent& e) {
-        uint32_t mapPathSub = mPubMapPath.getNumSubscribers();
-        uint32_t odomPathSub = mPubOdomPath.getNumSubscribers();
+    void ZEDWrapperNodelet::checkSvoSegment(std::unique_lock<std::mutex>& lock) {
+        // ----> Disk space check
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
 
-        geometry_msgs::PoseStamped odomPose;
-        geometry_msgs::PoseStamped mapPose;
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - mSvoLastDiskCheck).count() > 1000) {
+            mSvoLastDiskCheck = now;
+            std::string dir = mSvoDir;
 
-        odomPose.header.stamp = mFrameTimestamp;
-        odomPose.header.frame_id = mWorldFrameId; // frame
-        // conversion from Tranform to message
-        geometry_msgs::Transform base2odom = tf2::toMsg(mOdom2BaseTransf);
-        // Add all value in Pose message
-        odomPose.pose.position.x = base2odom.translation.x;
-        odomPose.pose.position.y = base2odom.translation.y;
-        odomPose.pose.position.z = base2odom.translation.z;
-        odomPose.pose.orientation.x = base2odom.rotation.x;
-        odomPose.pose.orientation.y = base2odom.rotation.y;
-        odomPose.pose.orientation.z = base2odom.rotation.z;
-        odomPose.pose.orientation.w = base2odom.rotation.w;
+            lock.unlock();
+            uint64_t freeSpace = sl_tools::free_disk_space(dir);
+            lock.lock();
 
-        mapPose.header.stamp = mFrameTimestamp;
-        mapPose.header.frame_id = mWorldFrameId; // frame
-        // conversion from Tranform to message
-        geometry_msgs::Transform base2map = tf2::toMsg(mMap2BaseTransf);
-        // Add all value in Pose message
-        mapPose.pose.position.x = base2map.translation.x;
-        mapPose.pose.position.y = base2map.translation.y;
-        mapPose.pose.position.z = base2map.translation.z;
-        mapPose.pose.orientation.x = base2map.rotation.x;
-        mapPose.pose.orientation.y = base2map.rotation.y;
-        mapPose.pose.orientation.z = base2map.rotation.z;
-        mapPose.pose.orientation.w = base2map.rotation.w;
+            // Recording can be stopped or restarted in the meantime
+            if (!mRecording || dir != mSvoDir) {
+                return;
+            }
+
+            if (freeSpace < static_cast<uint64_t>(mSvoMinFreeMb) * 1048576) {
+                mSvoStopRequested = true;
+                return;
+            }
+        }
 
-        // Circular vector
-        if (mPathMaxCount != -1) {
-            if (mOdomPath.size() == mPathMaxCount) {
-                NODELET_DEBUG("Path vectors full: rotating ");
-                std::rotate(mOdomPath.begin(), mOdomPath.begin() + 1, mOdomPath.end());
-                std::rotate(mMapPath.begin(), mMapPath.begin() + 1, mMapPath.end());
+        // <---- Disk space check
 
-                mMapPath[mPathMaxCount - 1] = mapPose;
-                mOdomPath[mPathMaxCount - 1] = odomPose;
-            } else {
-                //NODELET_DEBUG_STREAM("Path vectors adding last available poses");
-                mMapPath.push_back(mapPose);
-                mOdomPath.push_back(odomPose);
+        if (!mSvoSegmented) {
+            return;
+        }
+
+        // ----> Segment rotation, executed by the grab thread before recording the next frame
+        bool rotate = mSvoSegmentMaxSec > 0.0 && (mSvoCurrent.end - mSvoCurrent.start).toSec() >= mSvoSegmentMaxSec;
+
+        if (!rotate && mSvoSegmentMaxMb > 0) {
+            std::string filename = mSvoCurrent.filename;
+
+            lock.unlock();
+            uint64_t size = sl_tools::file_size(filename);
+            lock.lock();
+
+            rotate = mRecording && filename == mSvoCurrent.filename &&
+                     size >= static_cast<uint64_t>(mSvoSegmentMaxMb) * 1048576;
+        }
+
+        mSvoSwitchRequested = rotate;
+        // <---- Segment rotation
+    }
+
+    void ZEDWrapperNodelet::replayAckCallback(const std_msgs::Header::ConstPtr& msg) {
+        {
+            std::lock_guard<std::mutex> lock(mReplayAckMutex);
+
+            if (msg->stamp > mReplayAckStamp) {
+                mReplayAckStamp = msg->stamp;
             }
-        } else {
-            //NODELET_DEBUG_STREAM("No limit path vectors, adding last available poses");
-            mMapPath.push_back(mapPose);
-            mOdomPath.push_back(odomPose);
         }
 
-        if (mapPathSub > 0) {
-            nav_msgs::Path mapPath;
-            mapPath.header.frame_id = mWorldFrameId;
-            mapPath.header.stamp = mFrameTimestamp;
-            mapPath.poses = mMapPath;
+        mReplayAckCondVar.notify_all();
+    }
 
-            mPubMapPath.publish(mapPath);
+    void ZEDWrapperNodelet::waitReplayAck() {
+        if (mSvoReplayAckTopic.empty() || mReplayLastStamp.isZero()) {
+            return;
         }
 
-        if (odomPathSub > 0) {
-            nav_msgs::Path odomPath;
-            odomPath.header.frame_id = mWorldFrameId;
-            odomPath.header.stamp = mFrameTimestamp;
-            odomPath.poses = mOdomPath;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point deadline = start + std::chrono::microseconds(
+                    static_cast<int64_t>(mSvoReplayAckTimeout * 1e6));
 
-            mPubOdomPath.publish(odomPath);
+        std::unique_lock<std::mutex> lock(mReplayAckMutex);
+
+        while (mReplayAckStamp < mReplayLastStamp && !mStopNode &&
+               std::chrono::steady_clock::now() < deadline) {
+            mReplayAckCondVar.wait_for(lock, std::chrono::milliseconds(100));
+        }
+
+        bool acked = mReplayAckStamp >= mReplayLastStamp;
+        lock.unlock();
+
+        mReplayAckWaitHist_usec.addValue(std::chrono::duration_cast<std::chrono::microseconds>(
+                                             std::chrono::steady_clock::now() - start).count());
+
+        if (!acked && !mStopNode) {
+            mReplayAckTimeouts++;
+            NODELET_WARN_STREAM_THROTTLE(5.0, "Frame " << mReplayLastStamp << " not acknowledged on topic "
+                                         << mSubReplayAck.getTopic() << " within " << mSvoReplayAckTimeout << " sec");
+        }
+    }
+
+    void ZEDWrapperNodelet::waitReplayTime(ros::Time stamp) {
+        if (mSvoReplayRate <= 0.0) {
+            return; // As fast as possible
+        }
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        if (mReplayFirstStamp.isZero() || stamp < mReplayFirstStamp) {
+            mReplayFirstStamp = stamp;
+            mReplayWallStart = now;
+            return;
+        }
+
+        std::chrono::steady_clock::time_point target = mReplayWallStart + std::chrono::microseconds(
+                    static_cast<int64_t>((stamp - mReplayFirstStamp).toSec() / mSvoReplayRate * 1e6));
+
+        if (target > now) {
+            std::this_thread::sleep_until(target);
+        } else if (now - target > std::chrono::seconds(1)) {
+            // Elaboration or consumers slower than the requested rate:
+            // restart the pacing instead of replaying a burst of frames
+            mReplayFirstStamp = stamp;
+            mReplayWallStart = now;
+        }
+    }
+
+    void ZEDWrapperNodelet::syncFrame() {
+        ros::Time cameraStamp = mFrameTimestamp;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        sl_tools::SyncResult res = mFrameSync->addFrame(mFrameSyncId, static_cast<int64_t>(cameraStamp.toNSec()),
+                                   static_cast<int64_t>(mSyncMaxWaitMsec * 1e6));
+        mSyncWaitHist_usec.addValue(std::chrono::duration_cast<std::chrono::microseconds>(
+                                        std::chrono::steady_clock::now() - start).count());
+
+        if (res.complete) {
+            mSyncSkewHist_usec.addValue(res.skewNsec / 1000);
+
+            if (mSyncUseBundleStamp) {
+                mFrameTimestamp.fromNSec(static_cast<uint64_t>(res.stampNsec));
+            }
+        } else {
+            mSyncIncompleteCount++;
+            NODELET_DEBUG_STREAM_THROTTLE(1.0, "Frame " << cameraStamp << " synchronized with " << res.members - 1
+                                          << " of " << res.expected - 1 << " cameras");
+        }
+
+        if (mPubFrameSync.getNumSubscribers() > 0) {
+            zed_wrapper::FrameSyncPtr msg = boost::make_shared<zed_wrapper::FrameSync>();
+            msg->header.stamp = mFrameTimestamp;
+            msg->header.frame_id = mLeftCamFrameId;
+            msg->bundle_id = res.bundleId;
+            msg->camera_stamp = cameraStamp;
+            msg->skew = res.skewNsec * 1e-9;
+            msg->members = static_cast<uint32_t>(res.members);
+            msg->expected = static_cast<uint32_t>(res.expected);
+            msg->complete = res.complete;
+            mPubFrameSync.publish(msg);
         }
     }
 
@@ -1889,10 +2875,37 @@ namespace zed_wrapper {
         uint32_t imu_SubNumber = mPubImu.getNumSubscribers();
         uint32_t imu_RawSubNumber = mPubImuRaw.getNumSubscribers();
 
+        // The recorded data must be generated even without subscribers
+        if (mRecorderImu && mRecorder.isOpen()) {
+            imu_SubNumber++;
+        }
+
         if (imu_SubNumber < 1 && imu_RawSubNumber < 1) {
             return;
         }
 
+        // IMU data are not related to an image frame: use the last grabbed one
+        sl_tools::CTraceScope trace(mTracer, "publish_imu", mFrameCount);
+
+        // Timer events lost because a previous callback took too long
+        if (!e.last_real.isZero()) {
+            int missed = static_cast<int>(std::round((e.current_real - e.last_real).toSec() * mImuPubRate)) - 1;
+
+            if (missed > 0) {
+                sl_tools::CPublishCounter* counter = getPubCounter(mPubImu.getTopic());
+
+                if (counter && imu_SubNumber > 0) {
+                    counter->addSkipped(missed);
+                }
+
+                counter = getPubCounter(mPubImuRaw.getTopic());
+
+                if (counter && imu_RawSubNumber > 0) {
+                    counter->addSkipped(missed);
+                }
+            }
+        }
+
         ros::Time t;
 
         if (mSvoMode) {
@@ -1915,13 +2928,12 @@ namespace zed_wrapper {
 
         if (imu_SubNumber > 0 || imu_RawSubNumber > 0) {
             // Publish freq calculation
-            static std::chrono::steady_clock::time_point last_time = std::chrono::steady_clock::now();
             std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
 
-            double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - last_time).count();
-            last_time = now;
+            double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - mImuLastPubTime).count();
+            mImuLastPubTime = now;
 
-            mImuPeriodMean_usec->addValue(elapsed_usec);
+            mImuPeriodHist_usec.addValue(static_cast<int64_t>(elapsed_usec));
 
             mImuPublishing = true;
         } else {
@@ -1933,132 +2945,83 @@ namespace zed_wrapper {
             imu_msg.header.stamp = t;
             imu_msg.header.frame_id = mImuFrameId;
 
-            imu_msg.orientation.x = mSignX * imu_data.getOrientation()[mIdxX];
-            imu_msg.orientation.y = mSignY * imu_data.getOrientation()[mIdxY];
-            imu_msg.orientation.z = mSignZ * imu_data.getOrientation()[mIdxZ];
+            imu_msg.orientation.x = CoordRemap::x(imu_data.getOrientation());
+            imu_msg.orientation.y = CoordRemap::y(imu_data.getOrientation());
+            imu_msg.orientation.z = CoordRemap::z(imu_data.getOrientation());
             imu_msg.orientation.w = imu_data.getOrientation()[3];
 
-            imu_msg.angular_velocity.x = mSignX * imu_data.angular_velocity[mIdxX] * DEG2RAD;
-            imu_msg.angular_velocity.y = mSignY * imu_data.angular_velocity[mIdxY] * DEG2RAD;
-            imu_msg.angular_velocity.z = mSignZ * imu_data.angular_velocity[mIdxZ] * DEG2RAD;
-
-            imu_msg.linear_acceleration.x = mSignX * imu_data.linear_acceleration[mIdxX];
-            imu_msg.linear_acceleration.y = mSignY * imu_data.linear_acceleration[mIdxY];
-            imu_msg.linear_acceleration.z = mSignZ * imu_data.linear_acceleration[mIdxZ];
-
-            for (int i = 0; i < 3; ++i) {
+            imu_msg.angular_velocity.x = CoordRemap::x(imu_data.angular_velocity) * DEG2RAD;
+            imu_msg.angular_velocity.y = CoordRemap::y(imu_data.angular_velocity) * DEG2RAD;
+            imu_msg.angular_velocity.z = CoordRemap::z(imu_data.angular_velocity) * DEG2RAD;
 
-                int r = 0;
+            imu_msg.linear_acceleration.x = CoordRemap::x(imu_data.linear_acceleration);
+            imu_msg.linear_acceleration.y = CoordRemap::y(imu_data.linear_acceleration);
+            imu_msg.linear_acceleration.z = CoordRemap::z(imu_data.linear_acceleration);
 
-                if (i == 0) {
-                    r = mIdxX;
-                } else if (i == 1) {
-                    r = mIdxY;
-                } else {
-                    r = mIdxZ;
-                }
+            CoordRemap::covariance(imu_data.orientation_covariance.r, imu_msg.orientation_covariance,
+                                   DEG2RAD * DEG2RAD);
+            CoordRemap::covariance(imu_data.linear_acceleration_convariance.r, imu_msg.linear_acceleration_covariance);
+            CoordRemap::covariance(imu_data.angular_velocity_convariance.r, imu_msg.angular_velocity_covariance,
+                                   DEG2RAD * DEG2RAD);
 
-                imu_msg.orientation_covariance[i * 3 + 0] =
-                    imu_data.orientation_covariance.r[r * 3 + mIdxX] * DEG2RAD * DEG2RAD;
-                imu_msg.orientation_covariance[i * 3 + 1] =
-                    imu_data.orientation_covariance.r[r * 3 + mIdxY] * DEG2RAD * DEG2RAD;
-                imu_msg.orientation_covariance[i * 3 + 2] =
-                    imu_data.orientation_covariance.r[r * 3 + mIdxZ] * DEG2RAD * DEG2RAD;
-
-                imu_msg.linear_acceleration_covariance[i * 3 + 0] =
-                    imu_data.linear_acceleration_convariance.r[r * 3 + mIdxX];
-                imu_msg.linear_acceleration_covariance[i * 3 + 1] =
-                    imu_data.linear_acceleration_convariance.r[r * 3 + mIdxY];
-                imu_msg.linear_acceleration_covariance[i * 3 + 2] =
-                    imu_data.linear_acceleration_convariance.r[r * 3 + mIdxZ];
+            mPubImu.publish(imu_msg);
+            countPublished(mPubImu.getTopic(), ros::serialization::serializationLength(imu_msg));
 
-                imu_msg.angular_velocity_covariance[i * 3 + 0] =
-                    imu_data.angular_velocity_convariance.r[r * 3 + mIdxX] * DEG2RAD * DEG2RAD;
-                imu_msg.angular_velocity_covariance[i * 3 + 1] =
-                    imu_data.angular_velocity_convariance.r[r * 3 + mIdxY] * DEG2RAD * DEG2RAD;
-                imu_msg.angular_velocity_covariance[i * 3 + 2] =
-                    imu_data.angular_velocity_convariance.r[r * 3 + mIdxZ] * DEG2RAD * DEG2RAD;
+            if (mRecorderImu && mRecorder.isOpen()) {
+                recordMessage(REC_CH_IMU, imu_msg, t);
             }
-
-            mPubImu.publish(imu_msg);
         }
 
         if (imu_RawSubNumber > 0) {
             sensor_msgs::Imu imu_raw_msg;
             imu_raw_msg.header.stamp = mFrameTimestamp; // t;
             imu_raw_msg.header.frame_id = mImuFrameId;
-            imu_raw_msg.angular_velocity.x = mSignX * imu_data.angular_velocity[mIdxX] * DEG2RAD;
-            imu_raw_msg.angular_velocity.y = mSignY * imu_data.angular_velocity[mIdxY] * DEG2RAD;
-            imu_raw_msg.angular_velocity.z = mSignZ * imu_data.angular_velocity[mIdxZ] * DEG2RAD;
+            imu_raw_msg.angular_velocity.x = CoordRemap::x(imu_data.angular_velocity) * DEG2RAD;
+            imu_raw_msg.angular_velocity.y = CoordRemap::y(imu_data.angular_velocity) * DEG2RAD;
+            imu_raw_msg.angular_velocity.z = CoordRemap::z(imu_data.angular_velocity) * DEG2RAD;
             imu_raw_msg.linear_acceleration.x =
-                mSignX * imu_data.linear_acceleration[mIdxX];
+                CoordRemap::x(imu_data.linear_acceleration);
             imu_raw_msg.linear_acceleration.y =
-                mSignY * imu_data.linear_acceleration[mIdxY];
+                CoordRemap::y(imu_data.linear_acceleration);
             imu_raw_msg.linear_acceleration.z =
-                mSignZ * imu_data.linear_acceleration[mIdxZ];
-
-            for (int i = 0; i < 3; ++i) {
-
-                int r = 0;
+                CoordRemap::z(imu_data.linear_acceleration);
 
-                if (i == 0) {
-                    r = mIdxX;
-                } else if (i == 1) {
-                    r = mIdxY;
-                } else {
-                    r = mIdxZ;
-                }
-
-                imu_raw_msg.linear_acceleration_covariance[i * 3 + 0] =
-                    imu_data.linear_acceleration_convariance.r[r * 3 + mIdxX];
-                imu_raw_msg.linear_acceleration_covariance[i * 3 + 1] =
-                    imu_data.linear_acceleration_convariance.r[r * 3 + mIdxY];
-                imu_raw_msg.linear_acceleration_covariance[i * 3 + 2] =
-                    imu_data.linear_acceleration_convariance.r[r * 3 + mIdxZ];
-                imu_raw_msg.angular_velocity_covariance[i * 3 + 0] =
-                    imu_data.angular_velocity_convariance.r[r * 3 + mIdxX] * DEG2RAD * DEG2RAD;
-                imu_raw_msg.angular_velocity_covariance[i * 3 + 1] =
-                    imu_data.angular_velocity_convariance.r[r * 3 + mIdxY] * DEG2RAD * DEG2RAD;
-                imu_raw_msg.angular_velocity_covariance[i * 3 + 2] =
-                    imu_data.angular_velocity_convariance.r[r * 3 + mIdxZ] * DEG2RAD * DEG2RAD;
-            }
+            CoordRemap::covariance(imu_data.linear_acceleration_convariance.r,
+                                   imu_raw_msg.linear_acceleration_covariance);
+            CoordRemap::covariance(imu_data.angular_velocity_convariance.r, imu_raw_msg.angular_velocity_covariance,
+                                   DEG2RAD * DEG2RAD);
 
             imu_raw_msg.orientation_covariance[0] =
                 -1; // Orientation data is not available in "data_raw" -> See ROS REP145
             // http://www.ros.org/reps/rep-0145.html#topics
             mPubImuRaw.publish(imu_raw_msg);
+            countPublished(mPubImuRaw.getTopic(), ros::serialization::serializationLength(imu_raw_msg));
         }
 
         // Publish IMU tf only if enabled
         if (mPublishTf) {
-            // Camera to pose transform from TF buffer
+            // Camera to pose transform, as last broadcasted by the grabbing thread
             tf2::Transform cam_to_pose;
 
-            std::string poseFrame;
-
-            // Look up the transformation from base frame to map link
-            try {
-                poseFrame = mPublishMapTf ? mMapFrameId : mOdometryFrameId;
-
-                // Save the transformation from base to frame
-                geometry_msgs::TransformStamped c2p =
-                    mTfBuffer->lookupTransform(poseFrame, mCameraFrameId, ros::Time(0));
-                // Get the TF2 transformation
-                tf2::fromMsg(c2p.transform, cam_to_pose);
-            } catch (tf2::TransformException& ex) {
-                NODELET_WARN_THROTTLE(
-                    10.0, "The tf from '%s' to '%s' does not seem to be available. "
-                    "IMU TF not published!",
-                    mCameraFrameId.c_str(), mMapFrameId.c_str());
-                NODELET_DEBUG_THROTTLE(1.0, "Transform error: %s", ex.what());
-                return;
+            {
+                std::lock_guard<std::mutex> lock(mCam2PoseMutex);
+
+                if (!mCam2PoseTransfValid) {
+                    NODELET_WARN_THROTTLE(
+                        10.0, "The tf from '%s' to '%s' is not yet available. "
+                        "IMU TF not published!",
+                        mCameraFrameId.c_str(), (mPublishMapTf ? mMapFrameId : mOdometryFrameId).c_str());
+                    return;
+                }
+
+                cam_to_pose = mCam2PoseTransf;
             }
 
             // IMU Quaternion in Map frame
             tf2::Quaternion imu_q;
-            imu_q.setX(mSignX * imu_data.getOrientation()[mIdxX]);
-            imu_q.setY(mSignY * imu_data.getOrientation()[mIdxY]);
-            imu_q.setZ(mSignZ * imu_data.getOrientation()[mIdxZ]);
+            imu_q.setX(CoordRemap::x(imu_data.getOrientation()));
+            imu_q.setY(CoordRemap::y(imu_data.getOrientation()));
+            imu_q.setZ(CoordRemap::z(imu_data.getOrientation()));
             imu_q.setW(imu_data.getOrientation()[3]);
             // Pose Quaternion from ZED Camera
             tf2::Quaternion map_q = cam_to_pose.getRotation();
@@ -2078,12 +3041,18 @@ namespace zed_wrapper {
 
         mRecording = false;
 
-        mElabPeriodMean_sec.reset(new sl_tools::CSmartMean(mCamFrameRate));
-        mGrabPeriodMean_usec.reset(new sl_tools::CSmartMean(mCamFrameRate));
-        mPcPeriodMean_usec.reset(new sl_tools::CSmartMean(mCamFrameRate));
+        if (mBlackBoxEnabled) {
+            startBlackBox();
+        }
+
+        mElabTimeHist_usec.reset();
+        mGrabPeriodHist_usec.reset();
+        mPcPeriodHist_usec.reset();
 
         // Timestamp initialization
-        if (mSvoMode) {
+        if (mSvoRecordedTime) {
+            mFrameTimestamp = sl_tools::slTime2Ros(mZed.getTimestamp(sl::TIME_REFERENCE_IMAGE));
+        } else if (mSvoMode) {
             mFrameTimestamp = ros::Time::now();
         } else {
             mFrameTimestamp = sl_tools::slTime2Ros(mZed.getTimestamp(sl::TIME_REFERENCE_CURRENT));
@@ -2099,23 +3068,24 @@ namespace zed_wrapper {
         mCamWidth = mZed.getResolution().width;
         mCamHeight = mZed.getResolution().height;
         NODELET_DEBUG_STREAM("Camera Frame size : " << mCamWidth << "x" << mCamHeight);
-        mMatWidth = static_cast<int>(mCamWidth * mCamMatResizeFactor);
-        mMatHeight = static_cast<int>(mCamHeight * mCamMatResizeFactor);
+        double resizeFactor = acquireDynParams()->matResizeFactor;
+        mMatWidth = static_cast<int>(mCamWidth * resizeFactor);
+        mMatHeight = static_cast<int>(mCamHeight * resizeFactor);
         NODELET_DEBUG_STREAM("Data Mat size : " << mMatWidth << "x" << mMatHeight);
 
         // Create and fill the camera information messages
-        fillCamInfo(mZed, mLeftCamInfoMsg, mRightCamInfoMsg, mLeftCamOptFrameId,
-                    mRightCamOptFrameId);
-        fillCamInfo(mZed, mLeftCamInfoRawMsg, mRightCamInfoRawMsg, mLeftCamOptFrameId,
-                    mRightCamOptFrameId, true);
-
-        // the reference camera is the Left one (next to the ZED logo)
-
-        mRgbCamInfoMsg = mDepthCamInfoMsg = mLeftCamInfoMsg;
-        mRgbCamInfoRawMsg = mLeftCamInfoRawMsg;
+        std::atomic_store(&mCamInfo, getCamInfoSet(mMatWidth, mMatHeight));
 
         sl::RuntimeParameters runParams;
         runParams.sensing_mode = static_cast<sl::SENSING_MODE>(mCamSensingMode);
+
+        // Camera settings applied to the camera: the SDK is called only when a
+        // reconfiguration changes them (-1: to be applied)
+        uint32_t autoExposureTrigger = 0; // Last automatic exposure request applied
+        int appliedConfidence = -1;
+        double appliedMaxDepth = -1.0;
+        int appliedExposure = -1;
+        int appliedGain = -1;
         sl::Mat leftZEDMat, rightZEDMat, depthZEDMat, disparityZEDMat, confImgZEDMat, confMapZEDMat;
 
         // Main loop
@@ -2126,13 +3096,20 @@ namespace zed_wrapper {
             uint32_t rgbSubnumber = mPubRgb.getNumSubscribers();
             uint32_t rgbRawSubnumber = mPubRawRgb.getNumSubscribers();
             uint32_t leftSubnumber = mPubLeft.getNumSubscribers();
+            uint32_t rgbJpegSubnumber = mPubRgbJpeg.getNumSubscribers();
+            uint32_t leftJpegSubnumber = mPubLeftJpeg.getNumSubscribers();
             uint32_t leftRawSubnumber = mPubRawLeft.getNumSubscribers();
             uint32_t rightSubnumber = mPubRight.getNumSubscribers();
             uint32_t rightRawSubnumber = mPubRawRight.getNumSubscribers();
             uint32_t depthSubnumber = mPubDepth.getNumSubscribers();
+            uint32_t depthCompSubnumber = mPubDepthCompressed.getNumSubscribers();
             uint32_t disparitySubnumber = mPubDisparity.getNumSubscribers();
+            uint32_t scanSubnumber = mPubScan.getNumSubscribers();
             uint32_t cloudSubnumber = mPubCloud.getNumSubscribers();
             uint32_t fusedCloudSubnumber = mPubFusedCloud.getNumSubscribers();
+            uint32_t gridSubnumber = mPubObstacleGrid.getNumSubscribers();
+            uint32_t normalsSubnumber = mPubNormals.getNumSubscribers();
+            uint32_t elevationSubnumber = mPubElevationMap.getNumSubscribers();
             uint32_t poseSubnumber = mPubPose.getNumSubscribers();
             uint32_t poseCovSubnumber = mPubPoseCov.getNumSubscribers();
             uint32_t odomSubnumber = mPubOdom.getNumSubscribers();
@@ -2144,11 +3121,18 @@ namespace zed_wrapper {
             uint32_t stereoSubNumber = mPubStereo.getNumSubscribers();
             uint32_t stereoRawSubNumber = mPubRawStereo.getNumSubscribers();
 
+            // The recorded topics are generated even without subscribers
+            if (mRecorder.isOpen()) {
+                depthSubnumber += mRecorderDepth ? 1 : 0;
+                cloudSubnumber += mRecorderPointCloud ? 1 : 0;
+                odomSubnumber += mRecorderOdom ? 1 : 0;
+            }
+
             mGrabActive =  mRecording || mStreaming || mMappingEnabled || mTrackingActivated ||
-                           ((rgbSubnumber + rgbRawSubnumber + leftSubnumber +
+                           ((rgbSubnumber + rgbRawSubnumber + leftSubnumber + rgbJpegSubnumber + leftJpegSubnumber +
                              leftRawSubnumber + rightSubnumber + rightRawSubnumber +
-                             depthSubnumber + disparitySubnumber + cloudSubnumber +
-                             poseSubnumber + poseCovSubnumber + odomSubnumber + confImgSubnumber +
+                             depthSubnumber + depthCompSubnumber + disparitySubnumber + scanSubnumber + cloudSubnumber + gridSubnumber +
+                             elevationSubnumber + normalsSubnumber + poseSubnumber + poseCovSubnumber + odomSubnumber + confImgSubnumber +
                              confMapSubnumber /*+ imuSubnumber + imuRawsubnumber*/ + pathSubNumber +
                              stereoSubNumber + stereoRawSubNumber) > 0);
 
@@ -2156,11 +3140,14 @@ namespace zed_wrapper {
 
             // Run the loop only if there is some subscribers or SVO is active
             if (mGrabActive) {
-                std::lock_guard<std::mutex> lock(mPosTrkMutex);
+                std::unique_lock<std::mutex> lock(mPosTrkMutex);
+
+                // Parameters of this frame: a reconfiguration only replaces the snapshot
+                const DynParams* dynParams = acquireDynParams();
 
                 // Note: one tracking is started is never stopped anymore
                 bool computeTracking = (mMappingEnabled || (mComputeDepth & mDepthStabilization) || poseSubnumber > 0 ||
-                                        poseCovSubnumber > 0 || odomSubnumber > 0 || pathSubNumber > 0);
+                                        poseCovSubnumber > 0 || odomSubnumber > 0 || pathSubNumber > 0 || elevationSubnumber > 0);
 
                 // Start the tracking?
                 if ((computeTracking) && !mTrackingActivated && (mCamQuality != sl::DEPTH_MODE_NONE)) {
@@ -2174,21 +3161,27 @@ namespace zed_wrapper {
 
                 // Detect if one of the subscriber need to have the depth information
                 mComputeDepth = mCamQuality != sl::DEPTH_MODE_NONE &&
-                                ((depthSubnumber + disparitySubnumber + cloudSubnumber + fusedCloudSubnumber +
+                                ((depthSubnumber + depthCompSubnumber + disparitySubnumber + scanSubnumber + cloudSubnumber + fusedCloudSubnumber + gridSubnumber +
+                                  elevationSubnumber + normalsSubnumber +
                                   poseSubnumber + poseCovSubnumber + odomSubnumber + confImgSubnumber +
                                   confMapSubnumber) > 0);
 
                 if (mComputeDepth) {
-                    int actual_confidence = mZed.getConfidenceThreshold();
-
-                    if (actual_confidence != mCamConfidence) {
-                        mZed.setConfidenceThreshold(mCamConfidence);
+                    if (appliedConfidence != dynParams->confidence) {
+                        mZed.setConfidenceThreshold(dynParams->confidence);
+                        appliedConfidence = dynParams->confidence;
+                        mCamSettingsSetCount++;
                     }
 
-                    double actual_max_depth = static_cast<double>(mZed.getDepthMaxRangeValue());
+                    if (appliedMaxDepth != dynParams->maxDepth) {
+                        mZed.setDepthMaxRangeValue(static_cast<double>(dynParams->maxDepth));
+                        appliedMaxDepth = dynParams->maxDepth;
+                        mCamSettingsSetCount++;
 
-                    if (actual_max_depth != mCamMaxDepth) {
-                        mZed.setDepthMaxRangeValue(static_cast<double>(mCamMaxDepth));
+                        // The range used by the SDK is read only when it changes, not for each disparity message
+                        mDisparityMinDepth = mZed.getDepthMinRangeValue();
+                        mDisparityMaxDepth = mZed.getDepthMaxRangeValue();
+                        mCamSettingsGetCount += 2;
                     }
 
                     runParams.enable_depth = true; // Ask to compute the depth
@@ -2196,7 +3189,14 @@ namespace zed_wrapper {
                     runParams.enable_depth = false; // Ask to not compute the depth
                 }
 
-                mGrabStatus = mZed.grab(runParams);
+                // Replay back-pressure: the consumers must have processed the previous frame
+                waitReplayAck();
+
+                {
+                    // The frame counter is incremented only if the grab succeeds
+                    sl_tools::CTraceScope trace(mTracer, "grab", mFrameCount + 1);
+                    mGrabStatus = mZed.grab(runParams);
+                }
 
                 // cout << toString(grab_status) << endl;
                 if (mGrabStatus != sl::ERROR_CODE::SUCCESS) {
@@ -2205,6 +3205,13 @@ namespace zed_wrapper {
                     // re-initialize the ZED
                     if (mGrabStatus != sl::ERROR_CODE_NOT_A_NEW_FRAME) {
                         NODELET_INFO_STREAM_ONCE(toString(mGrabStatus));
+                        mGrabErrorCount++;
+                    } else {
+                        mGrabNotNewCount++;
+
+                        if (mSvoRecordedTime && mZed.getSVOPosition() >= mZed.getSVONumberOfFrames() - 1) {
+                            NODELET_INFO_STREAM_ONCE("End of the SVO file reached after " << mFrameCount << " frames");
+                        }
                     }
 
                     std::this_thread::sleep_for(std::chrono::milliseconds(1));
@@ -2244,6 +3251,13 @@ namespace zed_wrapper {
 
                         mTrackingActivated = false;
 
+                        // The camera has been opened again: apply all the settings
+                        autoExposureTrigger = 0;
+                        appliedConfidence = -1;
+                        appliedMaxDepth = -1.0;
+                        appliedExposure = -1;
+                        appliedGain = -1;
+
                         computeTracking = mDepthStabilization || poseSubnumber > 0 || poseCovSubnumber > 0 ||
                                           odomSubnumber > 0;
 
@@ -2257,80 +3271,114 @@ namespace zed_wrapper {
                     continue;
                 }
 
-                // SVO recording
-                mRecMutex.lock();
-
-                if (mRecording) {
-                    mRecState = mZed.record();
-
-                    if (!mRecState.status) {
-                        ROS_ERROR_THROTTLE(1.0, "Error saving frame to SVO");
-                    }
-
-                    mDiagUpdater.force_update();
-                }
-
-                mRecMutex.unlock();
-
                 // Timestamp
                 mPrevFrameTimestamp = mFrameTimestamp;
 
+                ++mFrameCount;
+                mFrameDroppedCount = mZed.getFrameDroppedCount();
+
                 // Publish freq calculation
-                static std::chrono::steady_clock::time_point last_time = std::chrono::steady_clock::now();
                 std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
 
-                double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - last_time).count();
-                last_time = now;
+                double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - mGrabLastTime).count();
+                mGrabLastTime = now;
 
-                mGrabPeriodMean_usec->addValue(elapsed_usec);
+                mGrabPeriodHist_usec.addValue(static_cast<int64_t>(elapsed_usec));
 
                 //ROS_INFO_STREAM("Grab time: " << elapsed_usec / 1000 << " msec");
 
                 // Timestamp
-                if (mSvoMode) {
+                if (mSvoMode && !mSvoRecordedTime) {
                     mFrameTimestamp = ros::Time::now();
                 } else {
                     mFrameTimestamp = sl_tools::slTime2Ros(mZed.getTimestamp(sl::TIME_REFERENCE_IMAGE));
                 }
 
-                if (mCamAutoExposure) {
+                // SVO recording: the SDK records the last grabbed frame, so it
+                // must be saved by this thread before grabbing the next one
+                recordSvoFrame(mFrameTimestamp);
+
+                // The wait for the other cameras must not block the tracking services
+                if (mFrameSync) {
+                    lock.unlock();
+                    syncFrame();
+                    lock.lock();
+                }
+
+                // SVO replay: the simulated time advances to the frame before its data are published
+                if (mSvoRecordedTime) {
+                    waitReplayTime(mFrameTimestamp);
+
+                    if (mPubClock) {
+                        rosgraph_msgs::Clock clock;
+                        clock.clock = mFrameTimestamp;
+                        mPubClock->publish(clock);
+                    }
+
+                    mReplayLastStamp = mFrameTimestamp;
+                }
+
+                if (dynParams->autoExposure) {
                     // getCameraSettings() can't check status of auto exposure
-                    // triggerAutoExposure is used to execute setCameraSettings() only once
-                    if (mTriggerAutoExposure) {
+                    // autoExposureTrigger is used to execute setCameraSettings() only once
+                    if (autoExposureTrigger != dynParams->autoExposureTrigger) {
                         mZed.setCameraSettings(sl::CAMERA_SETTINGS_EXPOSURE, 0, true);
-                        mTriggerAutoExposure = false;
+                        autoExposureTrigger = dynParams->autoExposureTrigger;
+                        mCamSettingsSetCount++;
+
+                        // The manual values must be applied again when the automatic mode is disabled
+                        appliedExposure = -1;
+                        appliedGain = -1;
                     }
                 } else {
-                    int actual_exposure =
-                        mZed.getCameraSettings(sl::CAMERA_SETTINGS_EXPOSURE);
-
-                    if (actual_exposure != mCamExposure) {
-                        mZed.setCameraSettings(sl::CAMERA_SETTINGS_EXPOSURE, mCamExposure);
+                    if (appliedExposure != dynParams->exposure) {
+                        mZed.setCameraSettings(sl::CAMERA_SETTINGS_EXPOSURE, dynParams->exposure);
+                        appliedExposure = dynParams->exposure;
+                        mCamSettingsSetCount++;
                     }
 
-                    int actual_gain = mZed.getCameraSettings(sl::CAMERA_SETTINGS_GAIN);
-
-                    if (actual_gain != mCamGain) {
-                        mZed.setCameraSettings(sl::CAMERA_SETTINGS_GAIN, mCamGain);
+                    if (appliedGain != dynParams->gain) {
+                        mZed.setCameraSettings(sl::CAMERA_SETTINGS_GAIN, dynParams->gain);
+                        appliedGain = dynParams->gain;
+                        mCamSettingsSetCount++;
                     }
                 }
 
-                mCamDataMutex.lock();
-
-
+                // Output size and camera information of this frame: a reconfiguration
+                // only replaces the snapshot, without blocking the grab loop
+                CamInfoSetConstPtr camInfo = std::atomic_load(&mCamInfo);
+                mMatWidth = camInfo->width;
+                mMatHeight = camInfo->height;
 
                 // Publish the left == rgb image if someone has subscribed to
-                if (leftSubnumber > 0 || rgbSubnumber > 0) {
+                if (leftSubnumber > 0 || rgbSubnumber > 0 || leftJpegSubnumber > 0 || rgbJpegSubnumber > 0) {
 
                     // Retrieve RGBA Left image
-                    mZed.retrieveImage(leftZEDMat, sl::VIEW_LEFT, sl::MEM_CPU, mMatWidth, mMatHeight);
+                    {
+                        sl_tools::CTraceScope trace(mTracer, "retrieve_left", mFrameCount);
+                        mZed.retrieveImage(leftZEDMat, sl::VIEW_LEFT, sl::MEM_CPU, mMatWidth, mMatHeight);
+                    }
 
                     if (leftSubnumber > 0) {
-                        publishImage(leftZEDMat, mPubLeft, mLeftCamInfoMsg, mLeftCamOptFrameId, mFrameTimestamp);
+                        sl_tools::CTraceScope trace(mTracer, "publish_left", mFrameCount);
+                        publishImage(leftZEDMat, mPubLeft, camInfo->left, mLeftCamOptFrameId, mFrameTimestamp);
                     }
 
                     if (rgbSubnumber > 0) {
-                        publishImage(leftZEDMat, mPubRgb, mRgbCamInfoMsg, mDepthOptFrameId, mFrameTimestamp); // rgb is the left image
+                        sl_tools::CTraceScope trace(mTracer, "publish_rgb", mFrameCount);
+                        publishImage(leftZEDMat, mPubRgb, camInfo->left, mDepthOptFrameId, mFrameTimestamp); // rgb is the left image
+                    }
+
+                    // The JPEG topics are encoded straight from the BGRA image:
+                    // the raw messages are created only for their own subscribers
+                    if (leftJpegSubnumber > 0) {
+                        sl_tools::CTraceScope trace(mTracer, "publish_left_jpeg", mFrameCount);
+                        publishImageJpeg(leftZEDMat, mPubLeftJpeg, mLeftCamOptFrameId, mFrameTimestamp);
+                    }
+
+                    if (rgbJpegSubnumber > 0) {
+                        sl_tools::CTraceScope trace(mTracer, "publish_rgb_jpeg", mFrameCount);
+                        publishImageJpeg(leftZEDMat, mPubRgbJpeg, mDepthOptFrameId, mFrameTimestamp);
                     }
                 }
 
@@ -2338,14 +3386,19 @@ namespace zed_wrapper {
                 if (leftRawSubnumber > 0 || rgbRawSubnumber > 0) {
 
                     // Retrieve RGBA Left image
-                    mZed.retrieveImage(leftZEDMat, sl::VIEW_LEFT_UNRECTIFIED, sl::MEM_CPU, mMatWidth, mMatHeight);
+                    {
+                        sl_tools::CTraceScope trace(mTracer, "retrieve_left_raw", mFrameCount);
+                        mZed.retrieveImage(leftZEDMat, sl::VIEW_LEFT_UNRECTIFIED, sl::MEM_CPU, mMatWidth, mMatHeight);
+                    }
 
                     if (leftRawSubnumber > 0) {
-                        publishImage(leftZEDMat, mPubRawLeft, mLeftCamInfoRawMsg, mLeftCamOptFrameId, mFrameTimestamp);
+                        sl_tools::CTraceScope trace(mTracer, "publish_left_raw", mFrameCount);
+                        publishImage(leftZEDMat, mPubRawLeft, camInfo->leftRaw, mLeftCamOptFrameId, mFrameTimestamp);
                     }
 
                     if (rgbRawSubnumber > 0) {
-                        publishImage(leftZEDMat, mPubRawRgb, mRgbCamInfoRawMsg, mDepthOptFrameId, mFrameTimestamp);
+                        sl_tools::CTraceScope trace(mTracer, "publish_rgb_raw", mFrameCount);
+                        publishImage(leftZEDMat, mPubRawRgb, camInfo->leftRaw, mDepthOptFrameId, mFrameTimestamp);
                     }
                 }
 
@@ -2353,96 +3406,217 @@ namespace zed_wrapper {
                 if (rightSubnumber > 0) {
 
                     // Retrieve RGBA Right image
-                    mZed.retrieveImage(rightZEDMat, sl::VIEW_RIGHT, sl::MEM_CPU, mMatWidth, mMatHeight);
+                    {
+                        sl_tools::CTraceScope trace(mTracer, "retrieve_right", mFrameCount);
+                        mZed.retrieveImage(rightZEDMat, sl::VIEW_RIGHT, sl::MEM_CPU, mMatWidth, mMatHeight);
+                    }
 
-                    publishImage(rightZEDMat, mPubRight, mRightCamInfoMsg, mRightCamOptFrameId, mFrameTimestamp);
+                    {
+                        sl_tools::CTraceScope trace(mTracer, "publish_right", mFrameCount);
+                        publishImage(rightZEDMat, mPubRight, camInfo->right, mRightCamOptFrameId, mFrameTimestamp);
+                    }
                 }
 
                 // Publish the right image if someone has subscribed to
                 if (rightRawSubnumber > 0) {
 
                     // Retrieve RGBA Right image
-                    mZed.retrieveImage(rightZEDMat, sl::VIEW_RIGHT_UNRECTIFIED, sl::MEM_CPU, mMatWidth, mMatHeight);
+                    {
+                        sl_tools::CTraceScope trace(mTracer, "retrieve_right_raw", mFrameCount);
+                        mZed.retrieveImage(rightZEDMat, sl::VIEW_RIGHT_UNRECTIFIED, sl::MEM_CPU, mMatWidth, mMatHeight);
+                    }
 
-                    publishImage(rightZEDMat, mPubRawRight, mRightCamInfoRawMsg, mRightCamOptFrameId, mFrameTimestamp);
+                    {
+                        sl_tools::CTraceScope trace(mTracer, "publish_right_raw", mFrameCount);
+                        publishImage(rightZEDMat, mPubRawRight, camInfo->rightRaw, mRightCamOptFrameId, mFrameTimestamp);
+                    }
                 }
 
                 // Stereo couple side-by-side
                 if (stereoSubNumber > 0) {
 
                     // Retrieve RGBA Right image
-                    mZed.retrieveImage(rightZEDMat, sl::VIEW_RIGHT, sl::MEM_CPU, mMatWidth, mMatHeight);
-                    mZed.retrieveImage(leftZEDMat, sl::VIEW_LEFT, sl::MEM_CPU, mMatWidth, mMatHeight);
+                    {
+                        sl_tools::CTraceScope trace(mTracer, "retrieve_right", mFrameCount);
+                        mZed.retrieveImage(rightZEDMat, sl::VIEW_RIGHT, sl::MEM_CPU, mMatWidth, mMatHeight);
+                    }
 
-                    mPubStereo.publish(sl_tools::imagesToROSmsg(leftZEDMat, rightZEDMat, mCameraFrameId, mFrameTimestamp));
+                    {
+                        sl_tools::CTraceScope trace(mTracer, "retrieve_left", mFrameCount);
+                        mZed.retrieveImage(leftZEDMat, sl::VIEW_LEFT, sl::MEM_CPU, mMatWidth, mMatHeight);
+                    }
+
+                    {
+                        sl_tools::CTraceScope trace(mTracer, "publish_stereo", mFrameCount);
+                        sensor_msgs::ImagePtr stereoMsg = sl_tools::imagesToROSmsg(leftZEDMat, rightZEDMat, mCameraFrameId, mFrameTimestamp);
+                        mPubStereo.publish(stereoMsg);
+                        countPublished(mPubStereo.getTopic(), ros::serialization::serializationLength(*stereoMsg));
+                    }
                 }
 
                 // Stereo RAW couple side-by-side
                 if (stereoRawSubNumber > 0) {
 
                     // Retrieve RGBA Right image
-                    mZed.retrieveImage(rightZEDMat, sl::VIEW_RIGHT_UNRECTIFIED, sl::MEM_CPU, mMatWidth, mMatHeight);
-                    mZed.retrieveImage(leftZEDMat, sl::VIEW_LEFT_UNRECTIFIED, sl::MEM_CPU, mMatWidth, mMatHeight);
+                    {
+                        sl_tools::CTraceScope trace(mTracer, "retrieve_right_raw", mFrameCount);
+                        mZed.retrieveImage(rightZEDMat, sl::VIEW_RIGHT_UNRECTIFIED, sl::MEM_CPU, mMatWidth, mMatHeight);
+                    }
+
+                    {
+                        sl_tools::CTraceScope trace(mTracer, "retrieve_left_raw", mFrameCount);
+                        mZed.retrieveImage(leftZEDMat, sl::VIEW_LEFT_UNRECTIFIED, sl::MEM_CPU, mMatWidth, mMatHeight);
+                    }
+
+                    {
+                        sl_tools::CTraceScope trace(mTracer, "publish_stereo_raw", mFrameCount);
+                        sensor_msgs::ImagePtr stereoMsg = sl_tools::imagesToROSmsg(leftZEDMat, rightZEDMat, mCameraFrameId, mFrameTimestamp);
+                        mPubRawStereo.publish(stereoMsg);
+                        countPublished(mPubRawStereo.getTopic(), ros::serialization::serializationLength(*stereoMsg));
+                    }
+                }
 
-                    mPubRawStereo.publish(sl_tools::imagesToROSmsg(leftZEDMat, rightZEDMat, mCameraFrameId, mFrameTimestamp));
+                // Retrieve the depth map if someone has subscribed to the depth, to the scan or to the elevation map
+                if (depthSubnumber > 0 || depthCompSubnumber > 0 || disparitySubnumber > 0 || scanSubnumber > 0 ||
+                    elevationSubnumber > 0) {
+                    sl_tools::CTraceScope trace(mTracer, "retrieve_depth", mFrameCount);
+                    mZed.retrieveMeasure(depthZEDMat, sl::MEASURE_DEPTH, sl::MEM_CPU, mMatWidth, mMatHeight);
                 }
 
                 // Publish the depth image if someone has subscribed to
                 if (depthSubnumber > 0 || disparitySubnumber > 0) {
+                    sl_tools::CTraceScope trace(mTracer, "publish_depth", mFrameCount);
+                    publishDepth(depthZEDMat, camInfo->left, mFrameTimestamp); // in meters
+                }
 
-                    mZed.retrieveMeasure(depthZEDMat, sl::MEASURE_DEPTH, sl::MEM_CPU, mMatWidth, mMatHeight);
-                    publishDepth(depthZEDMat, mFrameTimestamp); // in meters
+                // Publish the compressed depth image if someone has subscribed to
+                if (depthCompSubnumber > 0) {
+                    sl_tools::CTraceScope trace(mTracer, "publish_depth_compressed", mFrameCount);
+                    publishDepthCompressed(depthZEDMat, mFrameTimestamp);
+                }
+
+                // Publish the laser scan if someone has subscribed to: no depth
+                // image message is created, only the rows of the scan are read
+                if (scanSubnumber > 0) {
+                    sl_tools::CTraceScope trace(mTracer, "publish_scan", mFrameCount);
+                    publishScan(depthZEDMat, camInfo, mFrameTimestamp);
                 }
 
                 // Publish the disparity image if someone has subscribed to
                 if (disparitySubnumber > 0) {
 
-                    mZed.retrieveMeasure(disparityZEDMat, sl::MEASURE_DISPARITY, sl::MEM_CPU, mMatWidth, mMatHeight);
+                    {
+                        sl_tools::CTraceScope trace(mTracer, "retrieve_disparity", mFrameCount);
+                        mZed.retrieveMeasure(disparityZEDMat, sl::MEASURE_DISPARITY, sl::MEM_CPU, mMatWidth, mMatHeight);
+                    }
 
-                    publishDisparity(disparityZEDMat, mFrameTimestamp);
+                    {
+                        sl_tools::CTraceScope trace(mTracer, "publish_disparity", mFrameCount);
+                        publishDisparity(disparityZEDMat, camInfo, mFrameTimestamp);
+                    }
                 }
 
                 // Publish the confidence image if someone has subscribed to
                 if (confImgSubnumber > 0) {
 
-                    mZed.retrieveImage(confImgZEDMat, sl::VIEW_CONFIDENCE, sl::MEM_CPU, mMatWidth, mMatHeight);
-                    publishImage(confImgZEDMat, mPubConfImg, mDepthCamInfoMsg, mConfidenceOptFrameId, mFrameTimestamp);
+                    {
+                        sl_tools::CTraceScope trace(mTracer, "retrieve_confidence_image", mFrameCount);
+                        mZed.retrieveImage(confImgZEDMat, sl::VIEW_CONFIDENCE, sl::MEM_CPU, mMatWidth, mMatHeight);
+                    }
+
+                    {
+                        sl_tools::CTraceScope trace(mTracer, "publish_confidence_image", mFrameCount);
+                        publishImage(confImgZEDMat, mPubConfImg, camInfo->left, mConfidenceOptFrameId, mFrameTimestamp);
+                    }
                 }
 
                 // Publish the confidence map if someone has subscribed to
                 if (confMapSubnumber > 0) {
 
-                    mZed.retrieveMeasure(confMapZEDMat, sl::MEASURE_CONFIDENCE, sl::MEM_CPU, mMatWidth, mMatHeight);
-                    mPubConfMap.publish(sl_tools::imageToROSmsg(confMapZEDMat, mConfidenceOptFrameId, mFrameTimestamp));
+                    {
+                        sl_tools::CTraceScope trace(mTracer, "retrieve_confidence_map", mFrameCount);
+                        mZed.retrieveMeasure(confMapZEDMat, sl::MEASURE_CONFIDENCE, sl::MEM_CPU, mMatWidth, mMatHeight);
+                    }
+
+                    {
+                        sl_tools::CTraceScope trace(mTracer, "publish_confidence_map", mFrameCount);
+                        sensor_msgs::ImagePtr confMapMsg = sl_tools::imageToROSmsg(confMapZEDMat, mConfidenceOptFrameId, mFrameTimestamp);
+                        mPubConfMap.publish(confMapMsg);
+                        countPublished(mPubConfMap.getTopic(), ros::serialization::serializationLength(*confMapMsg));
+                    }
                 }
 
-                // Publish the point cloud if someone has subscribed to
-                if (cloudSubnumber > 0) {
+                // Publish the point cloud, the obstacle grid or the normals if someone has subscribed to
+                if (cloudSubnumber > 0 || gridSubnumber > 0 || normalsSubnumber > 0) {
+
+                    // Run the point cloud conversion asynchronously on the worker pool
+                    // to avoid slowing down all the program
+                    double pcPeriodSec = 1. / dynParams->pointCloudFreq - 0.5 / mCamFrameRate; // Half frame tolerance
+                    bool pcDue = mSvoRecordedTime || // SVO replay: the frequency is given by the replay rate
+                                 std::chrono::duration_cast<std::chrono::microseconds>(now - mPcLastRetrieveTime).count() >=
+                                 pcPeriodSec * 1e6;
+
+                    // The obstacle grid is built in the base frame
+                    if (gridSubnumber > 0 && !mSensor2BaseTransfValid) {
+                        getSens2BaseTransform();
+                    }
 
-                    // Run the point cloud conversion asynchronously to avoid slowing down
-                    // all the program
-                    // Retrieve raw pointCloud data if latest Pointcloud is ready
                     std::unique_lock<std::mutex> lock(mPcMutex, std::defer_lock);
+                    sl_tools::CPublishCounter* pcCounter =
+                        getPubCounter(cloudSubnumber > 0 ? mPubCloud.getTopic() :
+                                      (gridSubnumber > 0 ? mPubObstacleGrid.getTopic() : mPubNormals.getTopic()));
+
+                    // SVO replay: wait for the previous point cloud, every frame must be published
+                    if (mSvoRecordedTime) {
+                        lock.lock();
+
+                        while (mPcDataReady && !mStopNode) {
+                            mPcDataReadyCondVar.wait_for(lock, std::chrono::milliseconds(100));
+                        }
+                    } else if (pcDue) {
+                        lock.try_lock();
+                    }
+
+                    if (lock.owns_lock()) {
+                        bool jobPending = mPcDataReady;
+
+                        // The previous point cloud has not been published yet
+                        if (jobPending && pcCounter) {
+                            pcCounter->addSuperseded();
+                        }
 
-                    if (lock.try_lock()) {
-                        mZed.retrieveMeasure(mCloud, sl::MEASURE_XYZBGRA, sl::MEM_CPU, mMatWidth, mMatHeight);
+                        {
+                            sl_tools::CTraceScope trace(mTracer, "retrieve_point_cloud", mFrameCount);
+                            mZed.retrieveMeasure(mCloud, sl::MEASURE_XYZBGRA, sl::MEM_CPU, mMatWidth, mMatHeight);
+                        }
 
                         mPointCloudFrameId = mDepthFrameId;
                         mPointCloudTime = mFrameTimestamp;
+                        mPointCloudFrame = mFrameCount;
+                        mPointCloudBaseTransf = mSensor2BaseTransf.inverse();
+                        mPcPublishCloud = cloudSubnumber > 0;
+                        mPcPublishGrid = gridSubnumber > 0;
+                        mPcPublishNormals = normalsSubnumber > 0;
+                        mPcLastRetrieveTime = now;
+
+                        // The queued job publishes the newest data
+                        if (!jobPending) {
+                            mPcDataReady = true;
+                            mWorkerPool->post(std::bind(&ZEDWrapperNodelet::pointcloud_job_func, this));
+                        }
 
-                        // Signal Pointcloud thread that a new pointcloud is ready
-                        mPcDataReadyCondVar.notify_one();
-                        mPcDataReady = true;
                         mPcPublishing = true;
+                    } else if (pcDue && pcCounter) {
+                        // The point cloud job is still publishing
+                        pcCounter->addSkipped();
                     }
                 } else {
                     mPcPublishing = false;
                 }
 
-                mCamDataMutex.unlock();
-
                 // Publish the odometry if someone has subscribed to
                 if (computeTracking) {
+                    sl_tools::CTraceScope trace(mTracer, "tracking_odom", mFrameCount);
 
                     if (!mSensor2BaseTransfValid) {
                         getSens2BaseTransform();
@@ -2466,8 +3640,8 @@ namespace zed_wrapper {
 #if 0
                         NODELET_DEBUG("delta ODOM [%s] - %.2f,%.2f,%.2f %.2f,%.2f,%.2f,%.2f",
                                       sl::toString(mTrackingStatus).c_str(),
-                                      translation(mIdxX), translation(mIdxY), translation(mIdxZ),
-                                      quat(mIdxX), quat(mIdxY), quat(mIdxZ), quat(3));
+                                      CoordRemap::x(translation), CoordRemap::y(translation), CoordRemap::z(translation),
+                                      CoordRemap::x(quat), CoordRemap::y(quat), CoordRemap::z(quat), quat(3));
 
                         NODELET_DEBUG_STREAM("ODOM -> Tracking Status: " << sl::toString(mTrackingStatus));
 #endif
@@ -2476,12 +3650,12 @@ namespace zed_wrapper {
                             mTrackingStatus == sl::TRACKING_STATE_FPS_TOO_LOW) {
                             // Transform ZED delta odom pose in TF2 Transformation
                             geometry_msgs::Transform deltaTransf;
-                            deltaTransf.translation.x = mSignX * translation(mIdxX);
-                            deltaTransf.translation.y = mSignY * translation(mIdxY);
-                            deltaTransf.translation.z = mSignZ * translation(mIdxZ);
-                            deltaTransf.rotation.x = mSignX * quat(mIdxX);
-                            deltaTransf.rotation.y = mSignY * quat(mIdxY);
-                            deltaTransf.rotation.z = mSignZ * quat(mIdxZ);
+                            deltaTransf.translation.x = CoordRemap::x(translation);
+                            deltaTransf.translation.y = CoordRemap::y(translation);
+                            deltaTransf.translation.z = CoordRemap::z(translation);
+                            deltaTransf.rotation.x = CoordRemap::x(quat);
+                            deltaTransf.rotation.y = CoordRemap::y(quat);
+                            deltaTransf.rotation.z = CoordRemap::z(quat);
                             deltaTransf.rotation.w = quat(3);
                             tf2::Transform deltaOdomTf;
                             tf2::fromMsg(deltaTransf, deltaOdomTf);
@@ -2529,8 +3703,15 @@ namespace zed_wrapper {
 
                 }
 
+                // Fuse the depth map in the elevation map if someone has subscribed to
+                if (elevationSubnumber > 0 && mTrackingReady) {
+                    sl_tools::CTraceScope trace(mTracer, "fuse_elevation_map", mFrameCount);
+                    fuseElevationMap(depthZEDMat, camInfo, mFrameTimestamp);
+                }
+
                 // Publish the zed camera pose if someone has subscribed to
                 if (computeTracking) {
+                    sl_tools::CTraceScope trace(mTracer, "tracking_pose", mFrameCount);
                     static sl::TRACKING_STATE oldStatus;
                     mTrackingStatus = mZed.getPosition(mLastZedPose, sl::REFERENCE_FRAME_WORLD);
 
@@ -2555,12 +3736,12 @@ namespace zed_wrapper {
                         // Transform ZED pose in TF2 Transformation
                         geometry_msgs::Transform map2sensTransf;
 
-                        map2sensTransf.translation.x = mSignX * translation(mIdxX);
-                        map2sensTransf.translation.y = mSignY * translation(mIdxY);
-                        map2sensTransf.translation.z = mSignZ * translation(mIdxZ);
-                        map2sensTransf.rotation.x = mSignX * quat(mIdxX);
-                        map2sensTransf.rotation.y = mSignY * quat(mIdxY);
-                        map2sensTransf.rotation.z = mSignZ * quat(mIdxZ);
+                        map2sensTransf.translation.x = CoordRemap::x(translation);
+                        map2sensTransf.translation.y = CoordRemap::y(translation);
+                        map2sensTransf.translation.z = CoordRemap::z(translation);
+                        map2sensTransf.rotation.x = CoordRemap::x(quat);
+                        map2sensTransf.rotation.y = CoordRemap::y(quat);
+                        map2sensTransf.rotation.z = CoordRemap::z(quat);
                         map2sensTransf.rotation.w = quat(3);
                         tf2::Transform map_to_sens_transf;
                         tf2::fromMsg(map2sensTransf, map_to_sens_transf);
@@ -2614,6 +3795,10 @@ namespace zed_wrapper {
 
                             mInitOdomWithPose = false;
                             mResetOdom = false;
+
+                            // The fused points are not aligned to the new odometry
+                            std::lock_guard<std::mutex> elevationLock(mElevationMutex);
+                            mElevationMap.clear();
                         } else {
                             // Transformation from map to odometry frame
                             //mMap2OdomTransf = mOdom2BaseTransf.inverse() * mMap2BaseTransf;
@@ -2645,15 +3830,14 @@ namespace zed_wrapper {
 
                 // Publish pose tf only if enabled
                 if (mPublishTf) {
-                    // Note, the frame is published, but its values will only change if
-                    // someone has subscribed to odom
-                    publishOdomFrame(mOdom2BaseTransf, mFrameTimestamp); // publish the base Frame in odometry frame
-
-                    if (mPublishMapTf) {
-                        // Note, the frame is published, but its values will only change if
-                        // someone has subscribed to map
-                        publishPoseFrame(mMap2OdomTransf, mFrameTimestamp); // publish the odometry Frame in map frame
+                    // Note, the frames are published, but their values will only change if
+                    // someone has subscribed to odom or map
+                    {
+                        sl_tools::CTraceScope trace(mTracer, "tf_broadcast", mFrameCount);
+                        broadcastFrameTf(mFrameTimestamp); // publish the base Frame in odometry frame and odometry in map
                     }
+
+                    updateCam2PoseTransform();
                 }
 
 #if 0 //#ifndef NDEBUG // Enable for TF checking
@@ -2688,28 +3872,33 @@ namespace zed_wrapper {
 
                 double elab_usec = std::chrono::duration_cast<std::chrono::microseconds>(end_elab - start_elab).count();
 
-                double mean_elab_sec = mElabPeriodMean_sec->addValue(elab_usec / 1000000.);
+                if (mTracer.isEnabled()) {
+                    int64_t start_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(start_elab.time_since_epoch()).count();
+                    mTracer.record("frame", start_nsec, static_cast<int64_t>(elab_usec * 1000.), mFrameCount);
+                }
 
-                static int count_warn = 0;
+                mElabTimeHist_usec.addValue(static_cast<int64_t>(elab_usec));
+                double elab_sec = elab_usec / 1000000.;
 
-                if (!loop_rate.sleep()) {
-                    if (mean_elab_sec > (1. / mCamFrameRate)) {
-                        if (++count_warn > 10) {
+                // SVO replay is paced by the recorded timestamps (see waitReplayTime)
+                if (!mSvoRecordedTime && !loop_rate.sleep()) {
+                    if (elab_sec > (1. / mCamFrameRate)) {
+                        if (++mRateWarnCount > 10) {
                             NODELET_DEBUG_THROTTLE(
                                 1.0,
                                 "Working thread is not synchronized with the Camera frame rate");
                             NODELET_DEBUG_STREAM_THROTTLE(
                                 1.0, "Expected cycle time: " << loop_rate.expectedCycleTime()
                                 << " - Real cycle time: "
-                                << mean_elab_sec);
-                            NODELET_WARN_STREAM_THROTTLE(10.0, "Elaboration takes longer (" << mean_elab_sec << " sec) than requested "
+                                << elab_sec);
+                            NODELET_WARN_STREAM_THROTTLE(10.0, "Elaboration takes longer (" << elab_sec << " sec) than requested "
                                                          "by the FPS rate (" << loop_rate.expectedCycleTime() << " sec). Please consider to "
                                                          "lower the 'frame_rate' setting or to reduce the power requirements reducing the resolutions.");
                         }
 
                         loop_rate.reset();
                     } else {
-                        count_warn = 0;
+                        mRateWarnCount = 0;
                     }
                 }
             } else {
@@ -2725,11 +3914,8 @@ namespace zed_wrapper {
                         t = sl_tools::slTime2Ros(mZed.getTimestamp(sl::TIME_REFERENCE_CURRENT));
                     }
 
-                    publishOdomFrame(mOdom2BaseTransf, mFrameTimestamp); // publish the base Frame in odometry frame
-
-                    if (mPublishMapTf) {
-                        publishPoseFrame(mMap2OdomTransf, mFrameTimestamp); // publish the odometry Frame in map frame
-                    }
+                    broadcastFrameTf(mFrameTimestamp); // publish the base Frame in odometry frame and odometry in map
+                    updateCam2PoseTransform();
                 }
 
                 std::this_thread::sleep_for(
@@ -2751,25 +3937,39 @@ namespace zed_wrapper {
 
     void ZEDWrapperNodelet::updateDiagnostic(diagnostic_updater::DiagnosticStatusWrapper& stat) {
 
+        // ----> Statistics of the last diagnostic period
+        mElabTimeWin_usec.update(mElabTimeHist_usec);
+        mGrabPeriodWin_usec.update(mGrabPeriodHist_usec);
+        mPcPeriodWin_usec.update(mPcPeriodHist_usec);
+        mImuPeriodWin_usec.update(mImuPeriodHist_usec);
+        mSvoRecordWin_usec.update(mSvoRecordHist_usec);
+        mReplayAckWaitWin_usec.update(mReplayAckWaitHist_usec);
+        mSyncSkewWin_usec.update(mSyncSkewHist_usec);
+        mSyncWaitWin_usec.update(mSyncWaitHist_usec);
+        // <---- Statistics of the last diagnostic period
+
         if (mConnStatus == sl::SUCCESS) {
             if (mGrabActive) {
                 if (mGrabStatus == sl::SUCCESS || mGrabStatus == sl::ERROR_CODE_NOT_A_NEW_FRAME) {
 
                     stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "Camera grabbing");
 
-                    double freq = 1000000. / mGrabPeriodMean_usec->getMean();
+                    double freq = meanFrequency(mGrabPeriodWin_usec);
                     double freq_perc = 100.*freq / mCamFrameRate;
                     stat.addf("Capture", "Mean Frequency: %.1f Hz (%.1f%%)", freq, freq_perc);
+                    addLatencyDiagnostic(stat, "Capture period", mGrabPeriodWin_usec);
 
-                    stat.addf("Processing Time", "Mean time: %.3f sec (Max. %.3f sec)", mElabPeriodMean_sec->getMean(), 1. / mCamFrameRate);
+                    stat.addf("Processing Time", "Mean time: %.3f sec (Max. %.3f sec)", mElabTimeWin_usec.getMean() / 1000000., 1. / mCamFrameRate);
+                    addLatencyDiagnostic(stat, "Processing time", mElabTimeWin_usec);
 
                     if (mComputeDepth) {
                         stat.add("Depth status", "ACTIVE");
 
                         if (mPcPublishing) {
-                            double freq = 1000000. / mPcPeriodMean_usec->getMean();
+                            double freq = meanFrequency(mPcPeriodWin_usec);
                             double freq_perc = 100.*freq / mCamFrameRate;
                             stat.addf("Point Cloud", "Mean Frequency: %.1f Hz (%.1f%%)", freq, freq_perc);
+                            addLatencyDiagnostic(stat, "Point Cloud period", mPcPeriodWin_usec);
                         } else {
                             stat.add("Point Cloud", "Topic not subscribed");
                         }
@@ -2800,9 +4000,10 @@ namespace zed_wrapper {
             }
 
             if (mImuPublishing) {
-                double freq = 1000000. / mImuPeriodMean_usec->getMean();
+                double freq = meanFrequency(mImuPeriodWin_usec);
                 double freq_perc = 100.*freq / mImuPubRate;
                 stat.addf("IMU", "Mean Frequency: %.1f Hz (%.1f%%)", freq, freq_perc);
+                addLatencyDiagnostic(stat, "IMU period", mImuPeriodWin_usec);
             } else {
                 stat.add("IMU", "Topics not subscribed");
             }
@@ -2820,34 +4021,276 @@ namespace zed_wrapper {
                     stat.add("SVO Recording", "ACTIVE");
                     stat.addf("SVO compression time", "%g msec", mRecState.average_compression_time);
                     stat.addf("SVO compression ratio", "%.1f%%", mRecState.average_compression_ratio);
+                    addLatencyDiagnostic(stat, "SVO record time", mSvoRecordWin_usec);
+
+                    // A segment switch is rare: the statistics refer to the whole recording
+                    addLatencyDiagnostic(stat, "SVO segment switch", mSvoSwitchHist_usec);
+                }
+
+                if (mSvoFailedCount > 0) {
+                    stat.addf("SVO frames not recorded", "%lu", static_cast<unsigned long>(mSvoFailedCount));
                 }
+            } else if (mSvoDiskFull) {
+                stat.add("SVO Recording", "STOPPED - DISK FULL");
+                stat.summary(diagnostic_msgs::DiagnosticStatus::WARN, "SVO recording stopped: not enough free disk space");
             } else {
                 stat.add("SVO Recording", "NOT ACTIVE");
             }
+
+            if (mBlackBoxEnabled) {
+                if (mBlackBoxDumping) {
+                    stat.add("Black box", "RECORDING POST-TRIGGER");
+                } else if (mBlackBoxCopying) {
+                    stat.add("Black box", "SAVING");
+                } else {
+                    stat.add("Black box", mRecording ? "BUFFERING" : "ERROR");
+                }
+            }
+
+            if (mSvoRecordedTime) {
+                stat.addf("SVO replay", "Frame %d of %d - Time: %.3f", mZed.getSVOPosition(), mZed.getSVONumberOfFrames(),
+                          mReplayLastStamp.toSec());
+
+                if (!mSvoReplayAckTopic.empty()) {
+                    addLatencyDiagnostic(stat, "Replay acknowledge wait", mReplayAckWaitWin_usec);
+                    stat.addf("Replay acknowledge timeouts", "%lu", static_cast<unsigned long>(mReplayAckTimeouts));
+                }
+            }
+
+            if (mFrameSync) {
+                addLatencyDiagnostic(stat, "Frame sync skew", mSyncSkewWin_usec);
+                addLatencyDiagnostic(stat, "Frame sync wait", mSyncWaitWin_usec);
+                stat.addf("Frame sync incomplete bundles", "%lu", static_cast<unsigned long>(mSyncIncompleteCount));
+            }
+
+            if (mRecorder.isOpen()) {
+                stat.addf("Native recorder", "%.1f MB written - Lost chunks: %lu", mRecorder.getWrittenBytes() / 1048576.,
+                          static_cast<unsigned long>(mRecorder.getDroppedChunks()));
+
+                if (mRecorder.getDroppedChunks() > 0) {
+                    stat.summary(diagnostic_msgs::DiagnosticStatus::WARN, "Native recorder: disk too slow, data lost");
+                }
+            }
+
+            addTopicsDiagnostic(stat);
         } else {
             stat.summary(diagnostic_msgs::DiagnosticStatus::ERROR, sl::toString(mConnStatus).c_str());
         }
     }
 
-    bool ZEDWrapperNodelet::on_start_svo_recording(zed_wrapper::start_svo_recording::Request& req,
-            zed_wrapper::start_svo_recording::Response& res) {
-        std::lock_guard<std::mutex> lock(mRecMutex);
+    void ZEDWrapperNodelet::addLatencyDiagnostic(diagnostic_updater::DiagnosticStatusWrapper& stat,
+            const std::string& name, const sl_tools::CLatencyWindow& win) {
+        if (win.getValCount() == 0) {
+            return;
+        }
 
-        if (mRecording) {
-            res.result = false;
-            res.info = "Recording was just active";
-            return false;
+        stat.addf(name, "p50: %.3f msec - p95: %.3f msec - p99: %.3f msec - max: %.3f msec",
+                  win.getPercentile(50.) / 1000., win.getPercentile(95.) / 1000.,
+                  win.getPercentile(99.) / 1000., win.getMax() / 1000.);
+    }
+
+    void ZEDWrapperNodelet::addLatencyDiagnostic(diagnostic_updater::DiagnosticStatusWrapper& stat,
+            const std::string& name, const sl_tools::CLatencyHistogram& hist) {
+        if (hist.getValCount() == 0) {
+            return;
         }
 
-        // Check filename
-        if (req.svo_filename.empty()) {
-            req.svo_filename = "zed.svo";
+        stat.addf(name, "p50: %.3f msec - p95: %.3f msec - p99: %.3f msec - max: %.3f msec",
+                  hist.getPercentile(50.) / 1000., hist.getPercentile(95.) / 1000.,
+                  hist.getPercentile(99.) / 1000., hist.getMax() / 1000.);
+    }
+
+    bool ZEDWrapperNodelet::on_reset_statistics(zed_wrapper::reset_statistics::Request& req,
+            zed_wrapper::reset_statistics::Response& res) {
+        mElabTimeHist_usec.reset();
+        mGrabPeriodHist_usec.reset();
+        mPcPeriodHist_usec.reset();
+        mImuPeriodHist_usec.reset();
+        mImgConvTimeHist_usec.reset();
+        mPcConvTimeHist_usec.reset();
+        mSvoRecordHist_usec.reset();
+        mSvoSwitchHist_usec.reset();
+        mReplayAckWaitHist_usec.reset();
+        mSyncSkewHist_usec.reset();
+        mSyncWaitHist_usec.reset();
+
+        NODELET_INFO("Latency statistics reset");
+
+        res.reset_done = true;
+        return true;
+    }
+
+    sl_tools::CPublishCounter* ZEDWrapperNodelet::getPubCounter(const std::string& topic) {
+        std::map<std::string, std::unique_ptr<sl_tools::CPublishCounter>>::const_iterator it = mPubCounters.find(topic);
+
+        if (it == mPubCounters.end()) {
+            return nullptr;
         }
 
-        sl::ERROR_CODE err;
+        return it->second.get();
+    }
+
+    void ZEDWrapperNodelet::countPublished(const std::string& topic, uint64_t bytes) {
+        sl_tools::CPublishCounter* counter = getPubCounter(topic);
+
+        if (counter) {
+            counter->addMessage(bytes);
+        }
+    }
+
+    void ZEDWrapperNodelet::addTopicsDiagnostic(diagnostic_updater::DiagnosticStatusWrapper& stat) {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        double elapsed_sec = std::chrono::duration_cast<std::chrono::microseconds>(now - mDiagLastTime).count() / 1000000.;
+        mDiagLastTime = now;
+
+        for (const auto& counter : mPubCounters) {
+            uint64_t msgs = counter.second->getMsgCount();
+            uint64_t bytes = counter.second->getByteCount();
+
+            TopicSnapshot& last = mDiagLastCounts[counter.first];
+
+            if (msgs != last.msgs && elapsed_sec > 0.) {
+                stat.addf("Topic " + counter.first, "%.1f msg/s - %.3f MB/s - Skipped: %lu - Superseded: %lu",
+                          (msgs - last.msgs) / elapsed_sec, (bytes - last.bytes) / elapsed_sec / 1048576.,
+                          static_cast<unsigned long>(counter.second->getSkippedCount()),
+                          static_cast<unsigned long>(counter.second->getSupersededCount()));
+            }
+
+            last.msgs = msgs;
+            last.bytes = bytes;
+        }
+    }
+
+    bool ZEDWrapperNodelet::on_get_stats(zed_wrapper::get_stats::Request& req,
+                                         zed_wrapper::get_stats::Response& res) {
+        res.frames_grabbed = mFrameCount;
+        res.frames_dropped = mFrameDroppedCount;
+        res.frames_not_new = mGrabNotNewCount;
+        res.grab_errors = mGrabErrorCount;
+        res.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - mStatsStartTime).count() / 1000000.;
+
+        for (const auto& counter : mPubCounters) {
+            res.topics.push_back(counter.first);
+            res.messages.push_back(counter.second->getMsgCount());
+            res.bytes.push_back(counter.second->getByteCount());
+            res.skipped.push_back(counter.second->getSkippedCount());
+            res.superseded.push_back(counter.second->getSupersededCount());
+        }
+
+        return true;
+    }
+
+    std::string ZEDWrapperNodelet::getMetricsPage() {
+        // The cameras of the same process can be scraped by the same job
+        sl_tools::CMetricsWriter metrics("camera=\"" + getName() + "\"");
+
+        metrics.addCounter("zed_frames_grabbed_total", "Number of frames successfully grabbed", mFrameCount);
+        metrics.addCounter("zed_frames_dropped_total", "Number of frames dropped by the camera", mFrameDroppedCount);
+        metrics.addCounter("zed_grab_errors_total", "Number of failed grab calls", mGrabErrorCount);
+        metrics.addCounter("zed_frames_not_new_total", "Number of grab calls that did not return a new frame", mGrabNotNewCount);
+        // Must not grow with zed_frames_grabbed_total: the settings are applied only when reconfigured
+        metrics.addCounter("zed_camera_settings_calls_total", "Number of SDK calls of the grab loop to apply or read the camera settings",
+                           mCamSettingsSetCount, "call=\"set\"");
+        metrics.addCounter("zed_camera_settings_calls_total", "Number of SDK calls of the grab loop to apply or read the camera settings",
+                           mCamSettingsGetCount, "call=\"get\"");
+
+        for (const auto& counter : mPubCounters) {
+            metrics.addCounter("zed_published_messages_total", "Number of messages published on each topic",
+                               counter.second->getMsgCount(), "topic=\"" + counter.first + "\"");
+        }
+
+        for (const auto& counter : mPubCounters) {
+            metrics.addCounter("zed_published_bytes_total", "Number of bytes published on each topic",
+                               counter.second->getByteCount(), "topic=\"" + counter.first + "\"");
+        }
+
+        for (const auto& counter : mPubCounters) {
+            metrics.addCounter("zed_skipped_messages_total", "Number of messages not published because the publisher was busy",
+                               counter.second->getSkippedCount(), "topic=\"" + counter.first + "\"");
+        }
+
+        for (const auto& counter : mPubCounters) {
+            metrics.addCounter("zed_superseded_messages_total", "Number of messages replaced by newer data before being published",
+                               counter.second->getSupersededCount(), "topic=\"" + counter.first + "\"");
+        }
+
+        metrics.addSummary("zed_grab_period_seconds", "Period between two grabbed frames", mGrabPeriodHist_usec, 1e-6);
+        metrics.addSummary("zed_processing_time_seconds", "Elaboration time of each frame", mElabTimeHist_usec, 1e-6);
+        metrics.addSummary("zed_point_cloud_period_seconds", "Period between two published point clouds", mPcPeriodHist_usec, 1e-6);
+        metrics.addSummary("zed_imu_period_seconds", "Period between two published IMU messages", mImuPeriodHist_usec, 1e-6);
+        metrics.addSummary("zed_image_conversion_seconds", "Time to convert an image to a ROS message", mImgConvTimeHist_usec, 1e-6);
+        metrics.addSummary("zed_point_cloud_conversion_seconds", "Time to convert a point cloud to a ROS message", mPcConvTimeHist_usec, 1e-6);
+        metrics.addSummary("zed_svo_record_seconds", "Time to add a frame to the SVO file", mSvoRecordHist_usec, 1e-6);
+        metrics.addSummary("zed_svo_segment_switch_seconds", "Time the grab was stalled closing a SVO segment and opening the next one",
+                           mSvoSwitchHist_usec, 1e-6);
+        metrics.addSummary("zed_replay_ack_wait_seconds", "Time the SVO replay waited for the consumers", mReplayAckWaitHist_usec, 1e-6);
+        metrics.addSummary("zed_sync_skew_seconds", "Difference between the timestamps of the synchronized frames", mSyncSkewHist_usec, 1e-6);
+        metrics.addSummary("zed_sync_wait_seconds", "Time the grab waited for the frames of the other cameras", mSyncWaitHist_usec, 1e-6);
+        metrics.addCounter("zed_sync_incomplete_total", "Number of frames without the frames of all the other cameras", mSyncIncompleteCount);
+        metrics.addCounter("zed_svo_failed_frames_total", "Number of frames that could not be added to the SVO file", mSvoFailedCount);
+
+        {
+            std::lock_guard<std::mutex> lock(mRecMutex);
+
+            metrics.addGauge("zed_svo_recording", "1 if SVO recording is active", mRecording ? 1 : 0);
+
+            if (mRecording) {
+                metrics.addGauge("zed_svo_compression_time_seconds", "Average time to compress a frame in the SVO file",
+                                 mRecState.average_compression_time / 1000.);
+                metrics.addGauge("zed_svo_compression_ratio", "Average compression ratio of the SVO file [%]",
+                                 mRecState.average_compression_ratio);
+            }
+        }
+
+        return metrics.str();
+    }
+
+    void ZEDWrapperNodelet::startRecorder() {
+        std::vector<sl_tools::RecChannel> channels;
+
+        if (mRecorderDepth) {
+            channels.push_back({REC_CH_DEPTH, mPubDepth.getTopic(),
+                                ros::message_traits::datatype<sensor_msgs::Image>()});
+        }
+
+        if (mRecorderPointCloud) {
+            channels.push_back({REC_CH_POINT_CLOUD, mPubCloud.getTopic(),
+                                ros::message_traits::datatype<sensor_msgs::PointCloud2>()});
+        }
+
+        if (mRecorderOdom) {
+            channels.push_back({REC_CH_ODOM, mPubOdom.getTopic(),
+                                ros::message_traits::datatype<nav_msgs::Odometry>()});
+        }
+
+        if (mRecorderImu) {
+            if (mPubImu.getTopic().empty()) {
+                NODELET_WARN_STREAM("IMU data not available: the IMU will not be recorded");
+                mRecorderImu = false;
+            } else {
+                channels.push_back({REC_CH_IMU, mPubImu.getTopic(),
+                                    ros::message_traits::datatype<sensor_msgs::Imu>()});
+            }
+        }
+
+        std::string dir = mRecorderFile.substr(0, mRecorderFile.find_last_of('/') + 1);
+
+        if (!dir.empty()) {
+            sl_tools::make_dir(dir);
+        }
+
+        if (mRecorder.open(mRecorderFile, channels, static_cast<size_t>(mRecorderChunkKb) * 1024, mRecorderCompress)) {
+            NODELET_INFO_STREAM("Recording " << channels.size() << " topics to " << mRecorderFile);
+        } else {
+            NODELET_ERROR_STREAM("Cannot create the recorder file " << mRecorderFile);
+        }
+    }
+
+    sl::ERROR_CODE ZEDWrapperNodelet::enableSvoRecording(const std::string& filename) {
         sl::SVO_COMPRESSION_MODE compression = mSvoComprMode;
 
-        err = mZed.enableRecording(req.svo_filename.c_str(), mSvoComprMode);
+        sl::ERROR_CODE err = mZed.enableRecording(filename.c_str(), compression);
 
         if (err == sl::ERROR_CODE_SVO_UNSUPPORTED_COMPRESSION) {
 #if ((ZED_SDK_MAJOR_VERSION>2) || (ZED_SDK_MAJOR_VERSION==2 && ZED_SDK_MINOR_VERSION>=7))
@@ -2857,15 +4300,14 @@ namespace zed_wrapper {
             ROS_WARN_STREAM("The chosen " << sl::toString(mSvoComprMode).c_str() << "mode is not available. Trying " <<
                             sl::toString(compression).c_str());
 
-            err = mZed.enableRecording(req.svo_filename.c_str(), compression);
+            err = mZed.enableRecording(filename.c_str(), compression);
 
             if (err == sl::ERROR_CODE_SVO_UNSUPPORTED_COMPRESSION) {
                 ROS_WARN_STREAM(sl::toString(compression).c_str() << "not available. Trying " << sl::toString(
                                     sl::SVO_COMPRESSION_MODE_LOSSY).c_str());
                 compression = sl::SVO_COMPRESSION_MODE_LOSSY;
-                err = mZed.enableRecording(req.svo_filename.c_str(), compression);  // JPEG Compression?
-
-
+                err = mZed.enableRecording(filename.c_str(), compression);  // JPEG Compression?
+            }
 #else
             compression = mSvoComprMode == sl::SVO_COMPRESSION_MODE_LOSSY ? sl::SVO_COMPRESSION_MODE_LOSSLESS :
                           sl::SVO_COMPRESSION_MODE_LOSSY;
@@ -2873,17 +4315,247 @@ namespace zed_wrapper {
             ROS_WARN_STREAM("The chosen " << sl::toString(mSvoComprMode).c_str() << "mode is not available. Trying " <<
                             sl::toString(compression).c_str());
 
-
-            err = mZed.enableRecording(req.svo_filename.c_str(), compression);
+            err = mZed.enableRecording(filename.c_str(), compression);
 #endif
 
-                if (err == sl::ERROR_CODE_SVO_UNSUPPORTED_COMPRESSION) {
-                    compression = sl::SVO_COMPRESSION_MODE_RAW;
-                    err = mZed.enableRecording(req.svo_filename.c_str(), compression);
+            if (err == sl::ERROR_CODE_SVO_UNSUPPORTED_COMPRESSION) {
+                compression = sl::SVO_COMPRESSION_MODE_RAW;
+                err = mZed.enableRecording(filename.c_str(), compression);
+            }
+        }
+
+        if (err == sl::SUCCESS) {
+            mSvoComprMode = compression;
+        }
+
+        return err;
+    }
+
+    void ZEDWrapperNodelet::startBlackBox() {
+        std::lock_guard<std::mutex> lock(mRecMutex);
+
+        if (!sl_tools::make_dir(mBlackBoxDir)) {
+            NODELET_ERROR_STREAM("Black box: cannot create the buffer folder " << mBlackBoxDir);
+            return;
+        }
+
+        mSvoCurrent = SvoSegment();
+        mSvoCurrent.filename = mBlackBoxDir + "/segment_" + std::to_string(mBlackBoxSegIdx++) + ".svo";
+
+        sl::ERROR_CODE err = enableSvoRecording(mSvoCurrent.filename);
+
+        if (err != sl::SUCCESS) {
+            NODELET_ERROR_STREAM("Black box: cannot start SVO recording: " << sl::toString(err).c_str());
+            return;
+        }
+
+        mRecording = true;
+        NODELET_INFO_STREAM("Black box recording STARTED (" << sl::toString(mSvoComprMode).c_str() << ")");
+    }
+
+    void ZEDWrapperNodelet::addBlackBoxSegment(const SvoSegment& seg, std::unique_lock<std::mutex>& lock) {
+        if (mBlackBoxDumping) {
+            mBlackBoxDumpSegments.push_back(seg);
+        } else {
+            mBlackBoxSegments.push_back(seg);
+        }
+
+        // ----> Post-trigger window completed: save the segments
+        if (mBlackBoxDumping && seg.end >= mBlackBoxDumpEnd) {
+            if (mBlackBoxDumpThread.joinable()) {
+                mBlackBoxDumpThread.join(); // Already finished, checked by on_dump_recording
+            }
+
+            mBlackBoxCopying = true;
+            mBlackBoxDumpThread = std::thread(&ZEDWrapperNodelet::blackbox_dump_thread_func, this,
+                                              mBlackBoxDumpSegments, mBlackBoxDumpDir);
+            mBlackBoxDumpSegments.clear();
+            mBlackBoxDumping = false;
+        }
+
+        // <---- Post-trigger window completed: save the segments
+
+        // ----> Remove the segments older than the pre-trigger window
+        double duration = 0.0;
+        uint64_t size = 0;
+
+        for (const SvoSegment& buffered : mBlackBoxSegments) {
+            duration += (buffered.end - buffered.start).toSec();
+            size += buffered.size;
+        }
+
+        uint64_t maxSize = static_cast<uint64_t>(mBlackBoxMaxSizeMb) * 1048576;
+        std::vector<std::string> expired;
+
+        while (!mBlackBoxSegments.empty()) {
+            const SvoSegment& oldest = mBlackBoxSegments.front();
+            double oldestDuration = (oldest.end - oldest.start).toSec();
+
+            if (duration - oldestDuration < mBlackBoxPreSec && size <= maxSize) {
+                break;
+            }
+
+            duration -= oldestDuration;
+            size -= oldest.size;
+            expired.push_back(oldest.filename);
+            mBlackBoxSegments.pop_front();
+        }
+
+        lock.unlock();
+
+        for (const std::string& filename : expired) {
+            std::remove(filename.c_str());
+        }
+
+        lock.lock();
+        // <---- Remove the segments older than the pre-trigger window
+    }
+
+    void ZEDWrapperNodelet::blackbox_dump_thread_func(std::vector<SvoSegment> segments, std::string dumpDir) {
+        if (!sl_tools::make_dir(dumpDir)) {
+            NODELET_ERROR_STREAM("Black box: cannot create the folder " << dumpDir);
+        } else {
+            for (size_t i = 0; i < segments.size(); i++) {
+                char name[32];
+                snprintf(name, sizeof(name), "/blackbox_%03zu.svo", i);
+                std::string dest = dumpDir + name;
+
+                // The buffer is usually on a different file system: rename fails and the file is copied
+                if (std::rename(segments[i].filename.c_str(), dest.c_str()) != 0) {
+                    std::ifstream src(segments[i].filename.c_str(), std::ios::binary);
+                    std::ofstream dst(dest.c_str(), std::ios::binary);
+                    dst << src.rdbuf();
+
+                    if (!dst.good()) {
+                        NODELET_ERROR_STREAM("Black box: error saving " << dest);
+                    }
+
+                    std::remove(segments[i].filename.c_str());
                 }
             }
+
+            NODELET_INFO_STREAM("Black box: " << segments.size() << " SVO segments saved in " << dumpDir);
+        }
+
+        mBlackBoxCopying = false;
+    }
+
+    bool ZEDWrapperNodelet::on_dump_recording(zed_wrapper::dump_recording::Request& req,
+            zed_wrapper::dump_recording::Response& res) {
+        std::lock_guard<std::mutex> lock(mRecMutex);
+
+        if (!mRecording) {
+            res.result = false;
+            res.info = "Black box recording is not active";
+            return false;
+        }
+
+        if (mBlackBoxDumping || mBlackBoxCopying) {
+            res.result = false;
+            res.info = "A previous dump is still in progress";
+            return false;
+        }
+
+        if (req.dump_dir.empty()) {
+            req.dump_dir = mBlackBoxDumpRoot + "/" + std::to_string(static_cast<long>(mFrameTimestamp.toSec()));
+        }
+
+        // The segments of the pre-trigger window are moved out of the buffer,
+        // the segments recorded until the end of the post-trigger window are appended
+        mBlackBoxDumpSegments.assign(mBlackBoxSegments.begin(), mBlackBoxSegments.end());
+        mBlackBoxSegments.clear();
+        mBlackBoxDumpEnd = mFrameTimestamp + ros::Duration(mBlackBoxPostSec);
+        mBlackBoxDumpDir = req.dump_dir;
+        mBlackBoxDumping = true;
+
+        res.result = true;
+        res.info = "Saving to " + req.dump_dir;
+
+        ROS_INFO_STREAM("Black box: dump requested, saving to " << req.dump_dir);
+
+        return true;
+    }
+
+    std::string ZEDWrapperNodelet::getSvoSegmentName(int idx) {
+        char suffix[16];
+        snprintf(suffix, sizeof(suffix), "_%03d.svo", idx);
+        return mSvoBaseName + suffix;
+    }
+
+    void ZEDWrapperNodelet::closeSvoSegment() {
+        mZed.disableRecording();
+
+        // Size and index are written by the segment thread
+        mSvoClosedSegments.push_back(mSvoCurrent);
+
+        if (mSvoSegmented) {
+            mSvoClosedSegments.back().index = mSvoBaseName + ".index";
+        }
+
+        mSvoSegmentCondVar.notify_all();
+    }
+
+    void ZEDWrapperNodelet::stopSvoRecording() {
+        closeSvoSegment();
+        mRecording = false;
+        mSvoSwitchRequested = false;
+        mSvoStopRequested = false;
+    }
+
+    bool ZEDWrapperNodelet::on_start_svo_recording(zed_wrapper::start_svo_recording::Request& req,
+            zed_wrapper::start_svo_recording::Response& res) {
+        std::lock_guard<std::mutex> lock(mRecMutex);
+
+        if (mBlackBoxEnabled) {
+            res.result = false;
+            res.info = "SVO recording is used by the black box mode";
+            return false;
+        }
+
+        if (mRecording) {
+            res.result = false;
+            res.info = "Recording was just active";
+            return false;
+        }
+
+        // Check filename
+        if (req.svo_filename.empty()) {
+            req.svo_filename = "zed.svo";
+        }
+
+        // Check free disk space
+        size_t slash = req.svo_filename.find_last_of('/');
+        mSvoDir = (slash == std::string::npos) ? std::string(".") : req.svo_filename.substr(0, slash + 1);
+
+        if (sl_tools::free_disk_space(mSvoDir) < static_cast<uint64_t>(mSvoMinFreeMb) * 1048576) {
+            res.result = false;
+            res.info = "Not enough free disk space in " + mSvoDir;
+            return false;
+        }
+
+        mSvoDiskFull = false;
+        mSvoSegmented = mSvoSegmentMaxSec > 0.0 || mSvoSegmentMaxMb > 0;
+        mSvoSegIdx = 0;
+        mSvoCurrent = SvoSegment();
+
+        if (mSvoSegmented) {
+            // `name.svo` is recorded as `name_000.svo`, `name_001.svo`, ... listed in `name.index`
+            mSvoBaseName = req.svo_filename;
+
+            if (mSvoBaseName.size() > 4 && mSvoBaseName.compare(mSvoBaseName.size() - 4, 4, ".svo") == 0) {
+                mSvoBaseName.resize(mSvoBaseName.size() - 4);
+            }
+
+            mSvoCurrent.filename = getSvoSegmentName(mSvoSegIdx++);
+
+            std::ofstream index((mSvoBaseName + ".index").c_str(), std::ios::trunc);
+            index << "# filename start_sec end_sec size_bytes" << std::endl;
+        } else {
+            mSvoCurrent.filename = req.svo_filename;
         }
 
+        sl::ERROR_CODE err = enableSvoRecording(mSvoCurrent.filename);
+
         if (err != sl::SUCCESS) {
             res.result = false;
             res.info = sl::toString(err).c_str();
@@ -2891,14 +4563,14 @@ namespace zed_wrapper {
             return false;
         }
 
-        mSvoComprMode = compression;
+        mSvoLastDiskCheck = std::chrono::steady_clock::now();
         mRecording = true;
         res.info = "Recording started (";
-        res.info += sl::toString(compression).c_str();
+        res.info += sl::toString(mSvoComprMode).c_str();
         res.info += ")";
         res.result = true;
 
-        ROS_INFO_STREAM("SVO recording STARTED: " << req.svo_filename << " (" << sl::toString(compression).c_str() << ")");
+        ROS_INFO_STREAM("SVO recording STARTED: " << req.svo_filename << " (" << sl::toString(mSvoComprMode).c_str() << ")");
 
         return true;
     }
@@ -2907,14 +4579,19 @@ namespace zed_wrapper {
             zed_wrapper::stop_svo_recording::Response& res) {
         std::lock_guard<std::mutex> lock(mRecMutex);
 
+        if (mBlackBoxEnabled) {
+            res.done = false;
+            res.info = "SVO recording is used by the black box mode";
+            return false;
+        }
+
         if (!mRecording) {
             res.done = false;
             res.info = "Recording was not active";
             return false;
         }
 
-        mZed.disableRecording();
-        mRecording = false;
+        stopSvoRecording();
         res.info = "Recording stopped";
         res.done = true;
 
@@ -3046,4 +4723,48 @@ namespace zed_wrapper {
         return false;
 #endif
     }
+
+    bool ZEDWrapperNodelet::on_set_tracing(zed_wrapper::set_tracing::Request& req,
+                                           zed_wrapper::set_tracing::Response& res) {
+        if (req.enable) {
+            if (mTracer.isEnabled()) {
+                res.result = false;
+                res.info = "Tracing was already active";
+                return false;
+            }
+
+            mTracer.setEnabled(true);
+            res.result = true;
+            res.info = "Tracing started";
+
+            ROS_INFO_STREAM("Latency tracing STARTED");
+
+            return true;
+        }
+
+        if (!mTracer.isEnabled()) {
+            res.result = false;
+            res.info = "Tracing was not active";
+            return false;
+        }
+
+        mTracer.setEnabled(false);
+
+        std::string filename = req.trace_filename.empty() ? "zed_trace.json" : req.trace_filename;
+        int count = mTracer.saveChromeTrace(filename);
+
+        if (count < 0) {
+            res.result = false;
+            res.info = "Error saving trace file: " + filename;
+            ROS_WARN_STREAM("Error saving trace file: " << filename);
+            return false;
+        }
+
+        res.result = true;
+        res.info = std::to_string(count) + " events saved in " + filename;
+
+        ROS_INFO_STREAM("Latency tracing STOPPED: " << res.info);
+
+        return true;
+    }
 } // namespace
@@ -0,0 +1,137 @@
+#ifndef SL_ELEVATION_H
+#define SL_ELEVATION_H
+
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <sensor_msgs/PointCloud2.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sl_tools {
+
+    /*!
+     * \brief The CElevationMap class fuses depth maps in a rolling 2.5D grid
+     * centered on the robot.
+     * Each cell stores the minimum, maximum and mean height of the points
+     * fused in it. The grid is a ring buffer in both directions: when the
+     * robot moves only the rows and the columns leaving the map are cleared.
+     * The points of each row of the depth map are projected with branch free
+     * loops vectorized by the compiler, then accumulated in the cells.
+     * The class is not thread safe.
+     */
+    class CElevationMap {
+      public:
+        CElevationMap();
+
+        /*!
+         * \brief setParams
+         * Set the parameters and clear the map
+         * \param resolution size of a cell [m]
+         * \param size size of the side of the map [m]
+         * \param pixelStride only one pixel every `pixelStride` rows and columns is fused
+         * \param maxRange maximum depth of the fused points [m]
+         * \param maxHeight maximum height of the fused points over the robot [m]
+         */
+        void setParams(float resolution, float size, int pixelStride, float maxRange, float maxHeight);
+
+        /*!
+         * \brief clear
+         * Remove all the fused points (e.g. after an odometry reset)
+         */
+        void clear();
+
+        /*!
+         * \brief fuse
+         * Move the map to the robot position and fuse a depth map
+         * \param depth first pixel of the depth map [m]
+         * \param step size of a row of the depth map [bytes]
+         * \param width width of the depth map
+         * \param height height of the depth map
+         * \param fx focal length X [pixels]
+         * \param fy focal length Y [pixels]
+         * \param cx principal point X [pixels]
+         * \param cy principal point Y [pixels]
+         * \param transf transform from the (not optical) camera frame to the
+         * map frame, row major 3x4 matrix (rotation | translation)
+         * \param robotX position X of the robot in the map frame [m]
+         * \param robotY position Y of the robot in the map frame [m]
+         * \param robotZ position Z of the robot in the map frame [m]
+         */
+        void fuse(const float* depth, size_t step, int width, int height, float fx, float fy, float cx, float cy,
+                  const float transf[12], float robotX, float robotY, float robotZ);
+
+        /*!
+         * \brief fillCloud
+         * Fill a point cloud with a point for each observed cell: fields `x`,
+         * `y` (center of the cell), `z` (mean height), `min_z` and `max_z`
+         * \param cloud the point cloud: the header is not modified
+         */
+        void fillCloud(sensor_msgs::PointCloud2& cloud) const;
+
+      private:
+        struct Cell {
+            float minZ;
+            float maxZ;
+            float sumZ;
+            uint32_t count;
+        };
+
+        void moveTo(float robotX, float robotY);
+        void clearColumn(int col);
+        void clearRow(int row);
+
+        Cell* cell(int gx, int gy) {
+            return &mCells[wrap(gy) * mSize + wrap(gx)];   ///< Cell of the global indices
+        }
+
+        int wrap(int g) const {
+            int m = g % mSize;
+            return m < 0 ? m + mSize : m;
+        }
+
+        float mResolution;
+        int mSize; ///< Number of cells of the side of the map
+        int mPixelStride;
+        float mMaxRange;
+        float mMaxHeight;
+
+        std::vector<Cell> mCells;
+        bool mPlaced; ///< The map origin has been set
+        int mOriginX; ///< Global index of the first column of the map
+        int mOriginY; ///< Global index of the first row of the map
+
+        // Per column ray factors, valid for the size and intrinsics below
+        int mTableWidth;
+        float mTableFx;
+        float mTableCx;
+        std::vector<float> mColRay;
+
+        // Row buffers
+        std::vector<float> mRowDepth;
+        std::vector<float> mRowX;
+        std::vector<float> mRowY;
+        std::vector<float> mRowZ;
+    };
+
+} // namespace sl_tools
+
+#endif // SL_ELEVATION_H
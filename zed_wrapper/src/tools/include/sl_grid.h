@@ -0,0 +1,86 @@
+#ifndef SL_GRID_H
+#define SL_GRID_H
+
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <nav_msgs/OccupancyGrid.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sl_tools {
+
+    /*!
+     * \brief The CObstacleGrid class projects an organized point cloud on a
+     * 2D occupancy grid centered on the robot.
+     * The points are transformed in the robot frame and classified by height:
+     * - a cell is occupied (100) if it contains at least `minPoints` points
+     *   between `minHeight` and `maxHeight`
+     * - a cell is free (0) if it contains only points lower than `minHeight`
+     *   (the ground is visible)
+     * - the other cells are unknown (-1)
+     * The rows of the cloud are processed in parallel with OpenMP, each thread
+     * counting in its own grid.
+     */
+    class CObstacleGrid {
+      public:
+        CObstacleGrid();
+
+        /*!
+         * \brief setParams
+         * \param resolution size of a cell [m]
+         * \param size size of the side of the grid [m]
+         * \param minHeight minimum height of an obstacle [m]
+         * \param maxHeight maximum height of an obstacle [m]
+         * \param minPoints minimum number of points of an occupied cell
+         */
+        void setParams(float resolution, float size, float minHeight, float maxHeight, int minPoints);
+
+        /*!
+         * \brief update
+         * Fill the grid with the points of the cloud
+         * \param cloud first point of the cloud (X,Y,Z,color) [m]
+         * \param step size of a row of the cloud [bytes]
+         * \param width width of the cloud
+         * \param height height of the cloud
+         * \param transf transform from the cloud frame to the robot frame,
+         * row major 3x4 matrix (rotation | translation)
+         * \param grid the resulting grid: the header is not modified
+         * \param threads number of OpenMP threads (0: OpenMP default)
+         */
+        void update(const float* cloud, size_t step, int width, int height,
+                    const float transf[12], nav_msgs::OccupancyGrid& grid, int threads = 0);
+
+      private:
+        float mResolution;
+        int mCells; ///< Number of cells of the side of the grid
+        float mMinHeight;
+        float mMaxHeight;
+        int mMinPoints;
+
+        // Per thread counters of the points of each cell
+        std::vector<std::vector<uint16_t>> mObstacleCounts;
+        std::vector<std::vector<uint8_t>> mGroundSeen;
+    };
+
+} // namespace sl_tools
+
+#endif // SL_GRID_H
@@ -0,0 +1,58 @@
+#ifndef SL_JPEG_H
+#define SL_JPEG_H
+
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sl_tools {
+
+    /*!
+     * \brief Format string of the `sensor_msgs/CompressedImage` messages
+     * containing an image encoded by \ref encodeJpegBGRA, as expected by
+     * the `compressed` plugin of `image_transport`
+     */
+    const char* const JPEG_FORMAT = "bgr8; jpeg compressed bgr8";
+
+    /*!
+     * \brief encodeJpegBGRA
+     * Compress a BGRA image (e.g. a sl::MAT_TYPE_8U_C4 image) in a baseline
+     * JPEG, without any intermediate color conversion.
+     * The image is split in stripes of rows encoded in parallel (OpenMP),
+     * then the stripes are joined in a single scan separated by restart
+     * markers: the result is a standard JPEG readable by any decoder.
+     * \param bgra first pixel of the image
+     * \param step size of a row of the image [bytes]
+     * \param width width of the image
+     * \param height height of the image
+     * \param quality JPEG quality [1,100]
+     * \param out the encoded data
+     * \param threads number of OpenMP threads, one stripe each (0: OpenMP default)
+     * \return true if successful
+     */
+    bool encodeJpegBGRA(const uint8_t* bgra, size_t step, int width, int height, int quality,
+                        std::vector<uint8_t>& out, int threads = 0);
+
+} // namespace sl_tools
+
+#endif // SL_JPEG_H
@@ -0,0 +1,196 @@
+#ifndef SL_METRICS_H
+#define SL_METRICS_H
+
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_tools.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace sl_tools {
+
+    /*!
+     * \brief The CPublishCounter class counts the messages and the bytes
+     * published on a topic and the data that was not published. It can be
+     * updated from any thread without locking.
+     */
+    class CPublishCounter {
+      public:
+        CPublishCounter() : mMsgs(0), mBytes(0), mSkipped(0), mSuperseded(0) {}
+
+        /*!
+         * \brief addMessage
+         * \param bytes serialized size of the published message
+         */
+        void addMessage(uint64_t bytes) {
+            mMsgs.fetch_add(1, std::memory_order_relaxed);
+            mBytes.fetch_add(bytes, std::memory_order_relaxed);
+        }
+
+        /*!
+         * \brief addSkipped
+         * Count data that was not published because the publisher was busy
+         * \param count : the number of skipped messages
+         */
+        void addSkipped(uint64_t count = 1) {
+            mSkipped.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        /*!
+         * \brief addSuperseded
+         * Count data that was replaced by newer data before being published
+         */
+        void addSuperseded() {
+            mSuperseded.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        uint64_t getMsgCount() const {
+            return mMsgs.load(std::memory_order_relaxed);   ///< Return the number of published messages
+        }
+
+        uint64_t getByteCount() const {
+            return mBytes.load(std::memory_order_relaxed);   ///< Return the number of published bytes
+        }
+
+        uint64_t getSkippedCount() const {
+            return mSkipped.load(std::memory_order_relaxed);   ///< Return the number of skipped messages
+        }
+
+        uint64_t getSupersededCount() const {
+            return mSuperseded.load(std::memory_order_relaxed);   ///< Return the number of superseded messages
+        }
+
+      private:
+        std::atomic<uint64_t> mMsgs;
+        std::atomic<uint64_t> mBytes;
+        std::atomic<uint64_t> mSkipped;
+        std::atomic<uint64_t> mSuperseded;
+    };
+
+    /*!
+     * \brief The CMetricsWriter class builds a text page in the Prometheus
+     * exposition format (https://prometheus.io/docs/instrumenting/exposition_formats/)
+     */
+    class CMetricsWriter {
+      public:
+        /*!
+         * \brief CMetricsWriter
+         * \param labels : labels added to every sample, e.g. `camera="zed_node"`
+         */
+        CMetricsWriter(const std::string& labels = "") : mCommonLabels(labels) {
+            mOut.precision(15); // Counters must not be written in exponential format
+        }
+
+        /*!
+         * \brief addCounter
+         * Add a monotonic counter
+         * \param name : the name of the metric
+         * \param help : the description of the metric
+         * \param value : the value of the counter
+         * \param labels : optional labels, e.g. `topic="/zed/rgb"`
+         */
+        void addCounter(const std::string& name, const std::string& help, double value,
+                        const std::string& labels = "");
+
+        /*!
+         * \brief addGauge
+         * Add a value that can go up and down
+         */
+        void addGauge(const std::string& name, const std::string& help, double value,
+                      const std::string& labels = "");
+
+        /*!
+         * \brief addSummary
+         * Add the p50/p95/p99 quantiles, the sum and the count of a histogram
+         * \param scale : factor applied to the values of the histogram (e.g. unit conversion)
+         */
+        void addSummary(const std::string& name, const std::string& help,
+                        const CLatencyHistogram& hist, double scale = 1.0);
+
+        std::string str() const {
+            return mOut.str();   ///< Return the page
+        }
+
+      private:
+        void addHeader(const std::string& name, const std::string& help, const char* type);
+        void addSample(const std::string& name, const std::string& labels, double value);
+
+        std::ostringstream mOut;
+        std::string mCommonLabels;
+        std::string mLastName; ///< HELP and TYPE are written only once for each metric
+    };
+
+    /*!
+     * \brief The CMetricsServer class is a minimal HTTP server that replies to
+     * any request with the page generated by a callback. It serves a single
+     * client at a time from its own thread, that is enough to be scraped by
+     * a monitoring system.
+     */
+    class CMetricsServer {
+      public:
+        typedef std::function<std::string()> PageCallback;
+
+        CMetricsServer();
+        ~CMetricsServer();
+
+        /*!
+         * \brief start
+         * Start listening. A client that does not send its request within
+         * \ref READ_TIMEOUT_MSEC or does not read the reply within
+         * \ref SEND_TIMEOUT_MSEC is dropped, so that it cannot block \ref stop
+         * \param address : the IPv4 address to bind (e.g. `127.0.0.1`)
+         * \param port : the TCP port
+         * \param cb : the function called to generate the page for each request
+         * \return false if the socket cannot be opened
+         */
+        bool start(const std::string& address, int port, PageCallback cb);
+
+        /*!
+         * \brief stop
+         * Stop listening and wait for the server thread to finish
+         */
+        void stop();
+
+        bool isRunning() const {
+            return mRunning;   ///< Return true if the server is listening
+        }
+
+      private:
+        static const int SEND_TIMEOUT_MSEC = 1000;
+        static const int READ_TIMEOUT_MSEC = 2000; ///< Whole request header
+
+        void serverThreadFunc();
+        void serveClient(int fd);
+
+        int mSocket;
+        std::atomic<bool> mRunning;
+        std::thread mThread;
+        PageCallback mCallback;
+    };
+
+} // namespace sl_tools
+
+#endif // SL_METRICS_H
@@ -0,0 +1,70 @@
+#ifndef SL_NORMALS_H
+#define SL_NORMALS_H
+
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <cstddef>
+#include <vector>
+
+namespace sl_tools {
+
+    /*!
+     * \brief The CNormalEstimator class computes the surface normals of an
+     * organized point cloud.
+     * The cloud is smoothed with a box filter of side `2 * radius + 1` over
+     * the valid points (separable sums, equivalent to integral image
+     * lookups), then the normal of each point is the cross product of the
+     * smoothed horizontal and vertical gradients, oriented toward the camera.
+     * Each pass is parallelized over the rows with OpenMP.
+     */
+    class CNormalEstimator {
+      public:
+        CNormalEstimator();
+
+        /*!
+         * \brief setParams
+         * \param radius half size of the smoothing window and distance of the
+         * points used for the gradients [pixels]
+         */
+        void setParams(int radius);
+
+        /*!
+         * \brief compute
+         * \param cloud first point of the cloud (X,Y,Z,color) [m]
+         * \param step size of a row of the cloud [bytes]
+         * \param width width of the cloud
+         * \param height height of the cloud
+         * \param normals destination of the normals (X,Y,Z for each point,
+         * `3 * width * height` floats), NaN if the normal cannot be computed
+         * \param threads number of OpenMP threads (0: OpenMP default)
+         */
+        void compute(const float* cloud, size_t step, int width, int height, float* normals, int threads = 0);
+
+      private:
+        int mRadius;
+
+        std::vector<float> mRowSums; ///< Horizontal sums (X,Y,Z,count)
+        std::vector<float> mMeans;   ///< Smoothed points (X,Y,Z)
+    };
+
+} // namespace sl_tools
+
+#endif // SL_NORMALS_H
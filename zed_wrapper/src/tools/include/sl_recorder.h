@@ -0,0 +1,258 @@
+#ifndef SL_RECORDER_H
+#define SL_RECORDER_H
+
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sl_tools {
+
+    /*!
+     * \brief A data stream stored by \ref CChunkRecorder
+     */
+    struct RecChannel {
+        uint16_t id;          ///< Identifier used by the records
+        std::string name;     ///< Name of the stream (e.g. the topic name)
+        std::string datatype; ///< Type of the data (e.g. the ROS message type)
+    };
+
+    /*!
+     * \brief A single record read by \ref CChunkReader
+     */
+    struct RecRecord {
+        uint16_t channel;     ///< \ref RecChannel identifier
+        int64_t stampNsec;    ///< Timestamp of the data [nsec]
+        const uint8_t* data;  ///< Data, valid until the next call of \ref CChunkReader::next
+        uint32_t size;        ///< Size of the data [bytes]
+    };
+
+    /*!
+     * \brief The CChunkRecorder class writes timestamped records in an
+     * append-only file made of independent chunks.
+     * Records are appended to an in-memory chunk by the calling thread (a copy,
+     * no I/O); full chunks are compressed (zlib) and written by a background
+     * thread. A time index of the chunks is appended when the file is closed;
+     * files not closed correctly can still be read sequentially.
+     *
+     * File layout (native endianness):
+     *  - header: `ZEDREC01`, uint32 channel count, for each channel
+     *    uint16 id, uint16 name length, name, uint16 type length, type
+     *  - chunks: `CHNK`, uint32 compression (0: none, 1: zlib), uint32 raw size,
+     *    uint32 stored size, uint32 record count, int64 first stamp, int64 last stamp,
+     *    stored data. Each raw record is uint16 channel, int64 stamp, uint32 size, data
+     *  - index: `INDX`, uint32 chunk count, for each chunk uint64 offset,
+     *    int64 first stamp, int64 last stamp
+     *  - footer: uint64 index offset, `ZEDRECND`
+     */
+    class CChunkRecorder {
+      public:
+        CChunkRecorder();
+        ~CChunkRecorder();
+
+        /*!
+         * \brief open
+         * Create the file and start the writer thread
+         * \param filename : the path of the file
+         * \param channels : the streams that will be recorded
+         * \param chunkSize : size of the uncompressed chunks [bytes]
+         * \param compress : true to compress the chunks
+         * \return false if the file cannot be created
+         */
+        bool open(const std::string& filename, const std::vector<RecChannel>& channels,
+                  size_t chunkSize = 4 * 1024 * 1024, bool compress = true);
+
+        /*!
+         * \brief close
+         * Write the pending chunks and the index, then close the file
+         */
+        void close();
+
+        bool isOpen() const {
+            return mOpen;   ///< Return true if the file is open
+        }
+
+        /*!
+         * \brief write
+         * Append a record to the current chunk. Thread safe.
+         * \param channel : the \ref RecChannel identifier
+         * \param stampNsec : the timestamp of the data [nsec]
+         * \param data : the data
+         * \param size : the size of the data [bytes]
+         */
+        void write(uint16_t channel, int64_t stampNsec, const uint8_t* data, uint32_t size);
+
+        /*!
+         * \brief write
+         * Append a record to the current chunk, letting the caller fill the data in
+         * place (e.g. to serialize a message without an intermediate copy). Thread safe.
+         * \param channel : the \ref RecChannel identifier
+         * \param stampNsec : the timestamp of the data [nsec]
+         * \param size : the size of the data [bytes]
+         * \param fill : a callable `void(uint8_t* dst)` writing exactly `size` bytes
+         */
+        template <typename F>
+        void write(uint16_t channel, int64_t stampNsec, uint32_t size, F fill) {
+            if (!mOpen) {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(mBufMutex);
+
+            uint8_t* dst = appendRecord(channel, stampNsec, size);
+
+            if (dst) {
+                fill(dst);
+                chunkCheck();
+            }
+        }
+
+        uint64_t getWrittenBytes() const {
+            return mWrittenBytes;   ///< Return the number of bytes written to disk
+        }
+
+        uint64_t getDroppedChunks() const {
+            return mDroppedChunks;   ///< Return the number of chunks lost because the disk was too slow or full
+        }
+
+      private:
+        struct Chunk {
+            std::vector<uint8_t> data;
+            uint32_t records = 0;
+            int64_t start = 0;
+            int64_t end = 0;
+        };
+
+        struct IndexEntry {
+            uint64_t offset;
+            int64_t start;
+            int64_t end;
+        };
+
+        uint8_t* appendRecord(uint16_t channel, int64_t stampNsec, uint32_t size); ///< mBufMutex must be locked
+        void chunkCheck(); ///< mBufMutex must be locked
+        void queueChunk(); ///< mBufMutex must be locked
+        void writerThreadFunc();
+        void writeChunk(const Chunk& chunk);
+
+        FILE* mFile;
+        std::atomic<bool> mOpen;
+        bool mCompress;
+        size_t mChunkSize;
+
+        std::mutex mBufMutex;
+        std::condition_variable mBufCondVar;
+        Chunk mCurrent;
+        std::deque<Chunk> mQueue; ///< Full chunks waiting to be written
+        bool mStopWriter;
+        std::thread mWriterThread;
+
+        std::vector<IndexEntry> mIndex;
+        std::atomic<uint64_t> mWrittenBytes;
+        std::atomic<uint64_t> mDroppedChunks;
+        bool mWriteFailed; ///< The file position is lost: no more chunks are written (writer thread only)
+    };
+
+    /*!
+     * \brief The CChunkReader class reads the files written by \ref CChunkRecorder.
+     * The file is memory mapped and only the current chunk is decompressed.
+     */
+    class CChunkReader {
+      public:
+        CChunkReader();
+        ~CChunkReader();
+
+        /*!
+         * \brief open
+         * \param filename : the path of the file
+         * \return false if the file cannot be opened or is not valid
+         */
+        bool open(const std::string& filename);
+
+        void close();
+
+        const std::vector<RecChannel>& getChannels() const {
+            return mChannels;   ///< Return the recorded streams
+        }
+
+        size_t getChunkCount() const {
+            return mIndex.size();   ///< Return the number of chunks
+        }
+
+        bool isIndexed() const {
+            return mIndexed;   ///< Return false if the index was rebuilt scanning the file
+        }
+
+        int64_t getStartTime() const; ///< Return the timestamp of the first record [nsec]
+        int64_t getEndTime() const;   ///< Return the timestamp of the last record [nsec]
+
+        /*!
+         * \brief seek
+         * Move to the first chunk containing records not older than a timestamp
+         * \param stampNsec : the timestamp [nsec]
+         * \return false if all the records are older
+         */
+        bool seek(int64_t stampNsec);
+
+        /*!
+         * \brief next
+         * Read the next record
+         * \param rec : the record
+         * \return false at the end of the file
+         */
+        bool next(RecRecord& rec);
+
+      private:
+        struct IndexEntry {
+            uint64_t offset;
+            int64_t start;
+            int64_t end;
+        };
+
+        bool loadChunk(size_t idx);
+        bool readIndex();
+        void scanChunks();
+
+        const uint8_t* mMap;
+        size_t mMapSize;
+        size_t mDataOffset; ///< Offset of the first chunk
+
+        std::vector<RecChannel> mChannels;
+        std::vector<IndexEntry> mIndex;
+        bool mIndexed;
+
+        size_t mChunkIdx;           ///< Index of the next chunk to be loaded
+        std::vector<uint8_t> mRaw;  ///< Decompressed data of the current chunk
+        const uint8_t* mRawData;    ///< Raw data of the current chunk
+        size_t mRawSize;
+        size_t mRawPos;
+    };
+
+} // namespace sl_tools
+
+#endif // SL_RECORDER_H
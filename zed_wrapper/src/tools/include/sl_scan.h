@@ -0,0 +1,93 @@
+#ifndef SL_SCAN_H
+#define SL_SCAN_H
+
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <sensor_msgs/LaserScan.h>
+#include <cstddef>
+#include <vector>
+
+namespace sl_tools {
+
+    /*!
+     * \brief The CDepthToScan class converts a horizontal band of a depth map
+     * in a planar laser scan.
+     * Only the rows of the band are read: the minimum depth of each column is
+     * computed with a SIMD reduction over the rows, then converted to a range
+     * with per column factors cached for the current image size.
+     * The scan lies in the plane X-Y of the (not optical) camera frame.
+     */
+    class CDepthToScan {
+      public:
+        CDepthToScan();
+
+        /*!
+         * \brief setParams
+         * \param scanHeight number of rows of the band
+         * \param rowOffset offset of the center of the band from the principal
+         * point [rows, positive down]
+         * \param rangeMin minimum valid range [m]
+         * \param rangeMax maximum valid range [m]
+         * \param angleIncrement angular resolution of the scan [rad]
+         * (`0` for one ray per column at the center of the image)
+         */
+        void setParams(int scanHeight, int rowOffset, float rangeMin, float rangeMax, float angleIncrement);
+
+        /*!
+         * \brief convert
+         * \param depth first pixel of the depth map [m]
+         * \param step size of a row of the depth map [bytes]
+         * \param width width of the depth map
+         * \param height height of the depth map
+         * \param fx focal length of the depth map [pixels]
+         * \param cx principal point X [pixels]
+         * \param cy principal point Y [pixels]
+         * \param scan the resulting scan: the header is not modified
+         */
+        void convert(const float* depth, size_t step, int width, int height,
+                     float fx, float cx, float cy, sensor_msgs::LaserScan& scan);
+
+      private:
+        void updateTables(int width, float fx, float cx);
+
+        int mScanHeight;
+        int mRowOffset;
+        float mRangeMin;
+        float mRangeMax;
+        float mAngleIncrement;
+
+        // Per column tables, valid for the size and intrinsics below
+        int mTableWidth;
+        float mTableFx;
+        float mTableCx;
+        float mAngleMin;
+        float mAngleStep;
+        size_t mRayCount;
+        std::vector<int> mColRay;       ///< Ray of each column
+        std::vector<float> mColFactor;  ///< Range / depth of each column
+        std::vector<float> mColMinDepth; ///< Depth corresponding to the minimum range
+
+        std::vector<float> mColDepth;   ///< Minimum depth of each column in the band
+    };
+
+} // namespace sl_tools
+
+#endif // SL_SCAN_H
@@ -0,0 +1,119 @@
+#ifndef SL_SYNC_H
+#define SL_SYNC_H
+
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sl_tools {
+
+    /*!
+     * \brief Result of \ref CFrameSynchronizer::addFrame
+     */
+    struct SyncResult {
+        uint64_t bundleId;  ///< Identifier of the bundle the frame belongs to
+        int64_t stampNsec;  ///< Common timestamp of the bundle [nsec]
+        int64_t skewNsec;   ///< Difference between the newest and the oldest frame of the bundle [nsec]
+        int members;        ///< Number of cameras in the bundle when the call returned
+        int expected;       ///< Number of active cameras
+        bool complete;      ///< True if all the active cameras are in the bundle
+    };
+
+    /*!
+     * \brief The CFrameSynchronizer class groups the frames of multiple cameras
+     * grabbed by different threads of the same process.
+     * Frames whose timestamps are within a tolerance of the first frame of a
+     * bundle join that bundle; each grabbing thread waits (for a limited time)
+     * for the frames of the other cameras, so all the cameras can publish
+     * their data with the common timestamp of the bundle.
+     * Cameras that do not provide frames for more than one second are not
+     * waited for.
+     */
+    class CFrameSynchronizer {
+      public:
+        /*!
+         * \brief CFrameSynchronizer
+         * \param toleranceNsec maximum difference between the timestamps of the frames of a bundle
+         */
+        CFrameSynchronizer(int64_t toleranceNsec);
+
+        /*!
+         * \brief addCamera
+         * Register a camera
+         * \return the identifier of the camera
+         */
+        int addCamera(const std::string& name);
+
+        /*!
+         * \brief removeCamera
+         * Unregister a camera: its frames are not waited for anymore
+         */
+        void removeCamera(int id);
+
+        /*!
+         * \brief addFrame
+         * Add a frame to its bundle and wait for the frames of the other cameras
+         * \param id camera identifier returned by \ref addCamera
+         * \param stampNsec timestamp of the frame [nsec]
+         * \param maxWaitNsec maximum waiting time for the other cameras [nsec]
+         * \return the bundle of the frame
+         */
+        SyncResult addFrame(int id, int64_t stampNsec, int64_t maxWaitNsec);
+
+        int64_t getTolerance() const {
+            return mTolerance;   ///< Return the tolerance [nsec]
+        }
+
+      private:
+        struct Camera {
+            std::string name;
+            bool active;
+            std::chrono::steady_clock::time_point lastFrame;
+        };
+
+        struct Bundle {
+            uint64_t id;
+            int64_t refStamp;              ///< Timestamp of the first frame
+            int64_t minStamp;
+            int64_t maxStamp;
+            std::vector<int> cameras;      ///< Cameras that added a frame
+        };
+
+        int expectedCameras(std::chrono::steady_clock::time_point now) const; ///< mMutex must be locked
+        Bundle* findBundle(uint64_t id);
+
+        int64_t mTolerance;
+        std::mutex mMutex;
+        std::condition_variable mCondVar;
+        std::vector<Camera> mCameras;
+        std::deque<Bundle> mBundles; ///< Most recent bundles
+        uint64_t mNextBundleId;
+    };
+
+} // namespace sl_tools
+
+#endif // SL_SYNC_H
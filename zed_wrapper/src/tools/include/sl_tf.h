@@ -0,0 +1,66 @@
+#ifndef SL_TF_H
+#define SL_TF_H
+
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <geometry_msgs/TransformStamped.h>
+#include <ros/time.h>
+#include <tf2/LinearMath/Transform.h>
+
+#include <string>
+#include <vector>
+
+namespace sl_tools {
+
+    /*!
+     * \brief transformToROSmsg
+     * Convert a tf2 transformation to a TF message
+     * \param transf the transformation of the child frame in the parent frame
+     * \param parentFrameId the id of the parent frame
+     * \param childFrameId the id of the child frame
+     * \param t the ros::Time to stamp the transformation
+     * \return the TF message
+     */
+    geometry_msgs::TransformStamped transformToROSmsg(const tf2::Transform& transf, const std::string& parentFrameId,
+            const std::string& childFrameId, ros::Time t);
+
+    /*!
+     * \brief frameTransforms
+     * Build the dynamic transforms of a grabbed frame, to be broadcasted with
+     * a single `tf2_msgs/TFMessage`: the base frame in the odometry frame,
+     * then, if requested, the odometry frame in the map frame.
+     * \param odom2base the pose of the base frame in the odometry frame
+     * \param map2odom the pose of the odometry frame in the map frame
+     * \param publishMapTf true to add the map to odometry transform
+     * \param mapFrameId the id of the map frame
+     * \param odomFrameId the id of the odometry frame
+     * \param baseFrameId the id of the base frame
+     * \param t the ros::Time to stamp the transformations
+     * \return the transforms of the frame
+     */
+    std::vector<geometry_msgs::TransformStamped> frameTransforms(const tf2::Transform& odom2base,
+            const tf2::Transform& map2odom, bool publishMapTf,
+            const std::string& mapFrameId, const std::string& odomFrameId,
+            const std::string& baseFrameId, ros::Time t);
+
+} // namespace sl_tools
+
+#endif // SL_TF_H
@@ -24,7 +24,17 @@
 #include <ros/time.h>
 #include <sensor_msgs/Image.h>
 #include <sl/Camera.hpp>
+#include <tf2/LinearMath/Transform.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace sl_tools {
@@ -46,6 +56,24 @@ namespace sl_tools {
     */
     bool file_exist(const std::string& name);
 
+    /* \brief Get the size of a file
+    * \param name : the path to the file
+    * \return the size in bytes, 0 if the file does not exist
+    */
+    uint64_t file_size(const std::string& name);
+
+    /* \brief Create a folder and all its missing parents
+    * \param path : the path of the folder
+    * \return true if the folder exists at the end of the call
+    */
+    bool make_dir(const std::string& path);
+
+    /* \brief Get the space available on the file system containing a path
+    * \param path : a file or folder path
+    * \return the available space in bytes, 0 on error
+    */
+    uint64_t free_disk_space(const std::string& path);
+
     /* \brief Get Stereolabs SDK version
      * \param major : major value for version
      * \param minor : minor value for version
@@ -114,6 +142,383 @@ namespace sl_tools {
         double mGamma; ///< Weight value
     };
 
+    /*!
+     * \brief The CLatencyHistogram class records a sequence of non negative
+     * integer values (e.g. periods in usec) in log-linear buckets, in the style
+     * of HdrHistogram: values are stored with a relative error lower than
+     * 1/\ref SUB_BUCKETS, using a fixed amount of memory.
+     * Values can be added from any thread without locking, statistics can be
+     * read concurrently.
+     */
+    class CLatencyHistogram {
+      public:
+        CLatencyHistogram();
+
+        /*!
+         * \brief addValue
+         * Add a value to the histogram. Negative values are stored as 0.
+         * \param val value to be added
+         */
+        void addValue(int64_t val);
+
+        /*!
+         * \brief reset
+         * Remove all the recorded values
+         */
+        void reset();
+
+        uint64_t getValCount() const {
+            return mCount.load(std::memory_order_relaxed);   ///< Return the number of recorded values
+        }
+
+        int64_t getMax() const {
+            return mMax.load(std::memory_order_relaxed);   ///< Return the maximum recorded value
+        }
+
+        /*!
+         * \brief getMean
+         * \return the mean of the recorded values, 0 if the histogram is empty
+         */
+        double getMean() const;
+
+        /*!
+         * \brief getPercentile
+         * \param perc percentile in the range [0,100]
+         * \return the highest value equivalent to the requested percentile,
+         * 0 if the histogram is empty
+         */
+        int64_t getPercentile(double perc) const;
+
+      private:
+        friend class CLatencyWindow;
+
+        static const int SUB_BUCKET_BITS = 5;
+        static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+        static const int MAX_SHIFT = 40 - SUB_BUCKET_BITS; ///< Values up to 2^40 are recorded
+        static const int BUCKET_COUNT = (MAX_SHIFT + 2) * SUB_BUCKETS;
+
+        static int bucketIndex(uint64_t val);
+        static int64_t bucketHighest(int idx);
+        static int64_t percentile(const uint64_t* counts, double perc, int64_t max);
+
+        std::atomic<uint64_t> mBuckets[BUCKET_COUNT]; ///< Number of values in each bucket
+        std::atomic<uint64_t> mCount;                 ///< Number of recorded values
+        std::atomic<uint64_t> mSum;                   ///< Sum of the recorded values
+        std::atomic<int64_t> mMax;                    ///< Maximum recorded value
+    };
+
+    /*!
+     * \brief The CLatencyWindow class gives the statistics of the values added
+     * to a \ref CLatencyHistogram between the last two calls of \ref update
+     * (e.g. in the last diagnostic period), without resetting the histogram,
+     * that keeps the statistics of the whole run.
+     * It must be used by a single thread.
+     */
+    class CLatencyWindow {
+      public:
+        CLatencyWindow();
+
+        /*!
+         * \brief update
+         * Start a new window: the statistics refer to the values added to the
+         * histogram since the previous call
+         * \param hist the histogram that records the values
+         */
+        void update(const CLatencyHistogram& hist);
+
+        uint64_t getValCount() const {
+            return mCount;   ///< Return the number of values in the window
+        }
+
+        /*!
+         * \brief getMean
+         * \return the mean of the values in the window, 0 if the window is empty
+         */
+        double getMean() const;
+
+        /*!
+         * \brief getMax
+         * \return the maximum value in the window, with the precision of the
+         * histogram buckets. 0 if the window is empty
+         */
+        int64_t getMax() const {
+            return mMax;
+        }
+
+        /*!
+         * \brief getPercentile
+         * \param perc percentile in the range [0,100]
+         * \return the highest value equivalent to the requested percentile,
+         * 0 if the window is empty
+         */
+        int64_t getPercentile(double perc) const;
+
+      private:
+        std::vector<uint64_t> mPrevBuckets; ///< Histogram counts at the start of the window
+        std::vector<uint64_t> mBuckets;     ///< Number of values of the window in each bucket
+        uint64_t mPrevSum;
+        uint64_t mPrevCount;
+        uint64_t mCount;
+        uint64_t mSum;
+        int64_t mMax;
+    };
+
+    /*!
+     * \brief The CRingBuffer class stores the last values of a sequence
+     * in a fixed capacity circular buffer. Adding a value is O(1) and the
+     * oldest value is overwritten when the buffer is full.
+     */
+    template <typename T>
+    class CRingBuffer {
+      public:
+        /*!
+         * \brief CRingBuffer
+         * \param capacity maximum number of stored values (0 for no limit)
+         */
+        CRingBuffer(size_t capacity = 0) {
+            setCapacity(capacity);
+        }
+
+        /*!
+         * \brief setCapacity
+         * Clear the buffer and set its maximum size
+         * \param capacity maximum number of stored values (0 for no limit)
+         */
+        void setCapacity(size_t capacity) {
+            mCapacity = capacity;
+            clear();
+
+            if (mCapacity > 0) {
+                mData.reserve(mCapacity);
+            }
+        }
+
+        size_t getCapacity() const {
+            return mCapacity;   ///< Return the maximum size of the buffer (0 for no limit)
+        }
+
+        size_t size() const {
+            return mData.size();   ///< Return the number of stored values
+        }
+
+        bool empty() const {
+            return mData.empty();   ///< Return true if the buffer does not contain any value
+        }
+
+        void clear() {
+            mData.clear();
+            mHead = 0;
+        }
+
+        /*!
+         * \brief push
+         * Add a value to the sequence, replacing the oldest one if the buffer is full
+         * \param val value to be added
+         */
+        void push(const T& val) {
+            if (mCapacity == 0 || mData.size() < mCapacity) {
+                mData.push_back(val);
+            } else {
+                mData[mHead] = val;
+                mHead = (mHead + 1) % mCapacity;
+            }
+        }
+
+        /*!
+         * \brief back
+         * \return the newest value of the sequence. The buffer must not be empty.
+         */
+        const T& back() const {
+            return mData[(mHead + mData.size() - 1) % mData.size()];
+        }
+
+        /*!
+         * \brief copyTo
+         * Copy the stored values, from the oldest to the newest
+         * \param out destination vector, resized to \ref size
+         */
+        void copyTo(std::vector<T>& out) const {
+            out.resize(mData.size());
+            std::copy(mData.begin() + mHead, mData.end(), out.begin());
+            std::copy(mData.begin(), mData.begin() + mHead, out.begin() + (mData.size() - mHead));
+        }
+
+      private:
+        std::vector<T> mData; ///< Stored values
+        size_t mCapacity;     ///< Maximum number of values
+        size_t mHead = 0;     ///< Index of the oldest value when the buffer is full
+    };
+
+    /*!
+     * \brief The CWorkerPool class runs jobs on a fixed set of threads.
+     * Jobs are executed in submission order; a job must not block waiting
+     * for another job of the same pool.
+     */
+    class CWorkerPool {
+      public:
+        /*!
+         * \brief CWorkerPool
+         * \param threads number of worker threads (at least 1)
+         */
+        CWorkerPool(unsigned int threads);
+
+        /*!
+         * \brief ~CWorkerPool
+         * Run the queued jobs and stop the worker threads
+         */
+        ~CWorkerPool();
+
+        /*!
+         * \brief post
+         * Queue a job, executed by the first free worker thread
+         * \param job the function to be executed
+         */
+        void post(std::function<void()> job);
+
+        unsigned int getThreadCount() const {
+            return static_cast<unsigned int>(mThreads.size());   ///< Return the number of worker threads
+        }
+
+        /*!
+         * \brief getQueueSize
+         * \return the number of jobs waiting for a free worker
+         */
+        size_t getQueueSize();
+
+      private:
+        void workerFunc();
+
+        std::vector<std::thread> mThreads;
+        std::deque<std::function<void()>> mJobs;
+        std::mutex mJobsMutex;
+        std::condition_variable mJobsCondVar;
+        bool mStop;
+    };
+
+    /*!
+     * \brief The CThreadBudget class shares a number of threads among the
+     * OpenMP parallel regions started by different threads of the process
+     * (e.g. the grabbing threads of several cameras and the worker pool jobs),
+     * so that together they do not start more threads than the cores.
+     */
+    class CThreadBudget {
+      public:
+        /*!
+         * \brief CThreadBudget
+         * \param threads number of threads shared by the parallel regions
+         */
+        CThreadBudget(int threads);
+
+        /*!
+         * \brief acquire
+         * Take threads from the budget, to be given back with \ref release
+         * \param wanted number of threads wanted
+         * \return the number of threads taken, between 0 and `wanted`
+         */
+        int acquire(int wanted);
+
+        /*!
+         * \brief release
+         * \param threads number of threads returned by \ref acquire
+         */
+        void release(int threads);
+
+        int getThreadCount() const {
+            return mThreads;   ///< Return the size of the budget
+        }
+
+      private:
+        const int mThreads;
+        std::atomic<int> mAvailable;
+    };
+
+    /*!
+     * \brief The CThreadLease class takes threads from a \ref CThreadBudget
+     * for the duration of a parallel region. The calling thread always takes
+     * part in the region, so at least one thread is available even if the
+     * budget is exhausted.
+     */
+    class CThreadLease {
+      public:
+        /*!
+         * \brief CThreadLease
+         * \param budget the shared budget, nullptr to run single threaded
+         * \param wanted number of threads wanted, 0 for the whole budget
+         */
+        CThreadLease(const std::shared_ptr<CThreadBudget>& budget, int wanted = 0);
+        ~CThreadLease();
+
+        int getThreads() const {
+            return std::max(mTaken, 1);   ///< Return the number of threads of the parallel region
+        }
+
+      private:
+        CThreadLease(const CThreadLease&) = delete;
+        CThreadLease& operator=(const CThreadLease&) = delete;
+
+        std::shared_ptr<CThreadBudget> mBudget;
+        int mTaken;
+    };
+
+    /*!
+     * \brief The AxisRemap class converts vectors, quaternions and 3x3
+     * covariance matrices from the coordinate system used by the ZED SDK to the
+     * ROS one (REP 103). Axis indices and signs are template parameters, so each
+     * conversion is resolved at compile time without any branch or lookup.
+     */
+    template <int IdxX, int IdxY, int IdxZ, int SignX, int SignY, int SignZ>
+    struct AxisRemap {
+        /*!
+         * \brief X, Y and Z components of a SDK vector (or of the vector part of
+         * a SDK quaternion) in the ROS coordinate system
+         */
+        template <typename V> static inline double x(const V& v) {
+            return SignX * v[IdxX];
+        }
+        template <typename V> static inline double y(const V& v) {
+            return SignY * v[IdxY];
+        }
+        template <typename V> static inline double z(const V& v) {
+            return SignZ * v[IdxZ];
+        }
+
+        /*!
+         * \brief Permutes a row-major 3x3 SDK covariance matrix into a ROS one
+         * \param in : the 9 values of the SDK matrix
+         * \param out : the 9 values of the ROS matrix
+         * \param scale : factor applied to each element (e.g. unit conversion)
+         */
+        template <typename Out>
+        static inline void covariance(const float* in, Out& out, double scale = 1.0) {
+            out[0] = in[IdxX * 3 + IdxX] * scale;
+            out[1] = in[IdxX * 3 + IdxY] * scale;
+            out[2] = in[IdxX * 3 + IdxZ] * scale;
+            out[3] = in[IdxY * 3 + IdxX] * scale;
+            out[4] = in[IdxY * 3 + IdxY] * scale;
+            out[5] = in[IdxY * 3 + IdxZ] * scale;
+            out[6] = in[IdxZ * 3 + IdxX] * scale;
+            out[7] = in[IdxZ * 3 + IdxY] * scale;
+            out[8] = in[IdxZ * 3 + IdxZ] * scale;
+        }
+    };
+
+    typedef AxisRemap<2, 0, 1, 1, -1, -1> ImageAxisRemap;       ///< COORDINATE_SYSTEM_IMAGE
+    typedef AxisRemap<1, 0, 2, 1, -1, 1> RightHandedZUpRemap;   ///< COORDINATE_SYSTEM_RIGHT_HANDED_Z_UP
+    typedef AxisRemap<0, 1, 2, 1, 1, 1> RightHandedZUpXFwdRemap; ///< COORDINATE_SYSTEM_RIGHT_HANDED_Z_UP_X_FWD
+
+    /* \brief Pose of the camera in map (or odom) frame, composed along the same
+     *        chain broadcasted on TF: map -> odom -> base_link -> camera_center
+     * \param map2odom : odom frame in map frame
+     * \param odom2base : base frame in odom frame
+     * \param camera2base : base frame in camera frame
+     * \param mapFrame : true to return the pose in map frame, false in odom frame
+     */
+    inline tf2::Transform cameraToPoseTransform(const tf2::Transform& map2odom, const tf2::Transform& odom2base,
+            const tf2::Transform& camera2base, bool mapFrame) {
+        tf2::Transform pose2base = mapFrame ? (map2odom * odom2base) : odom2base;
+        return pose2base * camera2base.inverse();
+    }
+
 
 } // namespace sl_tools
 
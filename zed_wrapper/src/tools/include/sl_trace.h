@@ -0,0 +1,154 @@
+#ifndef SL_TRACE_H
+#define SL_TRACE_H
+
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sl_tools {
+
+    /*!
+     * \brief A single traced interval
+     */
+    struct TraceEvent {
+        const char* name; ///< Name of the stage (must be a string literal)
+        int64_t startNsec; ///< Start time [nsec, steady clock]
+        int64_t durNsec;   ///< Duration [nsec]
+        uint64_t frame;    ///< Frame that produced the elaborated data
+    };
+
+    /*!
+     * \brief The CTracer class records the duration of the elaboration
+     * stages of each frame.
+     * Each thread writes in its own circular buffer without locking, the
+     * events are exported in Chrome trace-event JSON format
+     * (chrome://tracing, https://ui.perfetto.dev).
+     * When tracing is disabled each trace point costs an atomic load.
+     * Clearing and exporting the buffers first wait for the events being
+     * written to be completed.
+     */
+    class CTracer {
+      public:
+        /*!
+         * \brief CTracer
+         * \param eventsPerThread size of the circular buffer of each thread
+         */
+        CTracer(size_t eventsPerThread = 65536);
+
+        /*!
+         * \brief setEnabled
+         * Start or stop recording. Recorded events are cleared when
+         * recording is started.
+         * Not reentrant: call it from a single control thread.
+         */
+        void setEnabled(bool enable);
+
+        bool isEnabled() const {
+            return mEnabled.load(std::memory_order_relaxed);   ///< Return true if recording
+        }
+
+        /*!
+         * \brief record
+         * Add an event to the buffer of the calling thread
+         * \param name name of the stage (must be a string literal)
+         * \param startNsec start time as returned by \ref now
+         * \param durNsec duration
+         * \param frame index of the frame that produced the elaborated data
+         */
+        void record(const char* name, int64_t startNsec, int64_t durNsec, uint64_t frame);
+
+        /*!
+         * \brief saveChromeTrace
+         * Save all the recorded events in Chrome trace-event JSON format.
+         * Events traced while saving are discarded.
+         * \param filename full path of the destination file
+         * \return the number of saved events, -1 on error
+         */
+        int saveChromeTrace(const std::string& filename) const;
+
+        /*!
+         * \brief now
+         * \return the current steady clock time [nsec]
+         */
+        static int64_t now();
+
+      private:
+        struct ThreadBuffer {
+            std::vector<TraceEvent> events;
+            std::atomic<uint64_t> count; ///< Number of events written since last clear
+            std::atomic<bool> writing;   ///< True while the owner thread is in \ref record
+            int tid;
+            std::thread::id thread;
+        };
+
+        ThreadBuffer* getThreadBuffer();
+
+        /*!
+         * \brief waitWriters
+         * Wait for the events being written to be completed.
+         * Call it with mBuffersMutex locked, after closing the gate
+         * checked by \ref record (mEnabled or mSaving).
+         */
+        void waitWriters() const;
+
+        std::atomic<bool> mEnabled;
+        mutable std::atomic<bool> mSaving; ///< Events are discarded while saving
+        size_t mEventsPerThread;
+        uint64_t mInstanceId; ///< Used to validate the per thread buffer cache
+
+        mutable std::mutex mBuffersMutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> mBuffers;
+    };
+
+    /*!
+     * \brief The CTraceScope class records the duration of its
+     * lifetime as a \ref TraceEvent
+     * The frame is passed by the caller, because events elaborated by
+     * other threads (e.g. worker pool jobs) may refer to an older frame
+     * than the last grabbed one.
+     */
+    class CTraceScope {
+      public:
+        CTraceScope(CTracer& tracer, const char* name, uint64_t frame)
+            : mTracer(tracer), mName(name), mFrame(frame), mStart(tracer.isEnabled() ? CTracer::now() : -1) {}
+
+        ~CTraceScope() {
+            if (mStart >= 0 && mTracer.isEnabled()) {
+                mTracer.record(mName, mStart, CTracer::now() - mStart, mFrame);
+            }
+        }
+
+      private:
+        CTracer& mTracer;
+        const char* mName;
+        uint64_t mFrame;
+        int64_t mStart;
+    };
+
+} // namespace sl_tools
+
+#endif // SL_TRACE_H
@@ -0,0 +1,257 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "zed_wrapper/sl_depth_codec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <zlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace sl_tools {
+
+    namespace {
+        const char CODEC_MAGIC[4] = {'Z', 'D', 'C', '1'};
+
+        const size_t CODEC_HEADER_SIZE = 4 + 4 * 4 + 4; ///< Magic, width, height, band rows, band count, quantization
+
+        const uint32_t CODEC_MAX_SIZE = 65535; ///< Maximum width, height and band rows
+
+        const uint64_t DEFLATE_MAX_RATIO = 1032; ///< Maximum compression ratio of the deflate format
+
+        template <typename T>
+        void append(std::vector<uint8_t>& buf, const T& val) {
+            const uint8_t* p = reinterpret_cast<const uint8_t*>(&val);
+            buf.insert(buf.end(), p, p + sizeof(T));
+        }
+
+        template <typename T>
+        T extract(const uint8_t* p) {
+            T val;
+            memcpy(&val, p, sizeof(T));
+            return val;
+        }
+
+        // Small signed differences are mapped on small unsigned values
+        inline uint16_t zigzag(uint16_t delta) {
+            return static_cast<uint16_t>((delta << 1) ^ (static_cast<int16_t>(delta) >> 15));
+        }
+
+        inline uint16_t unzigzag(uint16_t code) {
+            return static_cast<uint16_t>((code >> 1) ^ -static_cast<int16_t>(code & 1));
+        }
+
+        int ompThreads(int threads) {
+#ifdef _OPENMP
+            return threads > 0 ? threads : omp_get_max_threads();
+#else
+            return 1;
+#endif
+        }
+
+        bool deflateBand(const std::vector<uint8_t>& raw, std::vector<uint8_t>& out) {
+            z_stream strm;
+            memset(&strm, 0, sizeof(strm));
+
+            // The run length strategy ignores the compression level
+            if (deflateInit2(&strm, Z_BEST_SPEED, Z_DEFLATED, 15, 8, Z_RLE) != Z_OK) {
+                return false;
+            }
+
+            out.resize(deflateBound(&strm, raw.size()));
+
+            strm.next_in = const_cast<Bytef*>(raw.data());
+            strm.avail_in = static_cast<uInt>(raw.size());
+            strm.next_out = out.data();
+            strm.avail_out = static_cast<uInt>(out.size());
+
+            int ret = deflate(&strm, Z_FINISH);
+            out.resize(strm.total_out);
+            deflateEnd(&strm);
+
+            return ret == Z_STREAM_END;
+        }
+    }
+
+    bool encodeDepth(const float* depth, size_t step, int width, int height, float quantization,
+                     int bandRows, std::vector<uint8_t>& out, int threads) {
+        if (width <= 0 || height <= 0 || width > static_cast<int>(CODEC_MAX_SIZE) ||
+            height > static_cast<int>(CODEC_MAX_SIZE) || !(quantization > 0.f)) {
+            return false;
+        }
+
+        bandRows = std::min(std::max(bandRows, 1), height);
+
+        const int bandCount = (height + bandRows - 1) / bandRows;
+        const float invQuant = 1.f / quantization;
+        const float maxDepth = 65535.f * quantization;
+        const uint8_t* depthBytes = reinterpret_cast<const uint8_t*>(depth);
+
+        std::vector<std::vector<uint8_t>> bands(bandCount);
+        int failed = 0;
+
+        #pragma omp parallel for schedule(dynamic) reduction(+:failed) num_threads(ompThreads(threads))
+        for (int b = 0; b < bandCount; b++) {
+            const int first = b * bandRows;
+            const int rows = std::min(bandRows, height - first);
+            const size_t pixels = static_cast<size_t>(width) * rows;
+
+            // Low bytes plane followed by high bytes plane
+            std::vector<uint8_t> raw(2 * pixels);
+            uint8_t* low = raw.data();
+            uint8_t* high = raw.data() + pixels;
+
+            uint16_t above = 0;
+
+            for (int v = 0; v < rows; v++) {
+                const float* row = reinterpret_cast<const float*>(depthBytes + (first + v) * step);
+                uint16_t prev = above; // The first pixel of a row is predicted from the row above
+
+                for (int u = 0; u < width; u++) {
+                    float d = row[u];
+                    // NaN, infinite and out of range depths fail the check
+                    uint16_t q = (d > 0.f && d <= maxDepth) ? static_cast<uint16_t>(d * invQuant + 0.5f) : 0;
+
+                    if (u == 0) {
+                        above = q;
+                    }
+
+                    uint16_t code = zigzag(static_cast<uint16_t>(q - prev));
+                    *(low++) = static_cast<uint8_t>(code & 0xFF);
+                    *(high++) = static_cast<uint8_t>(code >> 8);
+                    prev = q;
+                }
+            }
+
+            if (!deflateBand(raw, bands[b])) {
+                failed++;
+            }
+        }
+
+        if (failed > 0) {
+            return false;
+        }
+
+        out.clear();
+        append<char[4]>(out, CODEC_MAGIC);
+        append<uint32_t>(out, static_cast<uint32_t>(width));
+        append<uint32_t>(out, static_cast<uint32_t>(height));
+        append<uint32_t>(out, static_cast<uint32_t>(bandRows));
+        append<uint32_t>(out, static_cast<uint32_t>(bandCount));
+        append<float>(out, quantization);
+
+        for (const auto& band : bands) {
+            append<uint32_t>(out, static_cast<uint32_t>(band.size()));
+        }
+
+        for (const auto& band : bands) {
+            out.insert(out.end(), band.begin(), band.end());
+        }
+
+        return true;
+    }
+
+    bool decodeDepth(const uint8_t* data, size_t size, std::vector<float>& depth, int& width, int& height,
+                     int threads) {
+        if (size < CODEC_HEADER_SIZE || memcmp(data, CODEC_MAGIC, sizeof(CODEC_MAGIC)) != 0) {
+            return false;
+        }
+
+        uint32_t w = extract<uint32_t>(data + 4);
+        uint32_t h = extract<uint32_t>(data + 8);
+        uint32_t bandRows = extract<uint32_t>(data + 12);
+        uint32_t bandCount = extract<uint32_t>(data + 16);
+        float quantization = extract<float>(data + 20);
+
+        // Header values are checked before sizing anything on them: the sizes are capped, so
+        // `h + bandRows - 1` can not overflow and the allocations are bounded
+        if (w == 0 || h == 0 || bandRows == 0 || w > CODEC_MAX_SIZE || h > CODEC_MAX_SIZE ||
+            bandRows > CODEC_MAX_SIZE || !(quantization > 0.f) || bandCount != (h + bandRows - 1) / bandRows ||
+            size < CODEC_HEADER_SIZE + 4 * static_cast<size_t>(bandCount)) {
+            return false;
+        }
+
+        // Offsets of the bands
+        std::vector<size_t> offsets(bandCount + 1);
+        offsets[0] = CODEC_HEADER_SIZE + 4 * static_cast<size_t>(bandCount);
+
+        for (uint32_t b = 0; b < bandCount; b++) {
+            offsets[b + 1] = offsets[b] + extract<uint32_t>(data + CODEC_HEADER_SIZE + 4 * b);
+        }
+
+        // A band can not be decompressed to more than `DEFLATE_MAX_RATIO` times its size
+        if (offsets[bandCount] > size ||
+            2 * static_cast<uint64_t>(w) * h > DEFLATE_MAX_RATIO * (offsets[bandCount] - offsets[0])) {
+            return false;
+        }
+
+        width = static_cast<int>(w);
+        height = static_cast<int>(h);
+        depth.resize(static_cast<size_t>(w) * h);
+
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        int failed = 0;
+
+        #pragma omp parallel for schedule(dynamic) reduction(+:failed) num_threads(ompThreads(threads))
+        for (int b = 0; b < static_cast<int>(bandCount); b++) {
+            const uint32_t first = b * bandRows;
+            const uint32_t rows = std::min(bandRows, h - first);
+            const size_t pixels = static_cast<size_t>(w) * rows;
+
+            std::vector<uint8_t> raw(2 * pixels);
+            uLongf rawSize = static_cast<uLongf>(raw.size());
+
+            if (uncompress(raw.data(), &rawSize, data + offsets[b], offsets[b + 1] - offsets[b]) != Z_OK ||
+                rawSize != raw.size()) {
+                failed++;
+                continue;
+            }
+
+            const uint8_t* low = raw.data();
+            const uint8_t* high = raw.data() + pixels;
+            float* out = &depth[static_cast<size_t>(w) * first];
+
+            uint16_t above = 0;
+
+            for (uint32_t v = 0; v < rows; v++) {
+                uint16_t prev = above;
+
+                for (uint32_t u = 0; u < w; u++) {
+                    uint16_t q = static_cast<uint16_t>(prev + unzigzag(static_cast<uint16_t>(*(low++) | (*(high++) << 8))));
+
+                    if (u == 0) {
+                        above = q;
+                    }
+
+                    *(out++) = q > 0 ? static_cast<float>(q) * quantization : nan;
+                    prev = q;
+                }
+            }
+        }
+
+        return failed == 0;
+    }
+
+} // namespace
@@ -0,0 +1,232 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_elevation.h"
+
+#include <sensor_msgs/point_cloud2_iterator.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace sl_tools {
+
+    namespace {
+        // Above this count the statistics of a cell are halved: the mean
+        // keeps following the changes of the terrain and the sum its precision
+        const uint32_t MAX_CELL_COUNT = 1 << 16;
+    }
+
+    CElevationMap::CElevationMap() {
+        mTableWidth = 0;
+        mTableFx = 0.f;
+        mTableCx = 0.f;
+        setParams(0.1f, 20.0f, 4, 10.0f, 2.0f);
+    }
+
+    void CElevationMap::setParams(float resolution, float size, int pixelStride, float maxRange, float maxHeight) {
+        mResolution = std::max(resolution, 0.001f);
+        mSize = std::max(static_cast<int>(std::ceil(size / mResolution)), 1);
+        mPixelStride = std::max(pixelStride, 1);
+        mMaxRange = maxRange;
+        mMaxHeight = maxHeight;
+
+        mCells.resize(mSize * mSize);
+        mTableWidth = 0; // Force the update of the ray table
+        clear();
+    }
+
+    void CElevationMap::clear() {
+        for (int i = 0; i < mSize; i++) {
+            clearRow(i);
+        }
+
+        mPlaced = false;
+    }
+
+    void CElevationMap::clearColumn(int col) {
+        for (int row = 0; row < mSize; row++) {
+            Cell& c = mCells[row * mSize + col];
+            c.minZ = std::numeric_limits<float>::max();
+            c.maxZ = -std::numeric_limits<float>::max();
+            c.sumZ = 0.f;
+            c.count = 0;
+        }
+    }
+
+    void CElevationMap::clearRow(int row) {
+        Cell* c = &mCells[row * mSize];
+
+        for (int col = 0; col < mSize; col++, c++) {
+            c->minZ = std::numeric_limits<float>::max();
+            c->maxZ = -std::numeric_limits<float>::max();
+            c->sumZ = 0.f;
+            c->count = 0;
+        }
+    }
+
+    void CElevationMap::moveTo(float robotX, float robotY) {
+        int originX = static_cast<int>(std::floor(robotX / mResolution)) - mSize / 2;
+        int originY = static_cast<int>(std::floor(robotY / mResolution)) - mSize / 2;
+
+        if (!mPlaced || std::abs(originX - mOriginX) >= mSize || std::abs(originY - mOriginY) >= mSize) {
+            clear();
+            mPlaced = true;
+        } else {
+            // Clear the cells leaving the map: they are reused on the other side
+            for (int g = mOriginX; g < originX; g++) {
+                clearColumn(wrap(g));
+            }
+
+            for (int g = originX + mSize; g < mOriginX + mSize; g++) {
+                clearColumn(wrap(g));
+            }
+
+            for (int g = mOriginY; g < originY; g++) {
+                clearRow(wrap(g));
+            }
+
+            for (int g = originY + mSize; g < mOriginY + mSize; g++) {
+                clearRow(wrap(g));
+            }
+        }
+
+        mOriginX = originX;
+        mOriginY = originY;
+    }
+
+    void CElevationMap::fuse(const float* depth, size_t step, int width, int height, float fx, float fy, float cx, float cy,
+                             const float transf[12], float robotX, float robotY, float robotZ) {
+        moveTo(robotX, robotY);
+
+        const int cols = (width + mPixelStride - 1) / mPixelStride;
+
+        if (width != mTableWidth || fx != mTableFx || cx != mTableCx) {
+            mTableWidth = width;
+            mTableFx = fx;
+            mTableCx = cx;
+
+            mColRay.resize(cols);
+
+            for (int i = 0; i < cols; i++) {
+                mColRay[i] = -(static_cast<float>(i * mPixelStride) - cx) / fx;
+            }
+
+            mRowDepth.resize(cols);
+            mRowX.resize(cols);
+            mRowY.resize(cols);
+            mRowZ.resize(cols);
+        }
+
+        const float invRes = 1.f / mResolution;
+        const float maxZ = robotZ + mMaxHeight;
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        const float* ray = mColRay.data();
+        float* d = mRowDepth.data();
+        float* px = mRowX.data();
+        float* py = mRowY.data();
+        float* pz = mRowZ.data();
+
+        const uint8_t* rowPtr = reinterpret_cast<const uint8_t*>(depth);
+
+        for (int v = 0; v < height; v += mPixelStride) {
+            const float* row = reinterpret_cast<const float*>(rowPtr + v * step);
+
+            // Point of the camera frame: depth * (1, ray, rowRay)
+            // Point of the map frame: depth * (a + ray * b) + t
+            float rowRay = -(static_cast<float>(v) - cy) / fy;
+            float ax = transf[0] + transf[2] * rowRay;
+            float ay = transf[4] + transf[6] * rowRay;
+            float az = transf[8] + transf[10] * rowRay;
+
+            for (int i = 0; i < cols; i++) {
+                float z = row[i * mPixelStride];
+                d[i] = z <= mMaxRange ? z : nan;
+            }
+
+            for (int i = 0; i < cols; i++) {
+                px[i] = d[i] * (ax + ray[i] * transf[1]) + transf[3];
+                py[i] = d[i] * (ay + ray[i] * transf[5]) + transf[7];
+                pz[i] = d[i] * (az + ray[i] * transf[9]) + transf[11];
+            }
+
+            // Invalid points are NaN or infinite and fail the checks
+            for (int i = 0; i < cols; i++) {
+                float gx = std::floor(px[i] * invRes) - static_cast<float>(mOriginX);
+                float gy = std::floor(py[i] * invRes) - static_cast<float>(mOriginY);
+
+                if (!(gx >= 0.f && gx < mSize && gy >= 0.f && gy < mSize && pz[i] <= maxZ)) {
+                    continue;
+                }
+
+                Cell* c = cell(mOriginX + static_cast<int>(gx), mOriginY + static_cast<int>(gy));
+                c->minZ = std::min(c->minZ, pz[i]);
+                c->maxZ = std::max(c->maxZ, pz[i]);
+                c->sumZ += pz[i];
+
+                if (++c->count >= MAX_CELL_COUNT) {
+                    c->sumZ *= 0.5f;
+                    c->count /= 2;
+                }
+            }
+        }
+    }
+
+    void CElevationMap::fillCloud(sensor_msgs::PointCloud2& cloud) const {
+        size_t observed = 0;
+
+        for (const Cell& c : mCells) {
+            observed += c.count > 0 ? 1 : 0;
+        }
+
+        sensor_msgs::PointCloud2Modifier modifier(cloud);
+        modifier.setPointCloud2Fields(5,
+                                      "x", 1, sensor_msgs::PointField::FLOAT32,
+                                      "y", 1, sensor_msgs::PointField::FLOAT32,
+                                      "z", 1, sensor_msgs::PointField::FLOAT32,
+                                      "min_z", 1, sensor_msgs::PointField::FLOAT32,
+                                      "max_z", 1, sensor_msgs::PointField::FLOAT32);
+        modifier.resize(observed);
+        cloud.is_bigendian = false;
+        cloud.is_dense = true;
+
+        float* out = reinterpret_cast<float*>(cloud.data.data());
+
+        // Rows and columns in map order, starting from the origin
+        for (int gy = mOriginY; gy < mOriginY + mSize && mPlaced; gy++) {
+            const Cell* row = &mCells[wrap(gy) * mSize];
+
+            for (int gx = mOriginX; gx < mOriginX + mSize; gx++) {
+                const Cell& c = row[wrap(gx)];
+
+                if (c.count == 0) {
+                    continue;
+                }
+
+                *(out++) = (static_cast<float>(gx) + 0.5f) * mResolution;
+                *(out++) = (static_cast<float>(gy) + 0.5f) * mResolution;
+                *(out++) = c.sumZ / static_cast<float>(c.count);
+                *(out++) = c.minZ;
+                *(out++) = c.maxZ;
+            }
+        }
+    }
+
+} // namespace
@@ -0,0 +1,134 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace sl_tools {
+
+    CObstacleGrid::CObstacleGrid() {
+        setParams(0.05f, 10.0f, 0.1f, 1.5f, 3);
+    }
+
+    void CObstacleGrid::setParams(float resolution, float size, float minHeight, float maxHeight, int minPoints) {
+        mResolution = std::max(resolution, 0.001f);
+        mCells = std::max(static_cast<int>(std::ceil(size / mResolution)), 1);
+        mMinHeight = minHeight;
+        mMaxHeight = std::max(maxHeight, minHeight);
+        mMinPoints = std::min(std::max(minPoints, 1), static_cast<int>(std::numeric_limits<uint16_t>::max()));
+    }
+
+    void CObstacleGrid::update(const float* cloud, size_t step, int width, int height,
+                               const float transf[12], nav_msgs::OccupancyGrid& grid, int threads) {
+        const int cellCount = mCells * mCells;
+        const float origin = -0.5f * static_cast<float>(mCells) * mResolution;
+        const float invRes = 1.0f / mResolution;
+
+#ifdef _OPENMP
+        threads = threads > 0 ? threads : omp_get_max_threads();
+#else
+        threads = 1;
+#endif
+
+        mObstacleCounts.resize(threads);
+        mGroundSeen.resize(threads);
+
+        for (int t = 0; t < threads; t++) {
+            mObstacleCounts[t].assign(cellCount, 0);
+            mGroundSeen[t].assign(cellCount, 0);
+        }
+
+        const uint8_t* cloudBytes = reinterpret_cast<const uint8_t*>(cloud);
+
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for (int v = 0; v < height; v++) {
+#ifdef _OPENMP
+            const int t = omp_get_thread_num();
+#else
+            const int t = 0;
+#endif
+            uint16_t* counts = mObstacleCounts[t].data();
+            uint8_t* ground = mGroundSeen[t].data();
+
+            const float* pt = reinterpret_cast<const float*>(cloudBytes + v * step);
+
+            for (int u = 0; u < width; u++, pt += 4) {
+                float x = transf[0] * pt[0] + transf[1] * pt[1] + transf[2] * pt[2] + transf[3];
+                float y = transf[4] * pt[0] + transf[5] * pt[1] + transf[6] * pt[2] + transf[7];
+                float z = transf[8] * pt[0] + transf[9] * pt[1] + transf[10] * pt[2] + transf[11];
+
+                // Invalid points are NaN or infinite and fail the checks
+                float cx = (x - origin) * invRes;
+                float cy = (y - origin) * invRes;
+
+                if (!(cx >= 0.f && cx < mCells && cy >= 0.f && cy < mCells && z <= mMaxHeight)) {
+                    continue;
+                }
+
+                int idx = static_cast<int>(cy) * mCells + static_cast<int>(cx);
+
+                if (z >= mMinHeight) {
+                    if (counts[idx] < std::numeric_limits<uint16_t>::max()) {
+                        counts[idx]++;
+                    }
+                } else {
+                    ground[idx] = 1;
+                }
+            }
+        }
+
+        grid.info.resolution = mResolution;
+        grid.info.width = mCells;
+        grid.info.height = mCells;
+        grid.info.origin.position.x = origin;
+        grid.info.origin.position.y = origin;
+        grid.info.origin.position.z = 0.0;
+        grid.info.origin.orientation.x = 0.0;
+        grid.info.origin.orientation.y = 0.0;
+        grid.info.origin.orientation.z = 0.0;
+        grid.info.origin.orientation.w = 1.0;
+        grid.data.resize(cellCount);
+
+        int8_t* data = grid.data.data();
+
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for (int i = 0; i < cellCount; i++) {
+            int count = 0;
+            bool seen = false;
+
+            for (int t = 0; t < threads; t++) {
+                count += mObstacleCounts[t][i];
+                seen |= mGroundSeen[t][i] != 0;
+            }
+
+            // A few obstacle points are not enough to mark the cell as occupied,
+            // but they must not let a costmap clear a sparse obstacle
+            data[i] = count >= mMinPoints ? 100 : ((count == 0 && seen) ? 0 : -1);
+        }
+    }
+
+} // namespace
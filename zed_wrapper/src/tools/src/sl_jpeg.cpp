@@ -0,0 +1,242 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_jpeg.h"
+
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+extern "C" {
+#include <jpeglib.h>
+}
+
+namespace sl_tools {
+
+    namespace {
+        const int MCU_SIZE = 16;            ///< MCU size of a 4:2:0 YCbCr JPEG [pixels]
+        const int MAX_RESTART_MCUS = 65535; ///< Maximum restart interval
+
+        struct JpegErrorMgr {
+            jpeg_error_mgr mgr;
+            jmp_buf jump;
+        };
+
+        // The default handler calls exit(): go back to the caller instead
+        void onJpegError(j_common_ptr cinfo) {
+            longjmp(reinterpret_cast<JpegErrorMgr*>(cinfo->err)->jump, 1);
+        }
+
+        bool encodeStripe(const uint8_t* bgra, size_t step, int width, int height, int quality,
+                          std::vector<uint8_t>& out) {
+            jpeg_compress_struct cinfo;
+            JpegErrorMgr err;
+            unsigned char* mem = nullptr;
+            unsigned long memSize = 0;
+#ifndef JCS_EXTENSIONS
+            std::vector<uint8_t> rgb(static_cast<size_t>(width) * 3);
+#endif
+
+            memset(&cinfo, 0, sizeof(cinfo));
+            cinfo.err = jpeg_std_error(&err.mgr);
+            err.mgr.error_exit = onJpegError;
+
+            if (setjmp(err.jump)) {
+                jpeg_destroy_compress(&cinfo);
+                free(mem);
+                return false;
+            }
+
+            jpeg_create_compress(&cinfo);
+            jpeg_mem_dest(&cinfo, &mem, &memSize);
+
+            cinfo.image_width = width;
+            cinfo.image_height = height;
+#ifdef JCS_EXTENSIONS
+            // libjpeg-turbo converts BGRA to YCbCr with SIMD code
+            cinfo.input_components = 4;
+            cinfo.in_color_space = JCS_EXT_BGRA;
+#else
+            cinfo.input_components = 3;
+            cinfo.in_color_space = JCS_RGB;
+#endif
+            jpeg_set_defaults(&cinfo);
+            jpeg_set_quality(&cinfo, quality, TRUE);
+
+            jpeg_start_compress(&cinfo, TRUE);
+
+            while (cinfo.next_scanline < cinfo.image_height) {
+                const uint8_t* src = bgra + cinfo.next_scanline * step;
+#ifdef JCS_EXTENSIONS
+                JSAMPROW row = const_cast<JSAMPROW>(src);
+#else
+                for (int x = 0; x < width; x++) {
+                    rgb[x * 3 + 0] = src[x * 4 + 2];
+                    rgb[x * 3 + 1] = src[x * 4 + 1];
+                    rgb[x * 3 + 2] = src[x * 4 + 0];
+                }
+
+                JSAMPROW row = rgb.data();
+#endif
+                jpeg_write_scanlines(&cinfo, &row, 1);
+            }
+
+            jpeg_finish_compress(&cinfo);
+            jpeg_destroy_compress(&cinfo);
+
+            out.assign(mem, mem + memSize);
+            free(mem);
+
+            return true;
+        }
+
+        /*!
+         * \brief Locate the segments of a JPEG produced by \ref encodeStripe
+         * \param sofPos offset of the SOF0 marker
+         * \param sosPos offset of the SOS marker
+         * \param dataPos offset of the entropy coded data, ending before the EOI marker
+         */
+        bool parseStripe(const std::vector<uint8_t>& jpg, size_t& sofPos, size_t& sosPos, size_t& dataPos) {
+            size_t size = jpg.size();
+
+            if (size < 4 || jpg[0] != 0xFF || jpg[1] != 0xD8 || jpg[size - 2] != 0xFF || jpg[size - 1] != 0xD9) {
+                return false;
+            }
+
+            sofPos = 0;
+            size_t pos = 2;
+
+            while (pos + 4 <= size && jpg[pos] == 0xFF) {
+                uint8_t marker = jpg[pos + 1];
+                size_t len = (static_cast<size_t>(jpg[pos + 2]) << 8) | jpg[pos + 3];
+
+                if (marker == 0xC0) {
+                    sofPos = pos;
+                } else if (marker == 0xDA) {
+                    sosPos = pos;
+                    dataPos = pos + 2 + len;
+                    return sofPos > 0 && dataPos <= size - 2;
+                }
+
+                pos += 2 + len;
+            }
+
+            return false;
+        }
+    }
+
+    bool encodeJpegBGRA(const uint8_t* bgra, size_t step, int width, int height, int quality,
+                        std::vector<uint8_t>& out, int threads) {
+        if (!bgra || width <= 0 || height <= 0 || width > 65535 || height > 65535) {
+            return false;
+        }
+
+        quality = std::min(std::max(quality, 1), 100);
+
+        // Stripes are made of whole MCU rows, so that each stripe is exactly
+        // one restart interval of the full image
+        const int mcuCols = (width + MCU_SIZE - 1) / MCU_SIZE;
+        const int mcuRows = (height + MCU_SIZE - 1) / MCU_SIZE;
+#ifdef _OPENMP
+        threads = threads > 0 ? threads : omp_get_max_threads();
+#else
+        threads = 1;
+#endif
+
+        int stripeMcuRows = (mcuRows + threads - 1) / threads;
+        stripeMcuRows = std::min(stripeMcuRows, MAX_RESTART_MCUS / mcuCols);
+
+        if (threads <= 1 || stripeMcuRows <= 0 || stripeMcuRows >= mcuRows) {
+            return encodeStripe(bgra, step, width, height, quality, out);
+        }
+
+        const int stripeRows = stripeMcuRows * MCU_SIZE;
+        const int stripeCount = (height + stripeRows - 1) / stripeRows;
+
+        std::vector<std::vector<uint8_t>> stripes(stripeCount);
+        int failed = 0;
+
+        #pragma omp parallel for schedule(dynamic) reduction(+:failed) num_threads(threads)
+        for (int s = 0; s < stripeCount; s++) {
+            int firstRow = s * stripeRows;
+            int rows = std::min(stripeRows, height - firstRow);
+
+            if (!encodeStripe(bgra + firstRow * step, step, width, rows, quality, stripes[s])) {
+                failed++;
+            }
+        }
+
+        if (failed > 0) {
+            return false;
+        }
+
+        // ----> Join the stripes
+        // The headers (quantization and Huffman tables) are the same for all
+        // the stripes: the ones of the first stripe are used with the full
+        // image height and a restart interval, then the entropy coded data of
+        // each stripe follows, separated by RSTn markers
+        size_t sofPos, sosPos, dataPos;
+
+        if (!parseStripe(stripes[0], sofPos, sosPos, dataPos)) {
+            return false;
+        }
+
+        const std::vector<uint8_t>& first = stripes[0];
+        const int restartMcus = stripeMcuRows * mcuCols;
+
+        out.clear();
+        out.reserve(first.size() * stripeCount);
+
+        out.insert(out.end(), first.begin(), first.begin() + sosPos);
+        out[sofPos + 5] = static_cast<uint8_t>(height >> 8);
+        out[sofPos + 6] = static_cast<uint8_t>(height & 0xFF);
+
+        const uint8_t dri[6] = {0xFF, 0xDD, 0x00, 0x04,
+                                static_cast<uint8_t>(restartMcus >> 8), static_cast<uint8_t>(restartMcus & 0xFF)
+                               };
+        out.insert(out.end(), dri, dri + sizeof(dri));
+        out.insert(out.end(), first.begin() + sosPos, first.end() - 2);
+
+        for (int s = 1; s < stripeCount; s++) {
+            size_t stripeSof, stripeSos, stripeData;
+
+            if (!parseStripe(stripes[s], stripeSof, stripeSos, stripeData)) {
+                return false;
+            }
+
+            out.push_back(0xFF);
+            out.push_back(static_cast<uint8_t>(0xD0 + ((s - 1) & 7)));
+            out.insert(out.end(), stripes[s].begin() + stripeData, stripes[s].end() - 2);
+        }
+
+        out.push_back(0xFF);
+        out.push_back(0xD9);
+        // <---- Join the stripes
+
+        return true;
+    }
+
+} // namespace
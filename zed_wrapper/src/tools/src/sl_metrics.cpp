@@ -0,0 +1,233 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_metrics.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace sl_tools {
+
+    void CMetricsWriter::addHeader(const std::string& name, const std::string& help, const char* type) {
+        if (name == mLastName) {
+            return;
+        }
+
+        mOut << "# HELP " << name << " " << help << "\n";
+        mOut << "# TYPE " << name << " " << type << "\n";
+        mLastName = name;
+    }
+
+    void CMetricsWriter::addSample(const std::string& name, const std::string& labels, double value) {
+        mOut << name;
+
+        if (!mCommonLabels.empty() && !labels.empty()) {
+            mOut << "{" << mCommonLabels << "," << labels << "}";
+        } else if (!mCommonLabels.empty() || !labels.empty()) {
+            mOut << "{" << mCommonLabels << labels << "}";
+        }
+
+        mOut << " " << value << "\n";
+    }
+
+    void CMetricsWriter::addCounter(const std::string& name, const std::string& help, double value,
+                                    const std::string& labels) {
+        addHeader(name, help, "counter");
+        addSample(name, labels, value);
+    }
+
+    void CMetricsWriter::addGauge(const std::string& name, const std::string& help, double value,
+                                  const std::string& labels) {
+        addHeader(name, help, "gauge");
+        addSample(name, labels, value);
+    }
+
+    void CMetricsWriter::addSummary(const std::string& name, const std::string& help,
+                                    const CLatencyHistogram& hist, double scale) {
+        addHeader(name, help, "summary");
+
+        uint64_t count = hist.getValCount();
+
+        addSample(name, "quantile=\"0.5\"", hist.getPercentile(50.) * scale);
+        addSample(name, "quantile=\"0.95\"", hist.getPercentile(95.) * scale);
+        addSample(name, "quantile=\"0.99\"", hist.getPercentile(99.) * scale);
+        addSample(name + "_sum", "", hist.getMean() * count * scale);
+        addSample(name + "_count", "", static_cast<double>(count));
+    }
+
+    CMetricsServer::CMetricsServer() {
+        mSocket = -1;
+        mRunning = false;
+    }
+
+    CMetricsServer::~CMetricsServer() {
+        stop();
+    }
+
+    bool CMetricsServer::start(const std::string& address, int port, PageCallback cb) {
+        stop();
+
+        mSocket = socket(AF_INET, SOCK_STREAM, 0);
+
+        if (mSocket < 0) {
+            return false;
+        }
+
+        int reuse = 1;
+        setsockopt(mSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+
+        if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1 ||
+                bind(mSocket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+                listen(mSocket, 4) != 0) {
+            close(mSocket);
+            mSocket = -1;
+            return false;
+        }
+
+        mCallback = cb;
+        mRunning = true;
+        mThread = std::thread(&CMetricsServer::serverThreadFunc, this);
+
+        return true;
+    }
+
+    void CMetricsServer::stop() {
+        mRunning = false;
+
+        if (mThread.joinable()) {
+            mThread.join();
+        }
+
+        if (mSocket >= 0) {
+            close(mSocket);
+            mSocket = -1;
+        }
+    }
+
+    void CMetricsServer::serverThreadFunc() {
+        while (mRunning) {
+            // Timeout used to check the running flag
+            pollfd pfd;
+            pfd.fd = mSocket;
+            pfd.events = POLLIN;
+
+            if (poll(&pfd, 1, 200) <= 0) {
+                continue;
+            }
+
+            int client = accept(mSocket, nullptr, nullptr);
+
+            if (client < 0) {
+                continue;
+            }
+
+            // A stalled client must not block the thread in send
+            timeval timeout;
+            timeout.tv_sec = SEND_TIMEOUT_MSEC / 1000;
+            timeout.tv_usec = (SEND_TIMEOUT_MSEC % 1000) * 1000;
+            setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+            serveClient(client);
+            close(client);
+        }
+    }
+
+    void CMetricsServer::serveClient(int fd) {
+        // Read the request header. Its content is ignored: every path returns the metrics
+        std::string request;
+        char buf[1024];
+
+        // A client sending the header byte by byte must not hold the thread either
+        std::chrono::steady_clock::time_point deadline =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(READ_TIMEOUT_MSEC);
+
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+            if (!mRunning) {
+                return;
+            }
+
+            int64_t remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                    deadline - std::chrono::steady_clock::now()).count();
+
+            if (remaining <= 0) {
+                return;
+            }
+
+            pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLIN;
+
+            // Short waits, to check `mRunning` while the client is silent
+            int ret = poll(&pfd, 1, static_cast<int>(std::min<int64_t>(remaining, 200)));
+
+            if (ret == 0) {
+                continue;
+            }
+
+            if (ret < 0) {
+                return;
+            }
+
+            ssize_t n = recv(fd, buf, sizeof(buf), 0);
+
+            if (n <= 0) {
+                return;
+            }
+
+            request.append(buf, n);
+        }
+
+        std::string body = mCallback ? mCallback() : std::string();
+
+        std::ostringstream reply;
+        reply << "HTTP/1.0 200 OK\r\n"
+              << "Content-Type: text/plain; version=0.0.4\r\n"
+              << "Content-Length: " << body.size() << "\r\n"
+              << "Connection: close\r\n\r\n"
+              << body;
+
+        std::string data = reply.str();
+        size_t sent = 0;
+
+        while (sent < data.size()) {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+
+            if (n <= 0) {
+                return;
+            }
+
+            sent += n;
+        }
+    }
+
+} // namespace
@@ -0,0 +1,170 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_normals.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace sl_tools {
+
+    CNormalEstimator::CNormalEstimator() {
+        setParams(2);
+    }
+
+    void CNormalEstimator::setParams(int radius) {
+        mRadius = std::max(radius, 1);
+    }
+
+    void CNormalEstimator::compute(const float* cloud, size_t step, int width, int height, float* normals,
+                                   int threads) {
+#ifdef _OPENMP
+        threads = threads > 0 ? threads : omp_get_max_threads();
+#else
+        threads = 1;
+#endif
+
+        const int r = mRadius;
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+
+        // More than half of the window must be valid
+        const float minCount = 0.5f * static_cast<float>((2 * r + 1) * (2 * r + 1));
+
+        mRowSums.resize(4 * width * height);
+        mMeans.resize(3 * width * height);
+
+        const uint8_t* cloudBytes = reinterpret_cast<const uint8_t*>(cloud);
+
+        // ----> Horizontal sums of the valid points (running window)
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for (int v = 0; v < height; v++) {
+            const float* pt = reinterpret_cast<const float*>(cloudBytes + v * step);
+            float* out = &mRowSums[4 * width * v];
+
+            double sx = 0.0, sy = 0.0, sz = 0.0;
+            int n = 0;
+
+            for (int u = -r; u < width; u++) {
+                int in = u + r;
+                int outIdx = u - r - 1;
+
+                if (in < width && std::isfinite(pt[4 * in + 2])) {
+                    sx += pt[4 * in];
+                    sy += pt[4 * in + 1];
+                    sz += pt[4 * in + 2];
+                    n++;
+                }
+
+                if (outIdx >= 0 && std::isfinite(pt[4 * outIdx + 2])) {
+                    sx -= pt[4 * outIdx];
+                    sy -= pt[4 * outIdx + 1];
+                    sz -= pt[4 * outIdx + 2];
+                    n--;
+                }
+
+                if (u >= 0) {
+                    out[4 * u] = static_cast<float>(sx);
+                    out[4 * u + 1] = static_cast<float>(sy);
+                    out[4 * u + 2] = static_cast<float>(sz);
+                    out[4 * u + 3] = static_cast<float>(n);
+                }
+            }
+        }
+        // <---- Horizontal sums of the valid points (running window)
+
+        // ----> Vertical sums and mean of the window
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for (int v = 0; v < height; v++) {
+            const int first = std::max(v - r, 0);
+            const int last = std::min(v + r, height - 1);
+            float* mean = &mMeans[3 * width * v];
+
+            for (int u = 0; u < width; u++) {
+                float s[4] = {0.f, 0.f, 0.f, 0.f};
+
+                for (int row = first; row <= last; row++) {
+                    const float* in = &mRowSums[4 * (width * row + u)];
+                    s[0] += in[0];
+                    s[1] += in[1];
+                    s[2] += in[2];
+                    s[3] += in[3];
+                }
+
+                bool valid = s[3] > minCount;
+                float inv = valid ? 1.f / s[3] : 0.f;
+                mean[3 * u] = valid ? s[0] * inv : nan;
+                mean[3 * u + 1] = valid ? s[1] * inv : nan;
+                mean[3 * u + 2] = valid ? s[2] * inv : nan;
+            }
+        }
+        // <---- Vertical sums and mean of the window
+
+        // ----> Cross product of the smoothed gradients
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for (int v = 0; v < height; v++) {
+            const float* pt = reinterpret_cast<const float*>(cloudBytes + v * step);
+            float* out = &normals[3 * width * v];
+
+            for (int u = 0; u < width; u++, out += 3) {
+                out[0] = out[1] = out[2] = nan;
+
+                if (u < r || u >= width - r || v < r || v >= height - r || !std::isfinite(pt[4 * u + 2])) {
+                    continue;
+                }
+
+                const float* left = &mMeans[3 * (width * v + u - r)];
+                const float* right = &mMeans[3 * (width * v + u + r)];
+                const float* up = &mMeans[3 * (width * (v - r) + u)];
+                const float* down = &mMeans[3 * (width * (v + r) + u)];
+
+                float hx = right[0] - left[0], hy = right[1] - left[1], hz = right[2] - left[2];
+                float vx = down[0] - up[0], vy = down[1] - up[1], vz = down[2] - up[2];
+
+                float nx = vy * hz - vz * hy;
+                float ny = vz * hx - vx * hz;
+                float nz = vx * hy - vy * hx;
+
+                float norm = std::sqrt(nx * nx + ny * ny + nz * nz);
+
+                // NaN means are propagated and fail the check
+                if (!(norm > 1e-12f)) {
+                    continue;
+                }
+
+                // Oriented toward the camera (origin of the cloud frame)
+                if (nx * pt[4 * u] + ny * pt[4 * u + 1] + nz * pt[4 * u + 2] > 0.f) {
+                    norm = -norm;
+                }
+
+                out[0] = nx / norm;
+                out[1] = ny / norm;
+                out[2] = nz / norm;
+            }
+        }
+        // <---- Cross product of the smoothed gradients
+    }
+
+} // namespace
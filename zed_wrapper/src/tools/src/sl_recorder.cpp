@@ -0,0 +1,610 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_recorder.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+namespace sl_tools {
+
+    namespace {
+        const char FILE_MAGIC[8] = {'Z', 'E', 'D', 'R', 'E', 'C', '0', '1'};
+        const char END_MAGIC[8] = {'Z', 'E', 'D', 'R', 'E', 'C', 'N', 'D'};
+        const char CHUNK_MAGIC[4] = {'C', 'H', 'N', 'K'};
+        const char INDEX_MAGIC[4] = {'I', 'N', 'D', 'X'};
+
+        const uint32_t COMPRESSION_NONE = 0;
+        const uint32_t COMPRESSION_ZLIB = 1;
+
+        const size_t CHUNK_HEADER_SIZE = 4 + 4 * 4 + 2 * 8;
+        const size_t RECORD_HEADER_SIZE = 2 + 8 + 4;
+        const size_t FOOTER_SIZE = 8 + 8;
+
+        const size_t MAX_QUEUED_CHUNKS = 8; ///< Chunks are dropped when the disk is slower than the data
+
+        template <typename T>
+        void append(std::vector<uint8_t>& buf, const T& val) {
+            const uint8_t* p = reinterpret_cast<const uint8_t*>(&val);
+            buf.insert(buf.end(), p, p + sizeof(T));
+        }
+
+        template <typename T>
+        T extract(const uint8_t* p) {
+            T val;
+            memcpy(&val, p, sizeof(T));
+            return val;
+        }
+
+        void appendString(std::vector<uint8_t>& buf, const std::string& str) {
+            append<uint16_t>(buf, static_cast<uint16_t>(str.size()));
+            buf.insert(buf.end(), str.begin(), str.end());
+        }
+    }
+
+    // ----> CChunkRecorder
+
+    CChunkRecorder::CChunkRecorder() {
+        mFile = nullptr;
+        mOpen = false;
+        mCompress = true;
+        mChunkSize = 0;
+        mStopWriter = false;
+        mWrittenBytes = 0;
+        mDroppedChunks = 0;
+        mWriteFailed = false;
+    }
+
+    CChunkRecorder::~CChunkRecorder() {
+        close();
+    }
+
+    bool CChunkRecorder::open(const std::string& filename, const std::vector<RecChannel>& channels,
+                              size_t chunkSize, bool compress) {
+        close();
+
+        mFile = fopen(filename.c_str(), "wb");
+
+        if (!mFile) {
+            return false;
+        }
+
+        // Chunks are written with a single call: without stdio buffering a
+        // write error is reported by the call writing the chunk
+        setvbuf(mFile, nullptr, _IONBF, 0);
+
+        std::vector<uint8_t> header(FILE_MAGIC, FILE_MAGIC + sizeof(FILE_MAGIC));
+        append<uint32_t>(header, static_cast<uint32_t>(channels.size()));
+
+        for (const auto& ch : channels) {
+            append<uint16_t>(header, ch.id);
+            appendString(header, ch.name);
+            appendString(header, ch.datatype);
+        }
+
+        if (fwrite(header.data(), 1, header.size(), mFile) != header.size()) {
+            fclose(mFile);
+            mFile = nullptr;
+            return false;
+        }
+
+        mWrittenBytes = header.size();
+        mDroppedChunks = 0;
+        mWriteFailed = false;
+        mChunkSize = std::max<size_t>(chunkSize, 4096);
+        mCompress = compress;
+        mIndex.clear();
+
+        mCurrent = Chunk();
+        mCurrent.data.reserve(mChunkSize + mChunkSize / 4);
+        mStopWriter = false;
+        mOpen = true;
+
+        mWriterThread = std::thread(&CChunkRecorder::writerThreadFunc, this);
+
+        return true;
+    }
+
+    void CChunkRecorder::close() {
+        if (!mOpen) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mBufMutex);
+            mOpen = false;
+
+            if (mCurrent.records > 0) {
+                queueChunk();
+            }
+
+            mStopWriter = true;
+        }
+
+        mBufCondVar.notify_one();
+
+        if (mWriterThread.joinable()) {
+            mWriterThread.join();
+        }
+
+        // ----> Index and footer
+        std::vector<uint8_t> index(INDEX_MAGIC, INDEX_MAGIC + sizeof(INDEX_MAGIC));
+        append<uint32_t>(index, static_cast<uint32_t>(mIndex.size()));
+
+        for (const auto& entry : mIndex) {
+            append<uint64_t>(index, entry.offset);
+            append<int64_t>(index, entry.start);
+            append<int64_t>(index, entry.end);
+        }
+
+        append<uint64_t>(index, static_cast<uint64_t>(mWrittenBytes));
+        index.insert(index.end(), END_MAGIC, END_MAGIC + sizeof(END_MAGIC));
+
+        if (!mWriteFailed && fwrite(index.data(), 1, index.size(), mFile) == index.size()) {
+            mWrittenBytes += index.size();
+        }
+
+        // <---- Index and footer
+
+        // Remove the partial chunk or index left by a write error
+        if (fflush(mFile) != 0 || ftruncate(fileno(mFile), static_cast<off_t>(mWrittenBytes)) != 0) {
+            mWriteFailed = true;
+        }
+
+        fclose(mFile);
+        mFile = nullptr;
+    }
+
+    void CChunkRecorder::write(uint16_t channel, int64_t stampNsec, const uint8_t* data, uint32_t size) {
+        if (!mOpen) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mBufMutex);
+
+        uint8_t* dst = appendRecord(channel, stampNsec, size);
+
+        if (dst) {
+            memcpy(dst, data, size);
+            chunkCheck();
+        }
+    }
+
+    uint8_t* CChunkRecorder::appendRecord(uint16_t channel, int64_t stampNsec, uint32_t size) {
+        if (!mOpen) {
+            return nullptr;
+        }
+
+        if (mCurrent.records == 0) {
+            mCurrent.start = stampNsec;
+            mCurrent.end = stampNsec;
+        } else {
+            mCurrent.start = std::min(mCurrent.start, stampNsec);
+            mCurrent.end = std::max(mCurrent.end, stampNsec);
+        }
+
+        append<uint16_t>(mCurrent.data, channel);
+        append<int64_t>(mCurrent.data, stampNsec);
+        append<uint32_t>(mCurrent.data, size);
+
+        size_t pos = mCurrent.data.size();
+        mCurrent.data.resize(pos + size);
+        mCurrent.records++;
+
+        return mCurrent.data.data() + pos;
+    }
+
+    void CChunkRecorder::chunkCheck() {
+        if (mCurrent.data.size() >= mChunkSize) {
+            queueChunk();
+            mBufCondVar.notify_one();
+        }
+    }
+
+    void CChunkRecorder::queueChunk() {
+        if (mQueue.size() >= MAX_QUEUED_CHUNKS) {
+            mDroppedChunks++;
+            mCurrent.data.clear();
+        } else {
+            mQueue.push_back(std::move(mCurrent));
+            mCurrent = Chunk();
+            mCurrent.data.reserve(mChunkSize + mChunkSize / 4);
+        }
+
+        mCurrent.records = 0;
+    }
+
+    void CChunkRecorder::writerThreadFunc() {
+        while (true) {
+            Chunk chunk;
+
+            {
+                std::unique_lock<std::mutex> lock(mBufMutex);
+                mBufCondVar.wait(lock, [this] {
+                    return mStopWriter || !mQueue.empty();
+                });
+
+                if (mQueue.empty()) {
+                    break;
+                }
+
+                chunk = std::move(mQueue.front());
+                mQueue.pop_front();
+            }
+
+            writeChunk(chunk);
+        }
+    }
+
+    void CChunkRecorder::writeChunk(const Chunk& chunk) {
+        if (mWriteFailed) {
+            mDroppedChunks++;
+            return;
+        }
+
+        uint32_t compression = COMPRESSION_NONE;
+        std::vector<uint8_t> compressed;
+        const uint8_t* payload = chunk.data.data();
+        size_t payloadSize = chunk.data.size();
+
+        if (mCompress) {
+            uLongf compSize = compressBound(chunk.data.size());
+            compressed.resize(compSize);
+
+            // Best speed: the recorder must keep up with the grab rate
+            if (compress2(compressed.data(), &compSize, chunk.data.data(), chunk.data.size(),
+                          Z_BEST_SPEED) == Z_OK && compSize < chunk.data.size()) {
+                compression = COMPRESSION_ZLIB;
+                payload = compressed.data();
+                payloadSize = compSize;
+            }
+        }
+
+        std::vector<uint8_t> header(CHUNK_MAGIC, CHUNK_MAGIC + sizeof(CHUNK_MAGIC));
+        append<uint32_t>(header, compression);
+        append<uint32_t>(header, static_cast<uint32_t>(chunk.data.size()));
+        append<uint32_t>(header, static_cast<uint32_t>(payloadSize));
+        append<uint32_t>(header, chunk.records);
+        append<int64_t>(header, chunk.start);
+        append<int64_t>(header, chunk.end);
+
+        uint64_t offset = mWrittenBytes;
+
+        if (fwrite(header.data(), 1, header.size(), mFile) != header.size() ||
+            fwrite(payload, 1, payloadSize, mFile) != payloadSize) {
+            // Disk full: go back to the end of the last complete chunk, so that
+            // the partial chunk is overwritten by the next one (or truncated on
+            // close) and the offsets of the index stay valid. If the position
+            // cannot be restored the recorder stops writing
+            mDroppedChunks++;
+            clearerr(mFile);
+
+            if (fseeko(mFile, static_cast<off_t>(mWrittenBytes), SEEK_SET) != 0) {
+                mWriteFailed = true;
+            }
+
+            return;
+        }
+
+        mWrittenBytes += header.size() + payloadSize;
+
+        IndexEntry entry;
+        entry.offset = offset;
+        entry.start = chunk.start;
+        entry.end = chunk.end;
+        mIndex.push_back(entry);
+    }
+
+    // <---- CChunkRecorder
+
+    // ----> CChunkReader
+
+    CChunkReader::CChunkReader() {
+        mMap = nullptr;
+        mMapSize = 0;
+        mDataOffset = 0;
+        mIndexed = false;
+        mChunkIdx = 0;
+        mRawData = nullptr;
+        mRawSize = 0;
+        mRawPos = 0;
+    }
+
+    CChunkReader::~CChunkReader() {
+        close();
+    }
+
+    bool CChunkReader::open(const std::string& filename) {
+        close();
+
+        int fd = ::open(filename.c_str(), O_RDONLY);
+
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat st;
+
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(FILE_MAGIC) + 4)) {
+            ::close(fd);
+            return false;
+        }
+
+        void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        if (map == MAP_FAILED) {
+            return false;
+        }
+
+        mMap = static_cast<const uint8_t*>(map);
+        mMapSize = st.st_size;
+        madvise(map, mMapSize, MADV_SEQUENTIAL);
+
+        // ----> Header
+        if (memcmp(mMap, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+            close();
+            return false;
+        }
+
+        size_t pos = sizeof(FILE_MAGIC);
+        uint32_t chCount = extract<uint32_t>(mMap + pos);
+        pos += 4;
+
+        for (uint32_t i = 0; i < chCount; i++) {
+            RecChannel ch;
+
+            if (pos + 4 > mMapSize) {
+                close();
+                return false;
+            }
+
+            ch.id = extract<uint16_t>(mMap + pos);
+            pos += 2;
+
+            for (std::string* str : {&ch.name, &ch.datatype}) {
+                if (pos + 2 > mMapSize) {
+                    close();
+                    return false;
+                }
+
+                uint16_t len = extract<uint16_t>(mMap + pos);
+                pos += 2;
+
+                if (pos + len > mMapSize) {
+                    close();
+                    return false;
+                }
+
+                str->assign(reinterpret_cast<const char*>(mMap + pos), len);
+                pos += len;
+            }
+
+            mChannels.push_back(ch);
+        }
+
+        mDataOffset = pos;
+        // <---- Header
+
+        mIndexed = readIndex();
+
+        if (!mIndexed) {
+            // Recording not closed correctly: rebuild the index
+            scanChunks();
+        }
+
+        return true;
+    }
+
+    void CChunkReader::close() {
+        if (mMap) {
+            munmap(const_cast<uint8_t*>(mMap), mMapSize);
+        }
+
+        mMap = nullptr;
+        mMapSize = 0;
+        mChannels.clear();
+        mIndex.clear();
+        mIndexed = false;
+        mChunkIdx = 0;
+        mRaw.clear();
+        mRawData = nullptr;
+        mRawSize = 0;
+        mRawPos = 0;
+    }
+
+    bool CChunkReader::readIndex() {
+        if (mMapSize < mDataOffset + FOOTER_SIZE + 8 ||
+            memcmp(mMap + mMapSize - sizeof(END_MAGIC), END_MAGIC, sizeof(END_MAGIC)) != 0) {
+            return false;
+        }
+
+        uint64_t idxOffset = extract<uint64_t>(mMap + mMapSize - FOOTER_SIZE);
+
+        // Bounds checked by subtraction: the offsets read from the file may be corrupted and overflow
+        if (idxOffset < mDataOffset || idxOffset > mMapSize - FOOTER_SIZE - 8 ||
+            memcmp(mMap + idxOffset, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+            return false;
+        }
+
+        uint32_t count = extract<uint32_t>(mMap + idxOffset + 4);
+        const size_t entrySize = 3 * 8;
+
+        if (count > (mMapSize - FOOTER_SIZE - 8 - idxOffset) / entrySize) {
+            return false;
+        }
+
+        const uint8_t* p = mMap + idxOffset + 8;
+
+        for (uint32_t i = 0; i < count; i++, p += entrySize) {
+            IndexEntry entry;
+            entry.offset = extract<uint64_t>(p);
+            entry.start = extract<int64_t>(p + 8);
+            entry.end = extract<int64_t>(p + 16);
+            mIndex.push_back(entry);
+        }
+
+        return true;
+    }
+
+    void CChunkReader::scanChunks() {
+        size_t pos = mDataOffset;
+
+        while (pos + CHUNK_HEADER_SIZE <= mMapSize &&
+               memcmp(mMap + pos, CHUNK_MAGIC, sizeof(CHUNK_MAGIC)) == 0) {
+            uint32_t stored = extract<uint32_t>(mMap + pos + 12);
+
+            if (stored > mMapSize - CHUNK_HEADER_SIZE - pos) {
+                break; // Truncated chunk
+            }
+
+            IndexEntry entry;
+            entry.offset = pos;
+            entry.start = extract<int64_t>(mMap + pos + 20);
+            entry.end = extract<int64_t>(mMap + pos + 28);
+            mIndex.push_back(entry);
+
+            pos += CHUNK_HEADER_SIZE + stored;
+        }
+    }
+
+    int64_t CChunkReader::getStartTime() const {
+        int64_t start = 0;
+
+        for (size_t i = 0; i < mIndex.size(); i++) {
+            if (i == 0 || mIndex[i].start < start) {
+                start = mIndex[i].start;
+            }
+        }
+
+        return start;
+    }
+
+    int64_t CChunkReader::getEndTime() const {
+        int64_t end = 0;
+
+        for (size_t i = 0; i < mIndex.size(); i++) {
+            if (i == 0 || mIndex[i].end > end) {
+                end = mIndex[i].end;
+            }
+        }
+
+        return end;
+    }
+
+    bool CChunkReader::seek(int64_t stampNsec) {
+        mRawData = nullptr;
+        mRawSize = 0;
+        mRawPos = 0;
+
+        // Records are approximately ordered: stop at the first chunk that can contain the stamp
+        for (size_t i = 0; i < mIndex.size(); i++) {
+            if (mIndex[i].end >= stampNsec) {
+                mChunkIdx = i;
+                return true;
+            }
+        }
+
+        mChunkIdx = mIndex.size();
+        return false;
+    }
+
+    bool CChunkReader::loadChunk(size_t idx) {
+        uint64_t offset = mIndex[idx].offset;
+
+        if (mMapSize < CHUNK_HEADER_SIZE || offset > mMapSize - CHUNK_HEADER_SIZE) {
+            return false;
+        }
+
+        const uint8_t* p = mMap + offset;
+
+        if (memcmp(p, CHUNK_MAGIC, sizeof(CHUNK_MAGIC)) != 0) {
+            return false;
+        }
+
+        uint32_t compression = extract<uint32_t>(p + 4);
+        uint32_t rawSize = extract<uint32_t>(p + 8);
+        uint32_t stored = extract<uint32_t>(p + 12);
+
+        if (stored > mMapSize - CHUNK_HEADER_SIZE - offset) {
+            return false;
+        }
+
+        const uint8_t* payload = p + CHUNK_HEADER_SIZE;
+
+        if (compression == COMPRESSION_NONE) {
+            // Read directly from the mapped file
+            mRawData = payload;
+            mRawSize = stored;
+        } else if (compression == COMPRESSION_ZLIB) {
+            mRaw.resize(rawSize);
+            uLongf size = rawSize;
+
+            if (uncompress(mRaw.data(), &size, payload, stored) != Z_OK || size != rawSize) {
+                return false;
+            }
+
+            mRawData = mRaw.data();
+            mRawSize = rawSize;
+        } else {
+            return false;
+        }
+
+        mRawPos = 0;
+        return true;
+    }
+
+    bool CChunkReader::next(RecRecord& rec) {
+        while (!mRawData || mRawPos + RECORD_HEADER_SIZE > mRawSize) {
+            if (mChunkIdx >= mIndex.size()) {
+                return false;
+            }
+
+            if (!loadChunk(mChunkIdx++)) {
+                mRawData = nullptr; // Corrupted chunk: skip it
+            }
+        }
+
+        const uint8_t* p = mRawData + mRawPos;
+        uint32_t size = extract<uint32_t>(p + 10);
+
+        if (mRawPos + RECORD_HEADER_SIZE + size > mRawSize) {
+            mRawData = nullptr;
+            return next(rec);
+        }
+
+        rec.channel = extract<uint16_t>(p);
+        rec.stampNsec = extract<int64_t>(p + 2);
+        rec.size = size;
+        rec.data = p + RECORD_HEADER_SIZE;
+
+        mRawPos += RECORD_HEADER_SIZE + size;
+        return true;
+    }
+
+    // <---- CChunkReader
+
+} // namespace
@@ -0,0 +1,170 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_scan.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace sl_tools {
+
+    namespace {
+        /*!
+         * \brief rowMin
+         * Update the minimum depth of each column with a row of the depth map.
+         * Depths lower than the column threshold, NaN (occlusions) and -inf
+         * (too close) leave the minimum unchanged.
+         */
+        void rowMin(const float* row, const float* minDepth, float* colDepth, int width) {
+            int u = 0;
+
+#if defined(__SSE__)
+
+            for (; u + 4 <= width; u += 4) {
+                __m128 v = _mm_loadu_ps(row + u);
+                __m128 m = _mm_loadu_ps(colDepth + u);
+                __m128 valid = _mm_cmpge_ps(v, _mm_loadu_ps(minDepth + u));
+                __m128 cand = _mm_or_ps(_mm_and_ps(valid, v), _mm_andnot_ps(valid, m));
+                _mm_storeu_ps(colDepth + u, _mm_min_ps(m, cand));
+            }
+
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+            for (; u + 4 <= width; u += 4) {
+                float32x4_t v = vld1q_f32(row + u);
+                float32x4_t m = vld1q_f32(colDepth + u);
+                uint32x4_t valid = vcgeq_f32(v, vld1q_f32(minDepth + u));
+                vst1q_f32(colDepth + u, vminq_f32(m, vbslq_f32(valid, v, m)));
+            }
+
+#endif
+
+            for (; u < width; u++) {
+                float v = row[u];
+
+                if (v >= minDepth[u] && v < colDepth[u]) {
+                    colDepth[u] = v;
+                }
+            }
+        }
+    }
+
+    CDepthToScan::CDepthToScan() {
+        mScanHeight = 1;
+        mRowOffset = 0;
+        mRangeMin = 0.f;
+        mRangeMax = std::numeric_limits<float>::max();
+        mAngleIncrement = 0.f;
+
+        mTableWidth = 0;
+        mTableFx = 0.f;
+        mTableCx = 0.f;
+        mAngleMin = 0.f;
+        mAngleStep = 0.f;
+        mRayCount = 0;
+    }
+
+    void CDepthToScan::setParams(int scanHeight, int rowOffset, float rangeMin, float rangeMax, float angleIncrement) {
+        mScanHeight = std::max(scanHeight, 1);
+        mRowOffset = rowOffset;
+        mRangeMin = std::max(rangeMin, 0.f);
+        mRangeMax = std::max(rangeMax, mRangeMin);
+        mAngleIncrement = std::max(angleIncrement, 0.f);
+
+        mTableWidth = 0; // Force the update of the tables
+    }
+
+    void CDepthToScan::updateTables(int width, float fx, float cx) {
+        mTableWidth = width;
+        mTableFx = fx;
+        mTableCx = cx;
+
+        // The first ray is the rightmost column (angles grow counter-clockwise)
+        mAngleMin = std::atan2(cx - static_cast<float>(width - 1), fx);
+        float angleMax = std::atan2(cx, fx);
+
+        // The angular distance between two columns is never bigger than 1/fx:
+        // with this resolution no ray is left without a column
+        mAngleStep = mAngleIncrement > 0.f ? mAngleIncrement : 1.f / fx;
+        mRayCount = static_cast<size_t>(std::lround((angleMax - mAngleMin) / mAngleStep)) + 1;
+
+        mColRay.resize(width);
+        mColFactor.resize(width);
+        mColMinDepth.resize(width);
+
+        for (int u = 0; u < width; u++) {
+            float k = (static_cast<float>(u) - cx) / fx;
+            float angle = std::atan2(-k, 1.f);
+
+            long ray = std::lround((angle - mAngleMin) / mAngleStep);
+            mColRay[u] = static_cast<int>(std::min<long>(std::max<long>(ray, 0), static_cast<long>(mRayCount) - 1));
+            mColFactor[u] = std::sqrt(1.f + k * k);
+            mColMinDepth[u] = mRangeMin / mColFactor[u];
+        }
+    }
+
+    void CDepthToScan::convert(const float* depth, size_t step, int width, int height,
+                               float fx, float cx, float cy, sensor_msgs::LaserScan& scan) {
+        if (width != mTableWidth || fx != mTableFx || cx != mTableCx) {
+            updateTables(width, fx, cx);
+        }
+
+        // Minimum depth of each column in the band
+        mColDepth.assign(width, std::numeric_limits<float>::infinity());
+
+        int first = static_cast<int>(std::lround(cy)) + mRowOffset - mScanHeight / 2;
+        int last = std::min(first + mScanHeight, height);
+        first = std::max(first, 0);
+
+        const uint8_t* rowPtr = reinterpret_cast<const uint8_t*>(depth) + first * step;
+
+        for (int v = first; v < last; v++, rowPtr += step) {
+            rowMin(reinterpret_cast<const float*>(rowPtr), mColMinDepth.data(), mColDepth.data(), width);
+        }
+
+        scan.angle_min = mAngleMin;
+        scan.angle_max = mAngleMin + static_cast<float>(mRayCount - 1) * mAngleStep;
+        scan.angle_increment = mAngleStep;
+        scan.range_min = mRangeMin;
+        scan.range_max = mRangeMax;
+        scan.intensities.clear();
+
+        // No return: +inf (REP 117)
+        scan.ranges.assign(mRayCount, std::numeric_limits<float>::infinity());
+
+        for (int u = 0; u < width; u++) {
+            float range = mColDepth[u] * mColFactor[u];
+
+            if (range <= mRangeMax) {
+                float& ray = scan.ranges[mColRay[u]];
+                ray = std::min(ray, range);
+            }
+        }
+    }
+
+} // namespace
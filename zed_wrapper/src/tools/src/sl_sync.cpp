@@ -0,0 +1,166 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_sync.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace sl_tools {
+
+    namespace {
+        const size_t MAX_BUNDLES = 64; ///< Older bundles cannot receive frames anymore
+        const std::chrono::seconds INACTIVE_TIMEOUT(1);
+    }
+
+    CFrameSynchronizer::CFrameSynchronizer(int64_t toleranceNsec) {
+        mTolerance = std::max<int64_t>(toleranceNsec, 0);
+        mNextBundleId = 1;
+    }
+
+    int CFrameSynchronizer::addCamera(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        Camera cam;
+        cam.name = name;
+        cam.active = true;
+        cam.lastFrame = std::chrono::steady_clock::time_point();
+        mCameras.push_back(cam);
+
+        return static_cast<int>(mCameras.size()) - 1;
+    }
+
+    void CFrameSynchronizer::removeCamera(int id) {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            if (id >= 0 && id < static_cast<int>(mCameras.size())) {
+                mCameras[id].active = false;
+            }
+        }
+
+        mCondVar.notify_all();
+    }
+
+    int CFrameSynchronizer::expectedCameras(std::chrono::steady_clock::time_point now) const {
+        int count = 0;
+
+        for (const auto& cam : mCameras) {
+            if (cam.active && now - cam.lastFrame < INACTIVE_TIMEOUT) {
+                count++;
+            }
+        }
+
+        return count;
+    }
+
+    CFrameSynchronizer::Bundle* CFrameSynchronizer::findBundle(uint64_t id) {
+        for (auto& bundle : mBundles) {
+            if (bundle.id == id) {
+                return &bundle;
+            }
+        }
+
+        return nullptr;
+    }
+
+    SyncResult CFrameSynchronizer::addFrame(int id, int64_t stampNsec, int64_t maxWaitNsec) {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        if (id >= 0 && id < static_cast<int>(mCameras.size())) {
+            mCameras[id].lastFrame = now;
+        }
+
+        // ----> Join the nearest bundle without a frame of this camera
+        Bundle* bundle = nullptr;
+        int64_t bestDiff = mTolerance;
+
+        for (auto& b : mBundles) {
+            int64_t diff = std::llabs(b.refStamp - stampNsec);
+
+            if (diff <= bestDiff && std::find(b.cameras.begin(), b.cameras.end(), id) == b.cameras.end()) {
+                bestDiff = diff;
+                bundle = &b;
+            }
+        }
+
+        if (!bundle) {
+            Bundle b;
+            b.id = mNextBundleId++;
+            b.refStamp = stampNsec;
+            b.minStamp = stampNsec;
+            b.maxStamp = stampNsec;
+            mBundles.push_back(b);
+
+            if (mBundles.size() > MAX_BUNDLES) {
+                mBundles.pop_front();
+            }
+
+            bundle = &mBundles.back();
+        }
+
+        bundle->cameras.push_back(id);
+        bundle->minStamp = std::min(bundle->minStamp, stampNsec);
+        bundle->maxStamp = std::max(bundle->maxStamp, stampNsec);
+        uint64_t bundleId = bundle->id;
+        // <---- Join the nearest bundle without a frame of this camera
+
+        mCondVar.notify_all();
+
+        // ----> Wait for the other cameras
+        std::chrono::steady_clock::time_point deadline = now + std::chrono::nanoseconds(std::max<int64_t>(maxWaitNsec, 0));
+
+        while (true) {
+            bundle = findBundle(bundleId);
+
+            if (!bundle || static_cast<int>(bundle->cameras.size()) >= expectedCameras(std::chrono::steady_clock::now())) {
+                break;
+            }
+
+            if (mCondVar.wait_until(lock, deadline) == std::cv_status::timeout) {
+                bundle = findBundle(bundleId);
+                break;
+            }
+        }
+        // <---- Wait for the other cameras
+
+        SyncResult res;
+        res.bundleId = bundleId;
+        res.expected = expectedCameras(std::chrono::steady_clock::now());
+
+        if (bundle) {
+            res.stampNsec = bundle->refStamp;
+            res.skewNsec = bundle->maxStamp - bundle->minStamp;
+            res.members = static_cast<int>(bundle->cameras.size());
+        } else {
+            // Bundle discarded while waiting (very slow camera): not synchronized
+            res.stampNsec = stampNsec;
+            res.skewNsec = 0;
+            res.members = 1;
+        }
+
+        res.complete = res.members >= res.expected;
+
+        return res;
+    }
+
+} // namespace
@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_tf.h"
+
+#include <tf2_geometry_msgs/tf2_geometry_msgs.h>
+
+namespace sl_tools {
+
+    geometry_msgs::TransformStamped transformToROSmsg(const tf2::Transform& transf, const std::string& parentFrameId,
+            const std::string& childFrameId, ros::Time t) {
+        geometry_msgs::TransformStamped transformStamped;
+        transformStamped.header.stamp = t;
+        transformStamped.header.frame_id = parentFrameId;
+        transformStamped.child_frame_id = childFrameId;
+        // conversion from Tranform to message
+        transformStamped.transform = tf2::toMsg(transf);
+        return transformStamped;
+    }
+
+    std::vector<geometry_msgs::TransformStamped> frameTransforms(const tf2::Transform& odom2base,
+            const tf2::Transform& map2odom, bool publishMapTf,
+            const std::string& mapFrameId, const std::string& odomFrameId,
+            const std::string& baseFrameId, ros::Time t) {
+        std::vector<geometry_msgs::TransformStamped> transforms;
+        transforms.reserve(2);
+
+        transforms.push_back(transformToROSmsg(odom2base, odomFrameId, baseFrameId, t));
+
+        if (publishMapTf) {
+            transforms.push_back(transformToROSmsg(map2odom, mapFrameId, odomFrameId, t));
+        }
+
+        return transforms;
+    }
+
+} // namespace
@@ -20,8 +20,10 @@
 
 #include "sl_tools.h"
 
+#include <cmath>
 #include <sstream>
 #include <sys/stat.h>
+#include <sys/statvfs.h>
 #include <vector>
 
 #include <sensor_msgs/image_encodings.h>
@@ -137,6 +139,45 @@ namespace sl_tools {
         return (stat(name.c_str(), &buffer) == 0);
     }
 
+    uint64_t file_size(const std::string& name) {
+        struct stat buffer;
+
+        if (stat(name.c_str(), &buffer) != 0) {
+            return 0;
+        }
+
+        return static_cast<uint64_t>(buffer.st_size);
+    }
+
+    bool make_dir(const std::string& path) {
+        if (path.empty()) {
+            return false;
+        }
+
+        size_t pos = 0;
+
+        do {
+            pos = path.find('/', pos + 1);
+            std::string sub = path.substr(0, pos);
+
+            if (!file_exist(sub) && mkdir(sub.c_str(), 0775) != 0) {
+                return false;
+            }
+        } while (pos != std::string::npos);
+
+        return true;
+    }
+
+    uint64_t free_disk_space(const std::string& path) {
+        struct statvfs buffer;
+
+        if (statvfs(path.c_str(), &buffer) != 0) {
+            return 0;
+        }
+
+        return static_cast<uint64_t>(buffer.f_bavail) * buffer.f_frsize;
+    }
+
     std::string getSDKVersion(int& major, int& minor, int& sub_minor) {
         std::string ver = sl::Camera::getSDKVersion().c_str();
         std::vector<std::string> strings;
@@ -373,4 +414,267 @@ namespace sl_tools {
         return mMean;
     }
 
+    CLatencyHistogram::CLatencyHistogram() {
+        reset();
+    }
+
+    int CLatencyHistogram::bucketIndex(uint64_t val) {
+        if (val < SUB_BUCKETS) {
+            return static_cast<int>(val);
+        }
+
+        // Position of the most significant bit
+        int msb = 0;
+
+        for (uint64_t v = val; v > 1; v >>= 1) {
+            msb++;
+        }
+
+        int shift = msb - SUB_BUCKET_BITS;
+
+        if (shift > MAX_SHIFT) {
+            return BUCKET_COUNT - 1;
+        }
+
+        int sub = static_cast<int>(val >> shift) - SUB_BUCKETS;
+
+        return (shift + 1) * SUB_BUCKETS + sub;
+    }
+
+    int64_t CLatencyHistogram::bucketHighest(int idx) {
+        if (idx < SUB_BUCKETS) {
+            return idx;
+        }
+
+        int shift = idx / SUB_BUCKETS - 1;
+        int64_t sub = idx % SUB_BUCKETS;
+
+        return ((SUB_BUCKETS + sub + 1) << shift) - 1;
+    }
+
+    void CLatencyHistogram::addValue(int64_t val) {
+        if (val < 0) {
+            val = 0;
+        }
+
+        mBuckets[bucketIndex(static_cast<uint64_t>(val))].fetch_add(1, std::memory_order_relaxed);
+        mSum.fetch_add(static_cast<uint64_t>(val), std::memory_order_relaxed);
+        mCount.fetch_add(1, std::memory_order_relaxed);
+
+        int64_t max = mMax.load(std::memory_order_relaxed);
+
+        while (val > max && !mMax.compare_exchange_weak(max, val, std::memory_order_relaxed)) {
+        }
+    }
+
+    void CLatencyHistogram::reset() {
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            mBuckets[i].store(0, std::memory_order_relaxed);
+        }
+
+        mCount.store(0, std::memory_order_relaxed);
+        mSum.store(0, std::memory_order_relaxed);
+        mMax.store(0, std::memory_order_relaxed);
+    }
+
+    double CLatencyHistogram::getMean() const {
+        uint64_t count = mCount.load(std::memory_order_relaxed);
+
+        if (count == 0) {
+            return 0.0;
+        }
+
+        return static_cast<double>(mSum.load(std::memory_order_relaxed)) / count;
+    }
+
+    int64_t CLatencyHistogram::getPercentile(double perc) const {
+        // The buckets are read one by one while values can still be added:
+        // the total is evaluated on the same snapshot
+        uint64_t counts[BUCKET_COUNT];
+
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            counts[i] = mBuckets[i].load(std::memory_order_relaxed);
+        }
+
+        return percentile(counts, perc, getMax());
+    }
+
+    int64_t CLatencyHistogram::percentile(const uint64_t* counts, double perc, int64_t max) {
+        uint64_t total = 0;
+
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            total += counts[i];
+        }
+
+        if (total == 0) {
+            return 0;
+        }
+
+        perc = std::min(std::max(perc, 0.0), 100.0);
+        uint64_t target = static_cast<uint64_t>(std::ceil(perc / 100. * total));
+        target = std::max<uint64_t>(target, 1);
+
+        uint64_t acc = 0;
+
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            acc += counts[i];
+
+            if (acc >= target) {
+                return std::min(bucketHighest(i), max);
+            }
+        }
+
+        return max;
+    }
+
+    CLatencyWindow::CLatencyWindow()
+        : mPrevBuckets(CLatencyHistogram::BUCKET_COUNT, 0), mBuckets(CLatencyHistogram::BUCKET_COUNT, 0) {
+        mPrevSum = 0;
+        mPrevCount = 0;
+        mCount = 0;
+        mSum = 0;
+        mMax = 0;
+    }
+
+    void CLatencyWindow::update(const CLatencyHistogram& hist) {
+        uint64_t sum = hist.mSum.load(std::memory_order_relaxed);
+        uint64_t count = hist.getValCount();
+
+        // The histogram has been reset: the window starts from the reset
+        bool reset = sum < mPrevSum || count < mPrevCount;
+
+        for (int i = 0; i < CLatencyHistogram::BUCKET_COUNT; i++) {
+            uint64_t bucket = hist.mBuckets[i].load(std::memory_order_relaxed);
+
+            if (reset || bucket < mPrevBuckets[i]) {
+                mPrevBuckets[i] = 0;
+            }
+
+            mBuckets[i] = bucket - mPrevBuckets[i];
+            mPrevBuckets[i] = bucket;
+        }
+
+        mSum = reset ? sum : sum - mPrevSum;
+        mPrevSum = sum;
+        mPrevCount = count;
+
+        mCount = 0;
+        mMax = 0;
+
+        for (int i = 0; i < CLatencyHistogram::BUCKET_COUNT; i++) {
+            if (mBuckets[i] > 0) {
+                mCount += mBuckets[i];
+                mMax = CLatencyHistogram::bucketHighest(i);
+            }
+        }
+
+        // The highest bucket can exceed the maximum ever recorded value
+        mMax = std::min(mMax, hist.getMax());
+    }
+
+    double CLatencyWindow::getMean() const {
+        if (mCount == 0) {
+            return 0.0;
+        }
+
+        return static_cast<double>(mSum) / mCount;
+    }
+
+    int64_t CLatencyWindow::getPercentile(double perc) const {
+        return CLatencyHistogram::percentile(mBuckets.data(), perc, mMax);
+    }
+
+    CWorkerPool::CWorkerPool(unsigned int threads) {
+        mStop = false;
+
+        for (unsigned int i = 0; i < std::max(threads, 1u); i++) {
+            mThreads.emplace_back(&CWorkerPool::workerFunc, this);
+        }
+    }
+
+    CWorkerPool::~CWorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mJobsMutex);
+            mStop = true;
+        }
+
+        mJobsCondVar.notify_all();
+
+        for (auto& th : mThreads) {
+            if (th.joinable()) {
+                th.join();
+            }
+        }
+    }
+
+    void CWorkerPool::post(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mJobsMutex);
+            mJobs.push_back(std::move(job));
+        }
+
+        mJobsCondVar.notify_one();
+    }
+
+    size_t CWorkerPool::getQueueSize() {
+        std::lock_guard<std::mutex> lock(mJobsMutex);
+        return mJobs.size();
+    }
+
+    void CWorkerPool::workerFunc() {
+        while (true) {
+            std::function<void()> job;
+
+            {
+                std::unique_lock<std::mutex> lock(mJobsMutex);
+                mJobsCondVar.wait(lock, [this] {
+                    return mStop || !mJobs.empty();
+                });
+
+                if (mJobs.empty()) {
+                    return; // Stopped and no more jobs
+                }
+
+                job = std::move(mJobs.front());
+                mJobs.pop_front();
+            }
+
+            job();
+        }
+    }
+
+    CThreadBudget::CThreadBudget(int threads)
+        : mThreads(std::max(threads, 1)), mAvailable(std::max(threads, 1)) {
+    }
+
+    int CThreadBudget::acquire(int wanted) {
+        int available = mAvailable.load(std::memory_order_relaxed);
+        int taken = 0;
+
+        do {
+            taken = std::max(std::min(wanted, available), 0);
+        } while (taken > 0 && !mAvailable.compare_exchange_weak(available, available - taken));
+
+        return taken;
+    }
+
+    void CThreadBudget::release(int threads) {
+        if (threads > 0) {
+            mAvailable.fetch_add(threads);
+        }
+    }
+
+    CThreadLease::CThreadLease(const std::shared_ptr<CThreadBudget>& budget, int wanted)
+        : mBudget(budget), mTaken(0) {
+        if (mBudget) {
+            mTaken = mBudget->acquire(wanted > 0 ? wanted : mBudget->getThreadCount());
+        }
+    }
+
+    CThreadLease::~CThreadLease() {
+        if (mBudget) {
+            mBudget->release(mTaken);
+        }
+    }
+
 } // namespace
@@ -0,0 +1,189 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_trace.h"
+
+#include <chrono>
+#include <fstream>
+
+namespace sl_tools {
+
+    namespace {
+        std::atomic<uint64_t> gTracerCount(0);
+
+        // Per thread cache of the buffers used with the latest tracers, so that
+        // shared threads (e.g. nodelet manager threads serving several cameras)
+        // do not look for their buffer at each event
+        const int TRACE_CACHE_SIZE = 4;
+
+        struct TraceCache {
+            uint64_t instanceId[TRACE_CACHE_SIZE] = {};
+            void* buffer[TRACE_CACHE_SIZE] = {};
+            int next = 0; ///< Entry replaced by the next tracer
+        };
+
+        thread_local TraceCache tCache;
+    }
+
+    CTracer::CTracer(size_t eventsPerThread) {
+        mEnabled = false;
+        mSaving = false;
+        mEventsPerThread = eventsPerThread > 0 ? eventsPerThread : 1;
+        mInstanceId = ++gTracerCount;
+    }
+
+    void CTracer::setEnabled(bool enable) {
+        if (enable && !isEnabled()) {
+            std::lock_guard<std::mutex> lock(mBuffersMutex);
+
+            // Recording is stopped: clear the buffers once the last events are written
+            waitWriters();
+
+            for (auto& buf : mBuffers) {
+                buf->count.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        mEnabled.store(enable);
+    }
+
+    void CTracer::waitWriters() const {
+        for (const auto& buf : mBuffers) {
+            while (buf->writing.load()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    int64_t CTracer::now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    CTracer::ThreadBuffer* CTracer::getThreadBuffer() {
+        for (int i = 0; i < TRACE_CACHE_SIZE; i++) {
+            if (tCache.instanceId[i] == mInstanceId) {
+                return static_cast<ThreadBuffer*>(tCache.buffer[i]);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mBuffersMutex);
+
+        // The thread may have used this tracer before its cache entry was
+        // replaced: look for its buffer
+        ThreadBuffer* found = nullptr;
+
+        for (auto& buf : mBuffers) {
+            if (buf->thread == std::this_thread::get_id()) {
+                found = buf.get();
+                break;
+            }
+        }
+
+        // First event of this thread: register a new buffer
+        if (!found) {
+            std::unique_ptr<ThreadBuffer> buf(new ThreadBuffer);
+            buf->events.resize(mEventsPerThread);
+            buf->count = 0;
+            buf->writing = false;
+            buf->tid = static_cast<int>(mBuffers.size()) + 1;
+            buf->thread = std::this_thread::get_id();
+            found = buf.get();
+            mBuffers.push_back(std::move(buf));
+        }
+
+        tCache.instanceId[tCache.next] = mInstanceId;
+        tCache.buffer[tCache.next] = found;
+        tCache.next = (tCache.next + 1) % TRACE_CACHE_SIZE;
+
+        return found;
+    }
+
+    void CTracer::record(const char* name, int64_t startNsec, int64_t durNsec, uint64_t frame) {
+        ThreadBuffer* buf = getThreadBuffer();
+
+        // Sequentially consistent flag and gate: `setEnabled` and `saveChromeTrace`
+        // close the gate, then wait for `writing` to be false
+        buf->writing.store(true);
+
+        if (mEnabled.load() && !mSaving.load()) {
+            uint64_t idx = buf->count.load(std::memory_order_relaxed);
+
+            TraceEvent& ev = buf->events[idx % mEventsPerThread];
+            ev.name = name;
+            ev.startNsec = startNsec;
+            ev.durNsec = durNsec;
+            ev.frame = frame;
+
+            buf->count.store(idx + 1, std::memory_order_relaxed);
+        }
+
+        buf->writing.store(false, std::memory_order_release);
+    }
+
+    int CTracer::saveChromeTrace(const std::string& filename) const {
+        std::ofstream out(filename.c_str());
+
+        if (!out.is_open()) {
+            return -1;
+        }
+
+        std::lock_guard<std::mutex> lock(mBuffersMutex);
+
+        mSaving.store(true);
+        waitWriters();
+
+        int saved = 0;
+
+        out << "{\"traceEvents\":[\n";
+
+        for (const auto& buf : mBuffers) {
+            uint64_t count = buf->count.load(std::memory_order_relaxed);
+            uint64_t first = count > mEventsPerThread ? count - mEventsPerThread : 0;
+
+            for (uint64_t i = first; i < count; i++) {
+                const TraceEvent& ev = buf->events[i % mEventsPerThread];
+
+                if (saved > 0) {
+                    out << ",\n";
+                }
+
+                out << "{\"name\":\"" << ev.name << "\",\"cat\":\"zed\",\"ph\":\"X\""
+                    << ",\"ts\":" << (ev.startNsec / 1000) << "." << ((ev.startNsec % 1000) / 100)
+                    << ",\"dur\":" << (ev.durNsec / 1000) << "." << ((ev.durNsec % 1000) / 100)
+                    << ",\"pid\":1,\"tid\":" << buf->tid
+                    << ",\"args\":{\"frame\":" << ev.frame << "}}";
+
+                saved++;
+            }
+        }
+
+        out << "\n]}\n";
+
+        mSaving.store(false);
+
+        if (!out.good()) {
+            return -1;
+        }
+
+        return saved;
+    }
+
+} // namespace
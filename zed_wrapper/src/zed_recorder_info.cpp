@@ -0,0 +1,87 @@
+// /////////////////////////////////////////////////////////////////////////
+
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// /////////////////////////////////////////////////////////////////////////
+
+// Print the content of a file written by the wrapper recorder
+// (see sl_tools::CChunkRecorder)
+//
+// Usage: zed_recorder_info <file> [--dump]
+//  --dump : print timestamp, channel and size of each record
+
+#include "sl_recorder.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <map>
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <file> [--dump]\n", argv[0]);
+        return 1;
+    }
+
+    bool dump = (argc > 2 && strcmp(argv[2], "--dump") == 0);
+
+    sl_tools::CChunkReader reader;
+
+    if (!reader.open(argv[1])) {
+        fprintf(stderr, "Cannot open '%s' or the file is not a valid recording\n", argv[1]);
+        return 1;
+    }
+
+    struct ChannelStats {
+        uint64_t count = 0;
+        uint64_t bytes = 0;
+    };
+
+    std::map<uint16_t, ChannelStats> stats;
+
+    sl_tools::RecRecord rec;
+
+    while (reader.next(rec)) {
+        ChannelStats& st = stats[rec.channel];
+        st.count++;
+        st.bytes += rec.size;
+
+        if (dump) {
+            printf("%" PRId64 ".%09" PRId64 "\t%u\t%u\n", rec.stampNsec / 1000000000,
+                   rec.stampNsec % 1000000000, rec.channel, rec.size);
+        }
+    }
+
+    double duration = (reader.getEndTime() - reader.getStartTime()) / 1e9;
+
+    printf("File:      %s\n", argv[1]);
+    printf("Index:     %s\n", reader.isIndexed() ? "yes" : "no (recording not closed, index rebuilt)");
+    printf("Chunks:    %zu\n", reader.getChunkCount());
+    printf("Start:     %.6f\n", reader.getStartTime() / 1e9);
+    printf("End:       %.6f\n", reader.getEndTime() / 1e9);
+    printf("Duration:  %.3f sec\n", duration);
+    printf("Channels:\n");
+
+    for (const auto& ch : reader.getChannels()) {
+        const ChannelStats& st = stats[ch.id];
+        printf("  %-30s %-32s %10" PRIu64 " msgs %10.2f MB %8.2f Hz\n", ch.name.c_str(), ch.datatype.c_str(),
+               st.count, st.bytes / 1048576.0, duration > 0 ? st.count / duration : 0.0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,167 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_tools.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+namespace {
+
+    // Runtime remapping used by the wrapper before `sl_tools::AxisRemap`
+    struct RuntimeRemap {
+        int idxX, idxY, idxZ;
+        int signX, signY, signZ;
+
+        void vector(const float* in, double* out) const {
+            out[0] = signX * in[idxX];
+            out[1] = signY * in[idxY];
+            out[2] = signZ * in[idxZ];
+        }
+
+        void covariance(const float* in, double* out, double scale) const {
+            for (int i = 0; i < 3; ++i) {
+                int r = 0;
+
+                if (i == 0) {
+                    r = idxX;
+                } else if (i == 1) {
+                    r = idxY;
+                } else {
+                    r = idxZ;
+                }
+
+                out[i * 3 + 0] = in[r * 3 + idxX] * scale;
+                out[i * 3 + 1] = in[r * 3 + idxY] * scale;
+                out[i * 3 + 2] = in[r * 3 + idxZ] * scale;
+            }
+        }
+    };
+
+    template <typename Remap>
+    void checkRemap(const RuntimeRemap& ref) {
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<float> dist(-10.f, 10.f);
+
+        for (int n = 0; n < 1000; ++n) {
+            float v[4];
+            float cov[9];
+
+            for (int i = 0; i < 4; ++i) {
+                v[i] = dist(gen);
+            }
+
+            for (int i = 0; i < 9; ++i) {
+                cov[i] = dist(gen);
+            }
+
+            double expected[9];
+            ref.vector(v, expected);
+            EXPECT_EQ(expected[0], Remap::x(v));
+            EXPECT_EQ(expected[1], Remap::y(v));
+            EXPECT_EQ(expected[2], Remap::z(v));
+
+            const double scale = 0.0174532925199 * 0.0174532925199;
+            double out[9];
+            ref.covariance(cov, expected, scale);
+            Remap::covariance(cov, out, scale);
+
+            for (int i = 0; i < 9; ++i) {
+                EXPECT_EQ(expected[i], out[i]) << "covariance element " << i;
+            }
+        }
+    }
+
+} // namespace
+
+TEST(AxisRemap, ImageMatchesRuntimeRemap) {
+    checkRemap<sl_tools::ImageAxisRemap>({2, 0, 1, 1, -1, -1});
+}
+
+TEST(AxisRemap, RightHandedZUpMatchesRuntimeRemap) {
+    checkRemap<sl_tools::RightHandedZUpRemap>({1, 0, 2, 1, -1, 1});
+}
+
+TEST(AxisRemap, RightHandedZUpXFwdMatchesRuntimeRemap) {
+    checkRemap<sl_tools::RightHandedZUpXFwdRemap>({0, 1, 2, 1, 1, 1});
+}
+
+// Per-sample cost of a full IMU sample conversion (3 vectors, 3 covariances)
+TEST(AxisRemap, DISABLED_Benchmark) {
+    const int samples = 200000;
+    std::vector<float> in(samples * 36);
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+    for (size_t i = 0; i < in.size(); ++i) {
+        in[i] = dist(gen);
+    }
+
+    // Read the indices from a volatile source, as the old members were
+    volatile int idx[6] = {2, 0, 1, 1, -1, -1};
+    RuntimeRemap ref = {idx[0], idx[1], idx[2], idx[3], idx[4], idx[5]};
+
+    double out[9];
+    double sink = 0.0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int n = 0; n < samples; ++n) {
+        const float* s = &in[n * 36];
+
+        for (int k = 0; k < 3; ++k) {
+            ref.vector(s + k * 3, out);
+            sink += out[0] + out[1] + out[2];
+            ref.covariance(s + 9 + k * 9, out, 1.0);
+            sink += out[4];
+        }
+    }
+
+    auto mid = std::chrono::steady_clock::now();
+
+    for (int n = 0; n < samples; ++n) {
+        const float* s = &in[n * 36];
+
+        for (int k = 0; k < 3; ++k) {
+            const float* v = s + k * 3;
+            sink += sl_tools::ImageAxisRemap::x(v) + sl_tools::ImageAxisRemap::y(v) +
+                    sl_tools::ImageAxisRemap::z(v);
+            sl_tools::ImageAxisRemap::covariance(s + 9 + k * 9, out, 1.0);
+            sink += out[4];
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    double runtimeNs = std::chrono::duration<double, std::nano>(mid - start).count() / samples;
+    double templNs = std::chrono::duration<double, std::nano>(end - mid).count() / samples;
+
+    printf("IMU sample remap: runtime %.1f ns, AxisRemap %.1f ns (checksum %g)\n", runtimeNs, templNs, sink);
+    RecordProperty("runtime_ns", static_cast<int>(runtimeNs * 1000));
+    RecordProperty("axis_remap_ns", static_cast<int>(templNs * 1000));
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,223 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "zed_wrapper/sl_depth_codec.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+    const float QUANTIZATION = 0.001f;
+
+    // Smooth depth with invalid pixels and out of range values, `pad` floats after each row
+    std::vector<float> makeDepth(int width, int height, int pad) {
+        std::vector<float> depth(static_cast<size_t>(width + pad) * height, -1.f);
+        std::mt19937 gen(3);
+        std::uniform_real_distribution<float> noise(-0.002f, 0.002f);
+
+        for (int v = 0; v < height; v++) {
+            for (int u = 0; u < width; u++) {
+                float d = 1.5f + 0.01f * u + 0.02f * v + noise(gen);
+
+                if ((u * 7 + v * 13) % 97 == 0) {
+                    d = std::numeric_limits<float>::quiet_NaN();
+                } else if ((u + v) % 211 == 0) {
+                    d = std::numeric_limits<float>::infinity();
+                } else if ((u * 3 + v) % 307 == 0) {
+                    d = 100.f; // Beyond the 65.5 m range of 1 mm quantization
+                }
+
+                depth[static_cast<size_t>(v) * (width + pad) + u] = d;
+            }
+        }
+
+        return depth;
+    }
+
+    void checkRoundTrip(int width, int height, int bandRows) {
+        const int pad = 3;
+        std::vector<float> depth = makeDepth(width, height, pad);
+
+        std::vector<uint8_t> encoded;
+        ASSERT_TRUE(sl_tools::encodeDepth(depth.data(), (width + pad) * sizeof(float), width, height, QUANTIZATION,
+                                          bandRows, encoded));
+
+        std::vector<float> decoded;
+        int w = 0;
+        int h = 0;
+        ASSERT_TRUE(sl_tools::decodeDepth(encoded.data(), encoded.size(), decoded, w, h));
+        ASSERT_EQ(width, w);
+        ASSERT_EQ(height, h);
+
+        for (int v = 0; v < height; v++) {
+            for (int u = 0; u < width; u++) {
+                float in = depth[static_cast<size_t>(v) * (width + pad) + u];
+                float out = decoded[static_cast<size_t>(v) * width + u];
+
+                if (std::isfinite(in) && in > 0.f && in <= 65535.f * QUANTIZATION) {
+                    // Half a step, plus the float rounding of the quantization
+                    ASSERT_NEAR(in, out, 0.5f * QUANTIZATION + in * 1e-6f) << "pixel " << u << "," << v;
+                } else {
+                    ASSERT_TRUE(std::isnan(out)) << "pixel " << u << "," << v;
+                }
+            }
+        }
+    }
+
+    std::vector<uint8_t> encodeSample(int width, int height, int bandRows) {
+        std::vector<float> depth = makeDepth(width, height, 0);
+        std::vector<uint8_t> encoded;
+        sl_tools::encodeDepth(depth.data(), width * sizeof(float), width, height, QUANTIZATION, bandRows, encoded);
+        return encoded;
+    }
+
+    void setHeaderField(std::vector<uint8_t>& encoded, size_t offset, uint32_t val) {
+        memcpy(&encoded[offset], &val, sizeof(val));
+    }
+
+    bool decodes(const std::vector<uint8_t>& encoded) {
+        std::vector<float> decoded;
+        int w = 0;
+        int h = 0;
+        return sl_tools::decodeDepth(encoded.data(), encoded.size(), decoded, w, h);
+    }
+
+} // namespace
+
+TEST(DepthCodec, RoundTripIsWithinQuantization) {
+    checkRoundTrip(672, 376, 16);
+    checkRoundTrip(1280, 720, 32);
+    checkRoundTrip(17, 5, 2);
+}
+
+TEST(DepthCodec, BandsDecodeAsSingleBand) {
+    std::vector<uint8_t> single = encodeSample(640, 360, 360);
+    std::vector<uint8_t> bands = encodeSample(640, 360, 7);
+
+    std::vector<float> a;
+    std::vector<float> b;
+    int w = 0;
+    int h = 0;
+    ASSERT_TRUE(sl_tools::decodeDepth(single.data(), single.size(), a, w, h));
+    ASSERT_TRUE(sl_tools::decodeDepth(bands.data(), bands.size(), b, w, h));
+    ASSERT_EQ(a.size(), b.size());
+    EXPECT_EQ(0, memcmp(a.data(), b.data(), a.size() * sizeof(float)));
+}
+
+TEST(DepthCodec, RejectsInvalidInput) {
+    std::vector<float> depth(4, 1.f);
+    std::vector<uint8_t> encoded;
+
+    EXPECT_FALSE(sl_tools::encodeDepth(depth.data(), 2 * sizeof(float), 0, 2, QUANTIZATION, 1, encoded));
+    EXPECT_FALSE(sl_tools::encodeDepth(depth.data(), 2 * sizeof(float), 2, 2, 0.f, 1, encoded));
+    EXPECT_FALSE(sl_tools::encodeDepth(depth.data(), 2 * sizeof(float), 65536, 1, QUANTIZATION, 1, encoded));
+}
+
+// Corrupted headers are rejected before allocating on their values
+TEST(DepthCodec, RejectsCorruptedHeader) {
+    const std::vector<uint8_t> valid = encodeSample(64, 48, 8);
+    ASSERT_TRUE(decodes(valid));
+
+    std::vector<uint8_t> data = valid;
+    data[0] = 'X';
+    EXPECT_FALSE(decodes(data));
+
+    // Huge width/height
+    data = valid;
+    setHeaderField(data, 4, 0xFFFFFFFF);
+    EXPECT_FALSE(decodes(data));
+    data = valid;
+    setHeaderField(data, 8, 0xFFFFFFFF);
+    EXPECT_FALSE(decodes(data));
+
+    // `h + bandRows - 1` overflowing to the declared band count
+    data = valid;
+    setHeaderField(data, 12, 0xFFFFFFFF);
+    setHeaderField(data, 16, 0);
+    EXPECT_FALSE(decodes(data));
+
+    // Valid limits, but far more pixels than the compressed data can hold
+    data = valid;
+    setHeaderField(data, 4, 65535);
+    setHeaderField(data, 8, 65535);
+    setHeaderField(data, 12, 65535);
+    setHeaderField(data, 16, 1);
+    EXPECT_FALSE(decodes(data));
+
+    // Truncated data
+    data = valid;
+    data.resize(data.size() - 10);
+    EXPECT_FALSE(decodes(data));
+    data.resize(10);
+    EXPECT_FALSE(decodes(data));
+
+    // Corrupted compressed data
+    data = valid;
+    data[data.size() / 2] ^= 0xFF;
+    data[data.size() / 2 + 1] ^= 0xFF;
+    EXPECT_FALSE(decodes(data));
+}
+
+// Encoding/decoding time and compression of a VGA depth map
+TEST(DepthCodec, DISABLED_Benchmark) {
+    const int width = 672;
+    const int height = 376;
+    const int iterations = 20;
+    std::vector<float> depth = makeDepth(width, height, 0);
+    std::vector<uint8_t> encoded;
+    std::vector<float> decoded;
+    int w = 0;
+    int h = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; ++i) {
+        sl_tools::encodeDepth(depth.data(), width * sizeof(float), width, height, QUANTIZATION, 16, encoded);
+    }
+
+    auto mid = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; ++i) {
+        sl_tools::decodeDepth(encoded.data(), encoded.size(), decoded, w, h);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    double encMs = std::chrono::duration<double, std::milli>(mid - start).count() / iterations;
+    double decMs = std::chrono::duration<double, std::milli>(end - mid).count() / iterations;
+    double ratio = static_cast<double>(depth.size() * sizeof(float)) / encoded.size();
+
+    printf("Depth codec %dx%d: encode %.2f ms, decode %.2f ms, ratio %.1f\n", width, height, encMs, decMs, ratio);
+    RecordProperty("encode_us", static_cast<int>(encMs * 1000));
+    RecordProperty("decode_us", static_cast<int>(decMs * 1000));
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,194 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_elevation.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+namespace {
+
+    const int WIDTH = 1280;
+    const int HEIGHT = 720;
+    const float FX = 700.f;
+    const float CX = 0.5f * WIDTH;
+    const float CY = 0.5f * HEIGHT;
+    const float CAM_HEIGHT = 1.f;
+
+    // Camera at `CAM_HEIGHT` over a flat floor, looking along X (not optical frame)
+    std::vector<float> makeFloorDepth() {
+        std::vector<float> depth(WIDTH * HEIGHT, std::numeric_limits<float>::infinity());
+
+        for (int v = static_cast<int>(CY) + 1; v < HEIGHT; v++) {
+            float d = CAM_HEIGHT * FX / (static_cast<float>(v) - CY);
+
+            for (int u = 0; u < WIDTH; u++) {
+                depth[v * WIDTH + u] = d;
+            }
+        }
+
+        return depth;
+    }
+
+    // Camera frame to map frame: no rotation, camera at (x, y, CAM_HEIGHT)
+    void cameraTransf(float x, float y, float transf[12]) {
+        const float t[12] = {1.f, 0.f, 0.f, x, 0.f, 1.f, 0.f, y, 0.f, 0.f, 1.f, CAM_HEIGHT};
+
+        for (int i = 0; i < 12; i++) {
+            transf[i] = t[i];
+        }
+    }
+
+    struct CellPoint {
+        float x, y, z, minZ, maxZ;
+    };
+
+    std::vector<CellPoint> cells(const sl_tools::CElevationMap& map) {
+        sensor_msgs::PointCloud2 cloud;
+        map.fillCloud(cloud);
+        EXPECT_EQ(5 * sizeof(float), cloud.point_step);
+
+        const CellPoint* first = reinterpret_cast<const CellPoint*>(cloud.data.data());
+        return std::vector<CellPoint>(first, first + cloud.width * cloud.height);
+    }
+
+    void fuse(sl_tools::CElevationMap& map, const std::vector<float>& depth, float x, float y) {
+        float transf[12];
+        cameraTransf(x, y, transf);
+        map.fuse(depth.data(), WIDTH * sizeof(float), WIDTH, HEIGHT, FX, FX, CX, CY, transf, x, y, 0.f);
+    }
+
+} // namespace
+
+TEST(ElevationMap, FlatFloor) {
+    sl_tools::CElevationMap map;
+    map.setParams(0.1f, 20.f, 4, 10.f, 2.f);
+    fuse(map, makeFloorDepth(), 0.f, 0.f);
+
+    std::vector<CellPoint> points = cells(map);
+    ASSERT_FALSE(points.empty());
+
+    for (const CellPoint& p : points) {
+        ASSERT_NEAR(0.f, p.z, 1e-4f);
+        ASSERT_NEAR(0.f, p.minZ, 1e-4f);
+        ASSERT_NEAR(0.f, p.maxZ, 1e-4f);
+        // Only in front of the camera, within the maximum range
+        ASSERT_GT(p.x, 0.f);
+        ASSERT_LT(p.x, 10.f + 0.1f);
+    }
+}
+
+TEST(ElevationMap, Obstacle) {
+    std::vector<float> depth = makeFloorDepth();
+
+    // 0.5 m high box 3 m in front of the camera, in the central columns
+    const float boxX = 3.f;
+    const float boxTop = 0.5f;
+
+    for (int v = 0; v < HEIGHT; v++) {
+        float z = CAM_HEIGHT - boxX * (static_cast<float>(v) - CY) / FX;
+
+        if (z < 0.f || z > boxTop) {
+            continue;
+        }
+
+        for (int u = WIDTH / 2 - 100; u < WIDTH / 2 + 100; u++) {
+            depth[v * WIDTH + u] = boxX;
+        }
+    }
+
+    sl_tools::CElevationMap map;
+    map.setParams(0.1f, 20.f, 4, 10.f, 2.f);
+    fuse(map, depth, 0.f, 0.f);
+
+    int boxCells = 0;
+
+    for (const CellPoint& p : cells(map)) {
+        if (std::abs(p.y) < 0.5f && p.x > boxX && p.x < boxX + 0.1f) {
+            // Highest sampled row of the box: within one pixel stride of the top
+            EXPECT_NEAR(boxTop, p.maxZ, 4 * boxX / FX + 1e-4f);
+            boxCells++;
+        } else {
+            EXPECT_NEAR(0.f, p.maxZ, 1e-4f);
+        }
+    }
+
+    EXPECT_GT(boxCells, 0);
+}
+
+// The cells leaving the map are cleared, the others are kept
+TEST(ElevationMap, Rolling) {
+    sl_tools::CElevationMap map;
+    map.setParams(0.1f, 20.f, 4, 10.f, 2.f);
+    fuse(map, makeFloorDepth(), 0.f, 0.f);
+    const size_t observed = cells(map).size();
+
+    std::vector<float> empty(WIDTH * HEIGHT, std::numeric_limits<float>::quiet_NaN());
+
+    // The observed floor stays in the map
+    fuse(map, empty, 0.5f, 0.f);
+    EXPECT_EQ(observed, cells(map).size());
+
+    // Map from -15 m to 5 m: the farther cells are cleared
+    fuse(map, empty, -5.f, 0.f);
+    std::vector<CellPoint> points = cells(map);
+    EXPECT_LT(points.size(), observed);
+    EXPECT_FALSE(points.empty());
+
+    for (const CellPoint& p : points) {
+        EXPECT_LT(p.x, 5.f);
+    }
+
+    // Far away: everything is cleared
+    fuse(map, empty, 100.f, 100.f);
+    EXPECT_TRUE(cells(map).empty());
+}
+
+// Fusion time of a HD720 depth map with the default pixel stride
+TEST(ElevationMap, DISABLED_Benchmark) {
+    sl_tools::CElevationMap map;
+    map.setParams(0.1f, 20.f, 4, 10.f, 2.f);
+    std::vector<float> depth = makeFloorDepth();
+    const int iterations = 200;
+
+    fuse(map, depth, 0.f, 0.f); // Ray table
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; ++i) {
+        fuse(map, depth, 0.01f * i, 0.f);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+
+    printf("Elevation map fusion %dx%d, pixel stride 4: %.3f ms\n", WIDTH, HEIGHT, ms);
+    RecordProperty("fuse_us", static_cast<int>(ms * 1000));
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
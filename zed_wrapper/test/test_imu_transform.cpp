@@ -0,0 +1,134 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_tools.h"
+
+#include <gtest/gtest.h>
+#include <tf2/buffer_core.h>
+#include <tf2_geometry_msgs/tf2_geometry_msgs.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+    geometry_msgs::TransformStamped stamped(const tf2::Transform& transf, const std::string& parent,
+                                            const std::string& child, ros::Time t) {
+        geometry_msgs::TransformStamped msg;
+        msg.header.stamp = t;
+        msg.header.frame_id = parent;
+        msg.child_frame_id = child;
+        msg.transform = tf2::toMsg(transf);
+        return msg;
+    }
+
+    void expectTransformNear(const tf2::Transform& expected, const tf2::Transform& actual) {
+        const double eps = 1e-9;
+        EXPECT_NEAR(expected.getOrigin().x(), actual.getOrigin().x(), eps);
+        EXPECT_NEAR(expected.getOrigin().y(), actual.getOrigin().y(), eps);
+        EXPECT_NEAR(expected.getOrigin().z(), actual.getOrigin().z(), eps);
+        // q and -q are the same rotation
+        EXPECT_NEAR(1.0, std::abs(expected.getRotation().dot(actual.getRotation())), eps);
+    }
+
+    // TF tree broadcasted by the wrapper: map -> odom -> base_link -> camera_center
+    class CameraToPoseTest : public testing::Test {
+    protected:
+        void SetUp() override {
+            mStamp = ros::Time(100, 0);
+
+            tf2::Quaternion q;
+            q.setRPY(0.02, -0.1, 0.3);
+            mBase2Camera = tf2::Transform(q, tf2::Vector3(0.1, 0.06, 0.4));
+            q.setRPY(0.0, 0.0, 1.2);
+            mMap2Odom = tf2::Transform(q, tf2::Vector3(2.0, -1.0, 0.0));
+            q.setRPY(0.05, 0.01, -0.7);
+            mOdom2Base = tf2::Transform(q, tf2::Vector3(3.5, 0.25, 0.02));
+
+            mBuffer.setTransform(stamped(mBase2Camera, "base_link", "camera_center", mStamp), "test", true);
+            mBuffer.setTransform(stamped(mMap2Odom, "map", "odom", mStamp), "test");
+            mBuffer.setTransform(stamped(mOdom2Base, "odom", "base_link", mStamp), "test");
+
+            // As in `ZEDWrapperNodelet::checkCamera2BaseTransf`
+            tf2::fromMsg(mBuffer.lookupTransform("camera_center", "base_link", ros::Time(0)).transform,
+                         mCamera2Base);
+        }
+
+        // Transform used by the IMU callback before it was cached by the grabbing thread
+        tf2::Transform lookup(const std::string& poseFrame) {
+            tf2::Transform cam2pose;
+            tf2::fromMsg(mBuffer.lookupTransform(poseFrame, "camera_center", ros::Time(0)).transform, cam2pose);
+            return cam2pose;
+        }
+
+        tf2::BufferCore mBuffer;
+        ros::Time mStamp;
+        tf2::Transform mBase2Camera;
+        tf2::Transform mMap2Odom;
+        tf2::Transform mOdom2Base;
+        tf2::Transform mCamera2Base;
+    };
+
+} // namespace
+
+TEST_F(CameraToPoseTest, MapFrameMatchesTfLookup) {
+    expectTransformNear(lookup("map"),
+                        sl_tools::cameraToPoseTransform(mMap2Odom, mOdom2Base, mCamera2Base, true));
+}
+
+TEST_F(CameraToPoseTest, OdomFrameMatchesTfLookup) {
+    expectTransformNear(lookup("odom"),
+                        sl_tools::cameraToPoseTransform(mMap2Odom, mOdom2Base, mCamera2Base, false));
+}
+
+// Cost of getting the transform in the IMU callback: tf2 lookup vs composition
+TEST_F(CameraToPoseTest, DISABLED_Benchmark) {
+    const int iterations = 100000;
+    double sink = 0.0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; ++i) {
+        sink += lookup("map").getOrigin().x();
+    }
+
+    auto mid = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; ++i) {
+        sink += sl_tools::cameraToPoseTransform(mMap2Odom, mOdom2Base, mCamera2Base, true).getOrigin().x();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    double lookupNs = std::chrono::duration<double, std::nano>(mid - start).count() / iterations;
+    double composeNs = std::chrono::duration<double, std::nano>(end - mid).count() / iterations;
+
+    printf("Camera to map transform: tf2 lookup %.1f ns, composition %.1f ns (checksum %g)\n", lookupNs,
+           composeNs, sink);
+    RecordProperty("lookup_ns", static_cast<int>(lookupNs * 1000));
+    RecordProperty("compose_ns", static_cast<int>(composeNs * 1000));
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,158 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_jpeg.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+extern "C" {
+#include <jpeglib.h>
+}
+
+namespace {
+
+    // BGRA test pattern with `pad` bytes after each row
+    std::vector<uint8_t> makeImage(int width, int height, int pad) {
+        const size_t step = static_cast<size_t>(width) * 4 + pad;
+        std::vector<uint8_t> img(step * height, 0);
+
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                uint8_t* p = &img[y * step + x * 4];
+                p[0] = static_cast<uint8_t>((x * 3 + y) & 0xFF);
+                p[1] = static_cast<uint8_t>(128 + 100 * std::sin(x * 0.05) * std::cos(y * 0.07));
+                p[2] = static_cast<uint8_t>((x ^ y) & 0xFF);
+                p[3] = 255;
+            }
+        }
+
+        return img;
+    }
+
+    bool decode(const std::vector<uint8_t>& jpg, std::vector<uint8_t>& rgb, int& width, int& height) {
+        jpeg_decompress_struct cinfo;
+        jpeg_error_mgr jerr;
+        cinfo.err = jpeg_std_error(&jerr);
+        jpeg_create_decompress(&cinfo);
+        jpeg_mem_src(&cinfo, const_cast<unsigned char*>(jpg.data()), static_cast<unsigned long>(jpg.size()));
+
+        if (jpeg_read_header(&cinfo, TRUE) != JPEG_HEADER_OK) {
+            jpeg_destroy_decompress(&cinfo);
+            return false;
+        }
+
+        jpeg_start_decompress(&cinfo);
+        width = static_cast<int>(cinfo.output_width);
+        height = static_cast<int>(cinfo.output_height);
+        rgb.resize(static_cast<size_t>(width) * height * cinfo.output_components);
+
+        while (cinfo.output_scanline < cinfo.output_height) {
+            JSAMPROW row = &rgb[static_cast<size_t>(cinfo.output_scanline) * width * cinfo.output_components];
+            jpeg_read_scanlines(&cinfo, &row, 1);
+        }
+
+        bool ok = jerr.num_warnings == 0;
+        jpeg_finish_decompress(&cinfo);
+        jpeg_destroy_decompress(&cinfo);
+        return ok;
+    }
+
+    void checkStripes(int width, int height, int threads) {
+        const int pad = 64;
+        std::vector<uint8_t> img = makeImage(width, height, pad);
+        const size_t step = static_cast<size_t>(width) * 4 + pad;
+
+        std::vector<uint8_t> single;
+        std::vector<uint8_t> striped;
+        ASSERT_TRUE(sl_tools::encodeJpegBGRA(img.data(), step, width, height, 80, single, 1));
+        ASSERT_TRUE(sl_tools::encodeJpegBGRA(img.data(), step, width, height, 80, striped, threads));
+
+        std::vector<uint8_t> a;
+        std::vector<uint8_t> b;
+        int w = 0;
+        int h = 0;
+        ASSERT_TRUE(decode(single, a, w, h));
+        ASSERT_TRUE(decode(striped, b, w, h)) << "corrupted striped JPEG " << width << "x" << height;
+        EXPECT_EQ(width, w);
+        EXPECT_EQ(height, h);
+        EXPECT_TRUE(a == b) << width << "x" << height << " with " << threads << " threads";
+    }
+
+} // namespace
+
+// The stripes joined with restart markers decode to the same pixels of a single stripe
+TEST(JpegBGRA, StripedEqualsSingleStripe) {
+    const int sizes[][2] = {{1280, 720}, {672, 376}, {2208, 1242}, {100, 33}, {17, 5}};
+
+    for (const auto& size : sizes) {
+        for (int threads = 2; threads <= 8; threads *= 2) {
+            checkStripes(size[0], size[1], threads);
+        }
+    }
+}
+
+TEST(JpegBGRA, RejectsInvalidInput) {
+    std::vector<uint8_t> img = makeImage(16, 16, 0);
+    std::vector<uint8_t> out;
+
+    EXPECT_FALSE(sl_tools::encodeJpegBGRA(nullptr, 64, 16, 16, 80, out, 1));
+    EXPECT_FALSE(sl_tools::encodeJpegBGRA(img.data(), 64, 0, 16, 80, out, 1));
+    EXPECT_FALSE(sl_tools::encodeJpegBGRA(img.data(), 64, 65536, 1, 80, out, 1));
+}
+
+// Encoding time of a HD720 image, single stripe and one stripe per thread
+TEST(JpegBGRA, DISABLED_Benchmark) {
+    const int width = 1280;
+    const int height = 720;
+    const int iterations = 10;
+    std::vector<uint8_t> img = makeImage(width, height, 0);
+    std::vector<uint8_t> out;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; ++i) {
+        sl_tools::encodeJpegBGRA(img.data(), width * 4, width, height, 80, out, 1);
+    }
+
+    auto mid = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; ++i) {
+        sl_tools::encodeJpegBGRA(img.data(), width * 4, width, height, 80, out, 0);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    double singleMs = std::chrono::duration<double, std::milli>(mid - start).count() / iterations;
+    double stripedMs = std::chrono::duration<double, std::milli>(end - mid).count() / iterations;
+
+    printf("JPEG %dx%d: single stripe %.2f ms, striped %.2f ms\n", width, height, singleMs, stripedMs);
+    RecordProperty("single_us", static_cast<int>(singleMs * 1000));
+    RecordProperty("striped_us", static_cast<int>(stripedMs * 1000));
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,189 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_normals.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    // Organized cloud (X,Y,Z,color) of a pinhole camera looking at the plane `n . p = d`
+    std::vector<float> makePlaneCloud(int width, int height, const float n[3], float d) {
+        std::vector<float> cloud(4 * width * height);
+        const float f = 0.5f * width;
+        const float cx = 0.5f * width;
+        const float cy = 0.5f * height;
+
+        for (int v = 0; v < height; v++) {
+            for (int u = 0; u < width; u++) {
+                float ray[3] = {(u - cx) / f, (v - cy) / f, 1.f};
+                float t = d / (n[0] * ray[0] + n[1] * ray[1] + n[2] * ray[2]);
+                float* pt = &cloud[4 * (width * v + u)];
+                pt[0] = t * ray[0];
+                pt[1] = t * ray[1];
+                pt[2] = t * ray[2];
+                pt[3] = 0.f;
+            }
+        }
+
+        return cloud;
+    }
+
+} // namespace
+
+// Every normal of a plane is the normal of the plane, oriented toward the camera
+TEST(NormalEstimator, PlaneGivesExactNormals) {
+    const int width = 320;
+    const int height = 180;
+    const int radius = 3;
+
+    // Tilted plane in front of the camera: its normal points away from the camera
+    float n[3] = {0.2f, -0.3f, 1.f};
+    float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+    for (int i = 0; i < 3; i++) {
+        n[i] /= len;
+    }
+
+    std::vector<float> cloud = makePlaneCloud(width, height, n, 2.f);
+    std::vector<float> normals(3 * width * height);
+
+    sl_tools::CNormalEstimator estimator;
+    estimator.setParams(radius);
+    estimator.compute(cloud.data(), 4 * width * sizeof(float), width, height, normals.data(), 1);
+
+    int checked = 0;
+
+    for (int v = 0; v < height; v++) {
+        for (int u = 0; u < width; u++) {
+            const float* out = &normals[3 * (width * v + u)];
+            bool border = u < radius || u >= width - radius || v < radius || v >= height - radius;
+
+            if (border) {
+                EXPECT_TRUE(std::isnan(out[0]) && std::isnan(out[1]) && std::isnan(out[2]));
+                continue;
+            }
+
+            ASSERT_NEAR(-n[0], out[0], 1e-4f) << "pixel " << u << "," << v;
+            ASSERT_NEAR(-n[1], out[1], 1e-4f) << "pixel " << u << "," << v;
+            ASSERT_NEAR(-n[2], out[2], 1e-4f) << "pixel " << u << "," << v;
+            checked++;
+        }
+    }
+
+    EXPECT_EQ((width - 2 * radius) * (height - 2 * radius), checked);
+}
+
+// Points without depth have no normal, and windows with too few valid points neither
+TEST(NormalEstimator, InvalidPoints) {
+    const int width = 64;
+    const int height = 48;
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    float n[3] = {0.f, 0.f, 1.f};
+
+    std::vector<float> cloud = makePlaneCloud(width, height, n, 1.f);
+
+    // Invalid point in the middle, invalid left half of the bottom rows
+    cloud[4 * (width * 20 + 30) + 2] = nan;
+
+    for (int v = 36; v < height; v++) {
+        for (int u = 0; u < width / 2; u++) {
+            cloud[4 * (width * v + u)] = cloud[4 * (width * v + u) + 1] = cloud[4 * (width * v + u) + 2] = nan;
+        }
+    }
+
+    std::vector<float> normals(3 * width * height);
+    sl_tools::CNormalEstimator estimator;
+    estimator.setParams(2);
+    estimator.compute(cloud.data(), 4 * width * sizeof(float), width, height, normals.data(), 1);
+
+    EXPECT_TRUE(std::isnan(normals[3 * (width * 20 + 30) + 2]));
+    EXPECT_TRUE(std::isnan(normals[3 * (width * 40 + 10) + 2]));
+    EXPECT_NEAR(-1.f, normals[3 * (width * 20 + 31) + 2], 1e-5f);
+    EXPECT_NEAR(-1.f, normals[3 * (width * 40 + 50) + 2], 1e-5f);
+}
+
+TEST(NormalEstimator, ThreadsGiveSameResult) {
+    const int width = 256;
+    const int height = 144;
+    float n[3] = {0.1f, 0.4f, 0.9f};
+    std::vector<float> cloud = makePlaneCloud(width, height, n, 3.f);
+
+    // Some noise, so that the result depends on the order of the sums if any
+    for (size_t i = 0; i < cloud.size(); i += 4) {
+        cloud[i + 2] += 0.001f * static_cast<float>((i * 7919) % 13);
+    }
+
+    std::vector<float> single(3 * width * height);
+    std::vector<float> multi(3 * width * height);
+    sl_tools::CNormalEstimator estimator;
+    estimator.compute(cloud.data(), 4 * width * sizeof(float), width, height, single.data(), 1);
+    estimator.compute(cloud.data(), 4 * width * sizeof(float), width, height, multi.data(), 4);
+
+    EXPECT_EQ(0, memcmp(single.data(), multi.data(), single.size() * sizeof(float)));
+}
+
+// Time to compute the normals of a HD720 cloud, single thread vs all the cores
+TEST(NormalEstimator, DISABLED_Benchmark) {
+    const int width = 1280;
+    const int height = 720;
+    const int iterations = 10;
+    float n[3] = {0.f, 0.f, 1.f};
+    std::vector<float> cloud = makePlaneCloud(width, height, n, 2.f);
+    std::vector<float> normals(3 * width * height);
+    sl_tools::CNormalEstimator estimator;
+    int threads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; ++i) {
+        estimator.compute(cloud.data(), 4 * width * sizeof(float), width, height, normals.data(), 1);
+    }
+
+    auto mid = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; ++i) {
+        estimator.compute(cloud.data(), 4 * width * sizeof(float), width, height, normals.data(), threads);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    double singleMs = std::chrono::duration<double, std::milli>(mid - start).count() / iterations;
+    double multiMs = std::chrono::duration<double, std::milli>(end - mid).count() / iterations;
+
+    printf("Normals %dx%d: 1 thread %.2f ms, %d threads %.2f ms (%.1fx)\n", width, height, singleMs, threads, multiMs,
+           singleMs / multiMs);
+    RecordProperty("single_us", static_cast<int>(singleMs * 1000));
+    RecordProperty("multi_us", static_cast<int>(multiMs * 1000));
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,290 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_recorder.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+    const uint16_t CHANNEL = 1;
+    const uint32_t RECORD_SIZE = 4096;
+
+    std::string tempFile(const char* name) {
+        return std::string("/tmp/zed_test_") + name + "_" + std::to_string(getpid()) + ".zrec";
+    }
+
+    std::vector<uint8_t> makeRecord(int idx) {
+        std::vector<uint8_t> data(RECORD_SIZE);
+
+        for (size_t i = 0; i < data.size(); i++) {
+            data[i] = static_cast<uint8_t>(idx * 31 + i * 7);
+        }
+
+        return data;
+    }
+
+    // The chunks are written by a background thread: wait for the expected counters
+    bool waitWriter(const sl_tools::CChunkRecorder& rec, uint64_t written, uint64_t dropped) {
+        for (int i = 0; i < 500; i++) {
+            if (rec.getWrittenBytes() == written && rec.getDroppedChunks() == dropped) {
+                return true;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        return false;
+    }
+
+    // Restores the file size limit when the test ends
+    struct FileSizeLimit {
+        rlimit saved;
+
+        FileSizeLimit() {
+            getrlimit(RLIMIT_FSIZE, &saved);
+            signal(SIGXFSZ, SIG_IGN); // Writes beyond the limit fail with EFBIG
+        }
+
+        ~FileSizeLimit() {
+            setrlimit(RLIMIT_FSIZE, &saved);
+        }
+
+        bool set(rlim_t bytes) {
+            rlimit lim = saved;
+            lim.rlim_cur = bytes;
+            return setrlimit(RLIMIT_FSIZE, &lim) == 0;
+        }
+
+        bool restore() {
+            return setrlimit(RLIMIT_FSIZE, &saved) == 0;
+        }
+    };
+
+    std::vector<int64_t> readStamps(const std::string& filename, bool& indexed) {
+        std::vector<int64_t> stamps;
+        sl_tools::CChunkReader reader;
+
+        if (!reader.open(filename)) {
+            return stamps;
+        }
+
+        indexed = reader.isIndexed();
+        sl_tools::RecRecord rec;
+
+        while (reader.next(rec)) {
+            std::vector<uint8_t> expected = makeRecord(static_cast<int>(rec.stampNsec));
+
+            if (rec.channel != CHANNEL || rec.size != RECORD_SIZE || memcmp(rec.data, expected.data(), RECORD_SIZE) != 0) {
+                stamps.push_back(-1);
+            } else {
+                stamps.push_back(rec.stampNsec);
+            }
+        }
+
+        return stamps;
+    }
+
+} // namespace
+
+TEST(ChunkRecorder, RoundTrip) {
+    const std::string filename = tempFile("roundtrip");
+    std::vector<sl_tools::RecChannel> channels = {{CHANNEL, "/zed/data", "test/Data"}};
+
+    sl_tools::CChunkRecorder recorder;
+    ASSERT_TRUE(recorder.open(filename, channels, 3 * RECORD_SIZE, true));
+
+    std::vector<int64_t> written;
+
+    for (int i = 0; i < 20; i++) {
+        std::vector<uint8_t> data = makeRecord(i);
+        recorder.write(CHANNEL, i, data.data(), RECORD_SIZE);
+        written.push_back(i);
+    }
+
+    recorder.close();
+    EXPECT_EQ(0u, recorder.getDroppedChunks());
+
+    bool indexed = false;
+    EXPECT_EQ(written, readStamps(filename, indexed));
+    EXPECT_TRUE(indexed);
+
+    remove(filename.c_str());
+}
+
+// A write error (disk full) drops the chunk being written, the next chunks are
+// written at the end of the last complete one and the index stays valid
+TEST(ChunkRecorder, WriteErrorKeepsOffsetsValid) {
+    const std::string filename = tempFile("write_error");
+    std::vector<sl_tools::RecChannel> channels = {{CHANNEL, "/zed/data", "test/Data"}};
+    FileSizeLimit limit;
+
+    // One uncompressed chunk for each record
+    sl_tools::CChunkRecorder recorder;
+    ASSERT_TRUE(recorder.open(filename, channels, RECORD_SIZE, false));
+
+    const uint64_t headerSize = recorder.getWrittenBytes();
+    std::vector<uint8_t> first = makeRecord(0);
+    recorder.write(CHANNEL, 0, first.data(), RECORD_SIZE);
+
+    // Wait for the first chunk to know the size of a chunk on disk
+    for (int i = 0; i < 500 && recorder.getWrittenBytes() == headerSize; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    const uint64_t chunkSize = recorder.getWrittenBytes() - headerSize;
+    ASSERT_GT(chunkSize, RECORD_SIZE);
+
+    std::vector<uint8_t> data = makeRecord(1);
+    recorder.write(CHANNEL, 1, data.data(), RECORD_SIZE);
+    ASSERT_TRUE(waitWriter(recorder, headerSize + 2 * chunkSize, 0));
+
+    // The disk fills up in the middle of the third chunk
+    ASSERT_TRUE(limit.set(headerSize + 2 * chunkSize + chunkSize / 2));
+
+    for (int i = 2; i < 5; i++) {
+        data = makeRecord(i);
+        recorder.write(CHANNEL, i, data.data(), RECORD_SIZE);
+        ASSERT_TRUE(waitWriter(recorder, headerSize + 2 * chunkSize, static_cast<uint64_t>(i - 1)));
+    }
+
+    // Space available again
+    ASSERT_TRUE(limit.restore());
+
+    for (int i = 5; i < 7; i++) {
+        data = makeRecord(i);
+        recorder.write(CHANNEL, i, data.data(), RECORD_SIZE);
+        ASSERT_TRUE(waitWriter(recorder, headerSize + static_cast<uint64_t>(i - 2) * chunkSize, 3));
+    }
+
+    recorder.close();
+
+    struct stat st;
+    ASSERT_EQ(0, stat(filename.c_str(), &st));
+    EXPECT_EQ(recorder.getWrittenBytes(), static_cast<uint64_t>(st.st_size)); // No partial chunk left
+
+    bool indexed = false;
+    std::vector<int64_t> expected = {0, 1, 5, 6};
+    EXPECT_EQ(expected, readStamps(filename, indexed));
+    EXPECT_TRUE(indexed);
+
+    remove(filename.c_str());
+}
+
+// Offsets near the top of the 64 bit range in the footer and in the index are
+// rejected instead of wrapping around in the bounds checks
+TEST(ChunkRecorder, CorruptedOffsets) {
+    const std::string filename = tempFile("corrupted");
+    std::vector<sl_tools::RecChannel> channels = {{CHANNEL, "/zed/data", "test/Data"}};
+
+    // One uncompressed chunk for each record
+    sl_tools::CChunkRecorder recorder;
+    ASSERT_TRUE(recorder.open(filename, channels, RECORD_SIZE, false));
+
+    for (int i = 0; i < 3; i++) {
+        std::vector<uint8_t> data = makeRecord(i);
+        recorder.write(CHANNEL, i, data.data(), RECORD_SIZE);
+    }
+
+    recorder.close();
+
+    FILE* f = fopen(filename.c_str(), "r+b");
+    ASSERT_NE(nullptr, f);
+
+    // Footer: index offset, end magic
+    uint64_t idxOffset = 0;
+    ASSERT_EQ(0, fseek(f, -16, SEEK_END));
+    ASSERT_EQ(1u, fread(&idxOffset, sizeof(idxOffset), 1, f));
+
+    // Index: magic, count, then offset/start/end of each chunk
+    const uint64_t badOffset = UINT64_MAX - 8;
+    ASSERT_EQ(0, fseek(f, static_cast<long>(idxOffset + 8 + 3 * 8), SEEK_SET));
+    ASSERT_EQ(1u, fwrite(&badOffset, sizeof(badOffset), 1, f));
+    fclose(f);
+
+    // The second chunk is skipped
+    bool indexed = false;
+    std::vector<int64_t> expected = {0, 2};
+    EXPECT_EQ(expected, readStamps(filename, indexed));
+    EXPECT_TRUE(indexed);
+
+    f = fopen(filename.c_str(), "r+b");
+    ASSERT_NE(nullptr, f);
+    ASSERT_EQ(0, fseek(f, -16, SEEK_END));
+    ASSERT_EQ(1u, fwrite(&badOffset, sizeof(badOffset), 1, f));
+    fclose(f);
+
+    // The index is ignored and rebuilt from the chunks
+    indexed = true;
+    expected = {0, 1, 2};
+    EXPECT_EQ(expected, readStamps(filename, indexed));
+    EXPECT_FALSE(indexed);
+
+    remove(filename.c_str());
+}
+
+// Time spent by the calling thread to append the records and write throughput
+TEST(ChunkRecorder, DISABLED_Benchmark) {
+    const std::string filename = tempFile("benchmark");
+    std::vector<sl_tools::RecChannel> channels = {{CHANNEL, "/zed/data", "test/Data"}};
+    const int records = 2000;
+    std::vector<uint8_t> data = makeRecord(0);
+
+    sl_tools::CChunkRecorder recorder;
+    ASSERT_TRUE(recorder.open(filename, channels));
+
+    double writeUs = 0.0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < records; i++) {
+        auto t = std::chrono::steady_clock::now();
+        recorder.write(CHANNEL, i, data.data(), RECORD_SIZE);
+        writeUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t).count();
+    }
+
+    recorder.close();
+    double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    double mb = static_cast<double>(records) * RECORD_SIZE / 1048576.;
+
+    printf("Recorder: write %.2f us/record, %.1f MB in %.1f ms (%.0f MB/s), lost chunks %lu\n", writeUs / records, mb,
+           totalMs, mb / (totalMs / 1000.), static_cast<unsigned long>(recorder.getDroppedChunks()));
+    RecordProperty("write_ns", static_cast<int>(writeUs * 1000 / records));
+    RecordProperty("total_ms", static_cast<int>(totalMs));
+
+    remove(filename.c_str());
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
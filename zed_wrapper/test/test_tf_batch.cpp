@@ -0,0 +1,126 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_tf.h"
+
+#include <gtest/gtest.h>
+#include <tf2/buffer_core.h>
+
+#include <vector>
+
+namespace {
+
+    const double EPS = 1e-9;
+
+    void expectTransform(const tf2::Transform& expected, const geometry_msgs::Transform& actual) {
+        EXPECT_NEAR(expected.getOrigin().x(), actual.translation.x, EPS);
+        EXPECT_NEAR(expected.getOrigin().y(), actual.translation.y, EPS);
+        EXPECT_NEAR(expected.getOrigin().z(), actual.translation.z, EPS);
+
+        // q and -q are the same rotation
+        tf2::Quaternion q = expected.getRotation();
+        double sign = (q.w() * actual.rotation.w < 0.0) ? -1.0 : 1.0;
+        EXPECT_NEAR(q.x(), sign * actual.rotation.x, EPS);
+        EXPECT_NEAR(q.y(), sign * actual.rotation.y, EPS);
+        EXPECT_NEAR(q.z(), sign * actual.rotation.z, EPS);
+        EXPECT_NEAR(q.w(), sign * actual.rotation.w, EPS);
+    }
+
+    struct Poses {
+        tf2::Transform odom2base;
+        tf2::Transform map2odom;
+
+        Poses() {
+            tf2::Quaternion q;
+            q.setRPY(0.01, 0.02, 0.5);
+            odom2base = tf2::Transform(q, tf2::Vector3(1.0, 2.0, 0.1));
+            q.setRPY(0.0, 0.0, -0.3);
+            map2odom = tf2::Transform(q, tf2::Vector3(-0.5, 0.2, 0.0));
+        }
+    };
+
+} // namespace
+
+// odom -> base, then map -> odom, all with the frame stamp
+TEST(TfBatch, WithMapTf) {
+    Poses p;
+    ros::Time t(1234, 5678);
+
+    std::vector<geometry_msgs::TransformStamped> batch =
+        sl_tools::frameTransforms(p.odom2base, p.map2odom, true, "map", "odom", "base_link", t);
+
+    ASSERT_EQ(2u, batch.size());
+
+    EXPECT_EQ("odom", batch[0].header.frame_id);
+    EXPECT_EQ("base_link", batch[0].child_frame_id);
+    EXPECT_EQ(t, batch[0].header.stamp);
+    expectTransform(p.odom2base, batch[0].transform);
+
+    EXPECT_EQ("map", batch[1].header.frame_id);
+    EXPECT_EQ("odom", batch[1].child_frame_id);
+    EXPECT_EQ(t, batch[1].header.stamp);
+    expectTransform(p.map2odom, batch[1].transform);
+
+    // A listener receiving the batch resolves the base frame in the map frame
+    tf2::BufferCore buffer;
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        ASSERT_TRUE(buffer.setTransform(batch[i], "test"));
+    }
+
+    geometry_msgs::TransformStamped map2base = buffer.lookupTransform("map", "base_link", t);
+    expectTransform(p.map2odom * p.odom2base, map2base.transform);
+}
+
+// Without the map TF the batch only holds odom -> base
+TEST(TfBatch, WithoutMapTf) {
+    Poses p;
+    ros::Time t(42, 0);
+
+    std::vector<geometry_msgs::TransformStamped> batch =
+        sl_tools::frameTransforms(p.odom2base, p.map2odom, false, "map", "odom", "base_link", t);
+
+    ASSERT_EQ(1u, batch.size());
+    EXPECT_EQ("odom", batch[0].header.frame_id);
+    EXPECT_EQ("base_link", batch[0].child_frame_id);
+    EXPECT_EQ(t, batch[0].header.stamp);
+    expectTransform(p.odom2base, batch[0].transform);
+}
+
+// The IMU transform is still sent alone, from the IMU timer
+TEST(TfBatch, ImuTransform) {
+    tf2::Quaternion q;
+    q.setRPY(0.1, -0.2, 0.05);
+    tf2::Transform imu(q, tf2::Vector3(0.0, 0.0, 0.0));
+    ros::Time t(42, 0);
+
+    geometry_msgs::TransformStamped msg =
+        sl_tools::transformToROSmsg(imu, "zed_camera_center", "zed_imu_link", t);
+
+    EXPECT_EQ("zed_camera_center", msg.header.frame_id);
+    EXPECT_EQ("zed_imu_link", msg.child_frame_id);
+    EXPECT_EQ(t, msg.header.stamp);
+    expectTransform(imu, msg.transform);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}